@@ -56,12 +56,16 @@ void AST::BashppParser::_initialize_lexer() {
 			break;
 		}
 		case InputType::STRING_CONTENTS: {
-			input_string_contents = std::get<std::string>(input_source);
+			const std::shared_ptr<const std::string>& input_string_contents = std::get<std::shared_ptr<const std::string>>(input_source);
+			if (input_string_contents == nullptr) {
+				throw bpp::ErrorHandling::InternalError("Input string contents are null");
+			}
 			// Create a temporary FILE* from the string contents
+			// The stream is opened read-only, so the contents are never written to
 			owned_input_file = std::unique_ptr<FILE, int(*)(FILE*)>(
 				fmemopen(
-					reinterpret_cast<void*>(const_cast<char*>(input_string_contents.c_str())),
-					input_string_contents.size(),
+					reinterpret_cast<void*>(const_cast<char*>(input_string_contents->c_str())),
+					input_string_contents->size(),
 					"r"
 				),
 				&fclose
@@ -126,8 +130,12 @@ void AST::BashppParser::setInputFromFilePtr(FILE* file_ptr, const std::string& f
 }
 
 void AST::BashppParser::setInputFromStringContents(const std::string& contents) {
+	setInputFromStringContents(std::make_shared<const std::string>(contents));
+}
+
+void AST::BashppParser::setInputFromStringContents(std::shared_ptr<const std::string> contents) {
 	input_type = InputType::STRING_CONTENTS;
-	input_source = contents;
+	input_source = std::move(contents);
 }
 
 void AST::BashppParser::setIncludeChain(const std::vector<std::string>& includes) {
@@ -137,6 +145,13 @@ void AST::BashppParser::setIncludeChain(const std::vector<std::string>& includes
 std::shared_ptr<AST::Program> AST::BashppParser::program() {
 	if (m_program == nullptr) {
 		_parse();
+
+		// Index the comments while we still have the contents in hand,
+		// So that the language server can show documentation without re-reading the file
+		if (m_program != nullptr && input_type == InputType::STRING_CONTENTS) {
+			const auto& contents = std::get<std::shared_ptr<const std::string>>(input_source);
+			m_program->set_comment_index(std::make_shared<const AST::CommentIndex>(*contents));
+		}
 	}
 	return m_program;
 }
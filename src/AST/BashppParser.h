@@ -44,8 +44,7 @@ class BashppParser {
 			STRING_CONTENTS
 		} input_type = InputType::FILEPATH;
 
-		std::variant<std::string, FILE*, std::monostate> input_source = std::monostate{}; // Can be a file path, FILE*, or string contents
-		std::string input_string_contents;
+		std::variant<std::string, FILE*, std::shared_ptr<const std::string>, std::monostate> input_source = std::monostate{}; // Can be a file path, FILE*, or string contents
 
 		FILE* input_file = nullptr;
 		std::unique_ptr<FILE, int(*)(FILE*)> owned_input_file{nullptr, &fclose};
@@ -61,6 +60,13 @@ class BashppParser {
 		void setInputFromFilePtr(FILE* file_ptr, const std::string& file_path);
 		void setInputFromStringContents(const std::string& contents);
 
+		/**
+		 * @brief Parse the given string contents without copying them
+		 *
+		 * The contents are kept alive by the parser until parsing has finished.
+		 */
+		void setInputFromStringContents(std::shared_ptr<const std::string> contents);
+
 		void setIncludeChain(const std::vector<std::string>& includes);
 
 		std::shared_ptr<AST::Program> program();
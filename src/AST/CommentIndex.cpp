@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "CommentIndex.h"
+
+#include <algorithm>
+
+AST::CommentIndex::CommentIndex(std::string_view contents) {
+	uint32_t line = 0;
+	size_t line_start = 0;
+	while (line_start < contents.size()) {
+		size_t line_end = contents.find('\n', line_start);
+		if (line_end == std::string_view::npos) line_end = contents.size();
+
+		std::string_view line_text = contents.substr(line_start, line_end - line_start);
+		if (line_text.ends_with('\r')) line_text.remove_suffix(1);
+
+		const size_t comment_start = line_text.find('#');
+		if (comment_start != std::string_view::npos) {
+			comment_lines.push_back({line, std::string(line_text.substr(comment_start))});
+		}
+
+		line++;
+		line_start = line_end + 1;
+	}
+	comment_lines.shrink_to_fit();
+}
+
+std::string AST::CommentIndex::comments_before(uint32_t line) const {
+	if (line == 0) return "";
+
+	// Find the comment on the line immediately before, if any
+	auto it = std::lower_bound(comment_lines.begin(), comment_lines.end(), line,
+		[](const CommentLine& comment_line, uint32_t target) { return comment_line.line < target; });
+	if (it == comment_lines.begin()) return "";
+	auto last = std::prev(it);
+	if (last->line != line - 1) return "";
+
+	// Walk back to the start of the block
+	auto first = last;
+	while (first != comment_lines.begin() && std::prev(first)->line == first->line - 1) {
+		first--;
+	}
+
+	std::string comments;
+	for (auto comment = first; comment != it; comment++) {
+		if (!comments.empty()) comments += "\n"; // Separate comments with a newline
+		comments += comment->text;
+	}
+	return comments;
+}
+
+size_t AST::CommentIndex::memory_usage() const {
+	size_t total = sizeof(CommentIndex) + comment_lines.capacity() * sizeof(CommentLine);
+	for (const auto& comment_line : comment_lines) {
+		total += comment_line.text.capacity();
+	}
+	return total;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AST {
+
+/**
+ * @class CommentIndex
+ * @brief The comments in a source file, by line, extracted once when the file is parsed.
+ *
+ * The language server shows the comment block immediately above a definition as that entity's documentation.
+ * Rather than re-reading and scanning the source file on every hover,
+ * every line containing a comment is recorded (along with the text from the '#' onward) when the file is parsed,
+ * and the block above any line can be put together from those.
+ *
+ * The index is immutable once built, and can be queried from any number of threads.
+ *
+ */
+class CommentIndex {
+	private:
+		struct CommentLine {
+			uint32_t line;
+			std::string text;
+		};
+
+		std::vector<CommentLine> comment_lines; // Sorted by line
+
+	public:
+		CommentIndex() = default;
+		explicit CommentIndex(std::string_view contents);
+
+		/**
+		 * @brief Get the block of comments which ends on the line immediately before the given line
+		 *
+		 * The block is every comment on consecutive lines, ending with the line before the given line,
+		 * joined with newlines.
+		 *
+		 * @return std::string The comment block, or an empty string if the line before the given line has no comment
+		 */
+		std::string comments_before(uint32_t line) const;
+
+		size_t memory_usage() const;
+};
+
+} // namespace AST
@@ -17,6 +17,7 @@ class DatamemberDeclaration : public ASTNode {
 		AST::Token<AccessModifier> m_ACCESSMODIFIER;
 		std::optional<AST::Token<std::string>> m_TYPE;
 		std::optional<AST::Token<std::string>> m_IDENTIFIER;
+		bool m_CONST = false;
 
 	public:
 		constexpr DatamemberDeclaration() : ASTNode(AST::NodeType::DatamemberDeclaration) {}
@@ -53,10 +54,18 @@ class DatamemberDeclaration : public ASTNode {
 			m_IDENTIFIER = std::nullopt;
 		}
 
+		bool CONST() const {
+			return m_CONST;
+		}
+
+		void setConst(bool is_const) {
+			m_CONST = is_const;
+		}
+
 		std::ostream& prettyPrint(std::ostream& os, size_t indentation_level = 0) const override {
 			std::string indent(indentation_level * PRETTYPRINT_INDENTATION_AMOUNT, ' ');
 			os << indent << "(DatamemberDeclaration\n"
-				<< indent << "  ";
+				<< indent << "  " << (m_CONST ? "@const " : "");
 			switch (m_ACCESSMODIFIER) {
 				case AccessModifier::PUBLIC:
 					os << "@public ";
@@ -21,6 +21,7 @@ class MethodDefinition : public ASTNode {
 		};
 	protected:
 		bool m_VIRTUAL = false;
+		bool m_INLINE = false;
 		AST::Token<AccessModifier> m_ACCESSMODIFIER;
 		AST::Token<std::string> m_NAME;
 		std::vector<AST::Token<Parameter>> m_PARAMETERS;
@@ -42,6 +43,13 @@ class MethodDefinition : public ASTNode {
 			m_VIRTUAL = is_virtual;
 		}
 
+		bool INLINE() const {
+			return m_INLINE;
+		}
+		void setInline(bool is_inline) {
+			m_INLINE = is_inline;
+		}
+
 		const AST::Token<AccessModifier>& ACCESSMODIFIER() const {
 			return m_ACCESSMODIFIER;
 		}
@@ -62,7 +70,7 @@ class MethodDefinition : public ASTNode {
 		std::ostream& prettyPrint(std::ostream& os, size_t indentation_level = 0) const override {
 			std::string indent(indentation_level * PRETTYPRINT_INDENTATION_AMOUNT, ' ');
 			os << indent << "(MethodDefinition\n"
-				<< indent << "  " << (m_VIRTUAL ? "@virtual " : "");
+				<< indent << "  " << (m_INLINE ? "@inline " : "") << (m_VIRTUAL ? "@virtual " : "");
 			switch (m_ACCESSMODIFIER) {
 				case AccessModifier::PUBLIC:
 					os << "@public ";
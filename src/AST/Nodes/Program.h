@@ -6,14 +6,54 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include <AST/ASTNode.h>
+#include <AST/CommentIndex.h>
 
 namespace AST {
 
 class Program : public ASTNode {
+	private:
+		std::shared_ptr<const CommentIndex> comment_index = nullptr; // Only built when parsing from string contents (i.e., in the language server)
+		mutable std::atomic<size_t> cached_memory_usage = 0;
 	public:
 		constexpr Program() : ASTNode(AST::NodeType::Program) {}
 
+		std::shared_ptr<const CommentIndex> get_comment_index() const { return comment_index; }
+		void set_comment_index(std::shared_ptr<const CommentIndex> index) { comment_index = std::move(index); }
+
+		/**
+		 * @brief Estimate how many bytes of memory this AST occupies (including its comment index)
+		 *
+		 * ASTs never change once they've been parsed, so the tree is only walked the first time.
+		 */
+		size_t memory_usage() const {
+			size_t total = cached_memory_usage.load(std::memory_order_relaxed);
+			if (total != 0) return total;
+
+			// Every node is owned through a shared_ptr, which also has a control block
+			constexpr size_t control_block_overhead = 2 * sizeof(long);
+			if (comment_index != nullptr) total += comment_index->memory_usage() + control_block_overhead;
+
+			std::vector<const ASTNode*> nodes_to_visit = {this};
+			while (!nodes_to_visit.empty()) {
+				const ASTNode* node = nodes_to_visit.back();
+				nodes_to_visit.pop_back();
+
+				const auto& node_children = node->getChildren();
+				total += sizeof(ASTNode) + control_block_overhead + node_children.capacity() * sizeof(std::shared_ptr<ASTNode>);
+				for (const auto& child : node_children) {
+					if (child != nullptr) nodes_to_visit.push_back(child.get());
+				}
+			}
+
+			cached_memory_usage.store(total, std::memory_order_relaxed);
+			return total;
+		}
+
 		std::ostream& prettyPrint(std::ostream& os, size_t indentation_level = 0) const override {
 			std::string indent(indentation_level * PRETTYPRINT_INDENTATION_AMOUNT, ' ');
 			os << indent << "(Program";
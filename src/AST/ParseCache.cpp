@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ParseCache.h"
+
+#include <fstream>
+#include <functional>
+#include <iterator>
+
+std::shared_ptr<AST::Program> AST::ParseCache::lookup(
+	const std::shared_ptr<const std::string>& contents,
+	bool utf16_mode
+) const {
+	if (contents == nullptr) return nullptr;
+
+	const size_t key = std::hash<std::string>{}(*contents);
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	auto [begin, end] = entries.equal_range(key);
+	for (auto it = begin; it != end; ++it) {
+		const Entry& entry = it->second;
+		if (entry.utf16_mode != utf16_mode) continue;
+
+		// Same buffer, or same contents
+		if (entry.contents == contents || *entry.contents == *contents) return entry.program;
+	}
+
+	return nullptr;
+}
+
+void AST::ParseCache::store(
+	std::shared_ptr<const std::string> contents,
+	bool utf16_mode,
+	std::shared_ptr<AST::Program> program,
+	bool pinned
+) {
+	if (contents == nullptr || program == nullptr) return;
+
+	const size_t key = std::hash<std::string>{}(*contents);
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	auto [begin, end] = entries.equal_range(key);
+	for (auto it = begin; it != end; ++it) {
+		Entry& entry = it->second;
+		if (entry.utf16_mode == utf16_mode && *entry.contents == *contents) {
+			// Keep the AST which is already shared, rather than holding two copies of it
+			entry.pinned = entry.pinned || pinned;
+			return;
+		}
+	}
+
+	entries.emplace(key, Entry{std::move(contents), utf16_mode, std::move(program), pinned});
+}
+
+void AST::ParseCache::prune() {
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	std::erase_if(entries, [](const auto& pair) {
+		return !pair.second.pinned && pair.second.program.use_count() == 1;
+	});
+}
+
+size_t AST::ParseCache::size() const {
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	return entries.size();
+}
+
+void AST::ParseCache::clear() {
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	entries.clear();
+}
+
+std::shared_ptr<const std::string> AST::ParseCache::read_file(const std::string& file_path) {
+	std::ifstream file_stream(file_path);
+	if (!file_stream.is_open()) return nullptr;
+	return std::make_shared<const std::string>(
+		(std::istreambuf_iterator<char>(file_stream)),
+		std::istreambuf_iterator<char>()
+	);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <AST/Nodes/Program.h>
+
+namespace AST {
+
+/**
+ * @class ParseCache
+ * @brief A cache of parsed ASTs, keyed by the contents they were parsed from.
+ *
+ * The language server re-analyzes a whole program every time one of its files changes.
+ * But most of the files in a program (e.g., everything it @include's) usually haven't changed.
+ * The listener never modifies the AST it walks, so the AST of an unchanged file can be reused as-is,
+ * and only the edited file has to go back through the lexer and parser.
+ *
+ * Only parsing is saved: the listener still walks every file of the program again, included files too.
+ * An included file's classes and objects are added directly to the program which includes it,
+ * and what they compile to depends on what was declared before the @include,
+ * so there is no per-file result of the walk which could be kept and reused.
+ *
+ * Only ASTs which parsed without errors are cached.
+ *
+ * ASTs don't record which file they came from, so entries are keyed by contents alone:
+ * every program which includes the same file, or a file with the same contents under another path,
+ * shares one reference-counted copy of its AST.
+ * So ten programs which all include the same library file hold one copy of its AST between them.
+ * Entries which are no longer used by any program can be dropped with prune(),
+ * unless they were stored as pinned (e.g., the pre-parsed standard library).
+ *
+ * All methods are thread-safe.
+ *
+ */
+class ParseCache {
+	private:
+		struct Entry {
+			std::shared_ptr<const std::string> contents;
+			bool utf16_mode = false;
+			std::shared_ptr<AST::Program> program;
+			bool pinned = false; // Whether to keep this entry even when no program is using it
+		};
+
+		std::unordered_multimap<size_t, Entry> entries; // Keyed by a hash of the contents
+		mutable std::mutex cache_mutex;
+	public:
+		/**
+		 * @brief Get the cached AST which was parsed from exactly these contents
+		 *
+		 * @return std::shared_ptr<AST::Program> The cached AST, or nullptr if there is none
+		 */
+		std::shared_ptr<AST::Program> lookup(
+			const std::shared_ptr<const std::string>& contents,
+			bool utf16_mode
+		) const;
+
+		/**
+		 * @brief Store the AST parsed from the given contents
+		 *
+		 * If an AST for the same contents is already cached, that one is kept (and pinned, if requested)
+		 * An AST of an older version of the same file stays cached until it's pruned
+		 */
+		void store(
+			std::shared_ptr<const std::string> contents,
+			bool utf16_mode,
+			std::shared_ptr<AST::Program> program,
+			bool pinned = false
+		);
+
+		/**
+		 * @brief Drop every unpinned entry whose AST isn't held by anyone but the cache
+		 */
+		void prune();
+
+		size_t size() const;
+
+		void clear();
+
+		/**
+		 * @brief Read a file from disk
+		 *
+		 * @return std::shared_ptr<const std::string> The file's contents, or nullptr if it could not be read
+		 */
+		static std::shared_ptr<const std::string> read_file(const std::string& file_path);
+};
+
+} // namespace AST
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "PositionIndex.h"
+
+#include <algorithm>
+
+namespace AST {
+
+PositionIndex::PositionIndex(const std::shared_ptr<ASTNode>& root) {
+	if (root == nullptr) return;
+
+	spans.push_back({root->getPosition(), root->getEndPosition(), 0, 0, root});
+
+	// Breadth-first: when we get to a node, its children are appended all at once,
+	// So they end up next to each other
+	for (size_t i = 0; i < spans.size(); i++) {
+		spans[i].first_child = static_cast<uint32_t>(spans.size());
+		// Copy the node pointer: push_back may reallocate the array out from under spans[i]
+		const std::shared_ptr<ASTNode> node = spans[i].node;
+		for (const auto& child : node->getChildren()) {
+			if (child == nullptr) continue;
+			spans.push_back({child->getPosition(), child->getEndPosition(), 0, 0, child});
+		}
+		spans[i].child_count = static_cast<uint32_t>(spans.size()) - spans[i].first_child;
+	}
+	spans.shrink_to_fit();
+}
+
+std::shared_ptr<ASTNode> PositionIndex::find(uint32_t line, uint32_t column) const {
+	if (spans.empty()) return nullptr;
+
+	const uint64_t position = (static_cast<uint64_t>(line) << 32) | column;
+	if (!spans[0].contains(position)) return nullptr;
+
+	const Span* current = &spans[0];
+	while (current->child_count > 0) {
+		auto children_begin = spans.begin() + current->first_child;
+		auto children_end = children_begin + current->child_count;
+
+		// Siblings are in source order and don't overlap (except possibly at a shared boundary),
+		// So both their starts and their stops are sorted
+		// Only the children which start at or before the position can contain it
+		auto candidates_end = std::upper_bound(children_begin, children_end, position,
+			[](uint64_t position, const Span& span) { return position < span.start; });
+
+		// The first of those which doesn't end before the position is the first one which contains it
+		auto child = std::lower_bound(children_begin, candidates_end, position,
+			[](const Span& span, uint64_t position) { return span.stop < position; });
+
+		if (child == candidates_end) break; // The position falls between children
+		current = &*child;
+	}
+	return current->node;
+}
+
+size_t PositionIndex::size() const {
+	return spans.size();
+}
+
+size_t PositionIndex::memory_usage() const {
+	return spans.capacity() * sizeof(Span);
+}
+
+} // namespace AST
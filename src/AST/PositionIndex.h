@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <AST/ASTNode.h>
+
+namespace AST {
+
+/**
+ * @class PositionIndex
+ * @brief A flat index of the spans of every node in an AST, for finding the node at a given position.
+ *
+ * The nodes are laid out in one array in breadth-first order, so that the children of every node are contiguous.
+ * Each entry holds the node's start and end positions (packed into 64-bit integers, line in the upper half),
+ * and the range of its children in the array.
+ *
+ * A lookup descends from the root, and at each level binary searches the current node's children
+ * for the first one containing the position. A lookup therefore costs O(depth * log(branching)),
+ * instead of visiting every node which comes before the position.
+ * In particular, a file with thousands of top-level statements costs a single binary search at the top level.
+ *
+ * The result is the same node find_node_at_position would find by walking the AST recursively:
+ * the deepest node reached by always descending into the first child which contains the position.
+ *
+ * The index is immutable once built, and can be queried from any number of threads.
+ *
+ */
+class PositionIndex {
+	private:
+		struct Span {
+			uint64_t start;
+			uint64_t stop; // Inclusive
+			uint32_t first_child;
+			uint32_t child_count;
+			std::shared_ptr<ASTNode> node;
+
+			bool contains(uint64_t position) const { return start <= position && position <= stop; }
+		};
+
+		std::vector<Span> spans; // Breadth-first order
+
+	public:
+		PositionIndex() = default;
+		explicit PositionIndex(const std::shared_ptr<ASTNode>& root);
+
+		/**
+		 * @brief Find the innermost node containing the given position
+		 *
+		 * @return std::shared_ptr<ASTNode> The node, or nullptr if the position is outside the AST entirely
+		 */
+		std::shared_ptr<ASTNode> find(uint32_t line, uint32_t column) const;
+
+		size_t size() const;
+		size_t memory_usage() const;
+};
+
+} // namespace AST
@@ -6,7 +6,11 @@
 
 // Bash++ Language Server
 
+#include <charconv>
+#include <csignal>
+#include <cstdint>
 #include <iostream>
+#include <string_view>
 
 #include <lsp/BashppServer.h>
 #include <include/BashVersion.h>
@@ -16,6 +20,9 @@
 #include <updated_year.h>
 
 int main(int argc, char* argv[]) {
+	// A client which goes away mid-write should make the write fail, not kill the server
+	std::signal(SIGPIPE, SIG_IGN);
+
 	bpp::BashppServer server;
 
 	constexpr XGetOpt::OptionParser<
@@ -24,6 +31,8 @@ int main(int argc, char* argv[]) {
 		XGetOpt::Option<'I', "include", "Add a directory to include path", XGetOpt::RequiredArgument, "path">,
 		XGetOpt::Option<'j', "threads", "Number of threads to use for parsing and analysis (default: number of CPU cores)", XGetOpt::RequiredArgument, "num_threads">,
 		XGetOpt::Option<'l', "log", "Log messages to the specified file", XGetOpt::RequiredArgument, "file">,
+		XGetOpt::Option<1002, "log-level", "Log level: error, warning, info, or debug (default: info)", XGetOpt::RequiredArgument, "level">,
+		XGetOpt::Option<'m', "memory-budget", "Memory budget for analyzed programs, in MiB (default: 512)", XGetOpt::RequiredArgument, "MiB">,
 		XGetOpt::Option<1001, "stdio", "Use standard input/output for communication (default)", XGetOpt::NoArgument>,
 		XGetOpt::Option<'h', "help", "Show this help message", XGetOpt::NoArgument>,
 		XGetOpt::Option<'v', "version", "Show version information", XGetOpt::NoArgument>
@@ -110,6 +119,35 @@ int main(int argc, char* argv[]) {
 					return 1;
 				}
 				break;
+			case 'm':
+				{
+					const std::string_view budget_arg = arg.getArgument();
+					size_t budget_in_mebibytes = 0;
+					auto parsed = std::from_chars(budget_arg.data(), budget_arg.data() + budget_arg.size(), budget_in_mebibytes);
+					if (budget_arg.empty() || parsed.ec != std::errc() || parsed.ptr != budget_arg.data() + budget_arg.size()
+						|| budget_in_mebibytes > SIZE_MAX / (1024 * 1024)
+					) {
+						std::cerr << "Invalid memory budget: " << budget_arg << std::endl;
+						return 1;
+					}
+					if (budget_in_mebibytes == 0) {
+						std::cerr << "Memory budget must be greater than 0." << std::endl;
+						return 1;
+					}
+					server.setMemoryBudget(budget_in_mebibytes * 1024 * 1024);
+				}
+				break;
+			case 1002: // --log-level
+				{
+					std::optional<Logger::Level> level = Logger::level_from_string(arg.getArgument());
+					if (!level.has_value()) {
+						std::cerr << "Invalid log level: " << arg.getArgument() << std::endl
+							<< "Expected one of: error, warning, info, debug" << std::endl;
+						return 1;
+					}
+					server.setLogLevel(level.value());
+				}
+				break;
 			case 1001: // --stdio
 				// No-op
 				// The language server does not yet support any other communication method
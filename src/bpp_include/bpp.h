@@ -10,10 +10,13 @@
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <compare>
+#include <cstdint>
 
 #include <include/EntityMap.h>
 #include <include/BashVersion.h>
 #include <AST/Nodes/Program.h>
+#include "interned_files.h"
 
 namespace bpp {
 
@@ -88,6 +91,18 @@ class bpp_object_address;
  */
 static const char bpp_nullptr[] = "0";
 
+/**
+ * @var validated_method_suffix
+ * @brief Appended to a method's function name to get its "validated this" entry point
+ *
+ * The validated entry point skips this_pointer_validation, and so must only be called with the resolved address of an existing object.
+ * Every method has both entry points whether or not it was compiled in release mode,
+ * so that code compiled in either mode can call methods compiled in the other (e.g., in a dynamically included library).
+ * Only one of the two holds the method's body: in release mode, the checked entry point validates @this and then calls the validated one;
+ * otherwise, the validated entry point simply calls the checked one.
+ */
+static const char validated_method_suffix[] = "____validated";
+
 /**
  * @var protected_keywords
  * @brief A list of keywords that are reserved and cannot be used as identifiers in Bash++
@@ -147,6 +162,29 @@ struct SymbolPosition {
 		: file(file), line(line), column(column) {}
 };
 
+/**
+ * @brief A compact record of where an entity is referenced
+ *
+ * Entities can be referenced thousands of times, so rather than a copy of the file path,
+ * each reference carries the path's interned FileId, and fits in 12 bytes.
+ * References order by file, then line, then column.
+ */
+struct ReferencePosition {
+	FileId file = 0;
+	uint32_t line = 0;
+	uint32_t column = 0;
+
+	ReferencePosition() = default;
+	ReferencePosition(FileId file, uint32_t line, uint32_t column)
+		: file(file), line(line), column(column) {}
+
+	const std::string& get_file() const {
+		return get_interned_file_path(file);
+	}
+
+	auto operator<=>(const ReferencePosition&) const = default;
+};
+
 template <class T>
 class OwnedEntityList {
 	private:
@@ -9,6 +9,8 @@
 #include "bpp_datamember.h"
 #include "bpp_codegen.h"
 
+#include <algorithm>
+
 namespace bpp {
 
 /**
@@ -39,6 +41,7 @@ void bpp_class::add_default_toPrimitive()  {
 		toPrimitive->set_scope(bpp_scope::SCOPE_PUBLIC);
 		toPrimitive->set_virtual(true);
 		toPrimitive->set_last_override(name);
+		toPrimitive->set_finalized(true);
 		remove_default_toPrimitive();
 		methods.push_back(toPrimitive);
 	}
@@ -298,6 +301,14 @@ std::shared_ptr<bpp::bpp_class> bpp_class::get_parent() {
 	return parents.back().lock();
 }
 
+bool bpp_class::is_derived_from(const std::shared_ptr<bpp_class>& ancestor) const {
+	if (ancestor == nullptr) return false;
+	if (ancestor.get() == this) return true;
+	return std::ranges::any_of(parents, [&ancestor](const std::weak_ptr<bpp_class>& parent) {
+		return parent.lock() == ancestor;
+	});
+}
+
 std::vector<std::shared_ptr<bpp_class>> bpp_class::get_all_known_classes() const {
 	auto result = bpp_entity::get_all_known_classes();
 	// Append this class itself to the end of the list
@@ -50,6 +50,11 @@ class bpp_class : public bpp_entity, public std::enable_shared_from_this<bpp_cla
 		void inherit(std::shared_ptr<bpp_class> parent) override;
 		std::shared_ptr<bpp::bpp_class> get_parent();
 
+		/**
+		 * @brief Whether this class is the given class, or inherits from it (directly or indirectly)
+		 */
+		bool is_derived_from(const std::shared_ptr<bpp_class>& ancestor) const;
+
 		std::vector<std::shared_ptr<bpp_class>> get_all_known_classes() const override;
 };
 
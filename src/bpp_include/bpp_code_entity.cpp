@@ -143,7 +143,7 @@ bool bpp_code_entity::add_object(std::shared_ptr<bpp_object> object, bool make_l
 			object_code += generate_new_code(object->get_address(), object->get_class(), make_local, true).full_code() + "\n";
 			// Call the constructor if it exists
 			if (object->get_class()->get_method_UNSAFE("__constructor") != nullptr) {
-				auto constructor_code = generate_constructor_call_code(object->get_address(), object->get_class());
+				auto constructor_code = generate_constructor_call_code(object->get_address(), object->get_class(), get_containing_program().lock());
 				object_code += constructor_code.full_code();
 			}
 		}
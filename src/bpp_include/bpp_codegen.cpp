@@ -10,6 +10,10 @@
 #include "bpp_class.h"
 #include "bpp_method.h"
 #include "bpp_datamember.h"
+#include "replace_all.h"
+
+#include <algorithm>
+#include <string_view>
 
 namespace bpp {
 
@@ -62,6 +66,7 @@ code_segment generate_supershell_code(
 	result.pre_code += "bpp____supershell " + supershell_output_variable + " " + supershell_function_name + "\n";
 	result.post_code += "unset -f " + supershell_function_name + "\n";
 	result.post_code += "unset " + supershell_output_variable + "\n";
+	program->add_temporary(supershell_output_variable);
 
 	result.code = "${" + supershell_output_variable + "}";
 
@@ -110,10 +115,26 @@ static inline code_segment _generate_virtual_method_call_code(
 ) {
 	code_segment result;
 
+	const std::string function_variable = "__func" + std::to_string(program->get_function_counter());
+
+	if (program->get_release_mode()) {
+		// The vTable lookup has already followed the reference to the object and checked that it exists
+		// So it hands back the object's resolved address as well, and we call the method's "validated this" entry point
+		const std::string this_variable = "__funcThis" + std::to_string(program->get_function_counter());
+		result.pre_code = "if bpp____vTable__lookup \"" + reference_code + "\" \"" + method_name + "\" " + function_variable + " " + this_variable + "; then\n";
+		result.post_code = "	unset " + function_variable + " " + this_variable + "\nfi\n";
+		result.code = "	${!" + function_variable + "}" + validated_method_suffix + " ${" + this_variable + "}";
+		program->add_temporary(function_variable);
+		program->add_temporary(this_variable);
+		program->increment_function_counter();
+		return result;
+	}
+
 	// Perform a vTable lookup, store the result in the temporary variable, and execute
-	result.pre_code = "if bpp____vTable__lookup \"" + reference_code + "\" \"" + method_name + "\" __func" + std::to_string(program->get_function_counter()) + "; then\n";
-	result.post_code = "	unset __func" + std::to_string(program->get_function_counter()) + "\nfi\n";
-	result.code = "	${!__func" + std::to_string(program->get_function_counter()) + "} " + reference_code;
+	result.pre_code = "if bpp____vTable__lookup \"" + reference_code + "\" \"" + method_name + "\" " + function_variable + "; then\n";
+	result.post_code = "	unset " + function_variable + "\nfi\n";
+	result.code = "	${!" + function_variable + "} " + reference_code;
+	program->add_temporary(function_variable);
 	program->increment_function_counter();
 
 	return result;
@@ -126,6 +147,11 @@ static inline code_segment _generate_virtual_method_call_code(
  * - A lookup in the object's vTable if the method is virtual.
  * - A call to the method.
  *
+ * In release mode, calls which are known to have the resolved address of an existing object
+ * (calls made through the vTable lookup, and non-virtual calls on @this from within a method)
+ * go to the method's "validated this" entry point, skipping this_pointer_validation.
+ * Every method has that entry point, even if its class was compiled without release mode (see validated_method_suffix).
+ *
  * @param reference_code The code representing the object reference.
  * @param method_name The name of the method to be called.
  * @param assumed_class The class to which the object is assumed to belong at compile-time.
@@ -170,15 +196,288 @@ code_segment generate_method_call_code(
 		if (class_containing_the_method != nullptr) {
 			class_name = class_containing_the_method->get_name();
 		}
-		result.code = "bpp__" + class_name + "__" + method_name + " " + reference_code;
+		result.code = "bpp__" + class_name + "__" + method_name;
+		// Inside of a method, ${__this} has already been validated by the method itself
+		if (program->get_release_mode() && reference_code == "${__this}") {
+			result.code += validated_method_suffix;
+		}
+		result.code += " " + reference_code;
 	}
 
 	return result;
 }
 
+static inline bool _is_identifier_character(char c) {
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+/**
+ * @brief Whether the given words can be echoed in the caller's context with the same result as from within the method
+ *
+ * Rejects anything which behaves differently outside of the method:
+ * 	- The method's parameters, the positional parameters, and special parameters such as $? and $FUNCNAME
+ * 	- Command substitutions and backquotes, which could run anything at all
+ * 	- Anything which would end the command or redirect its output
+ * 	- A literal first word beginning with '-', which echo would take as an option
+ */
+static bool _can_echo_in_place(std::string_view words, const std::vector<std::shared_ptr<bpp::bpp_method_parameter>>& parameters) {
+	auto first_character = words.find_first_not_of("\"'");
+	if (first_character != std::string_view::npos && words[first_character] == '-') return false;
+
+	auto is_unsafe_variable = [&](std::string_view name) {
+		if (name == "FUNCNAME" || name == "LINENO" || name == "BASH_LINENO" || name == "BASH_SOURCE") return true;
+		return std::any_of(parameters.begin(), parameters.end(), [&](const auto& parameter) {
+			return parameter->get_name() == name;
+		});
+	};
+
+	bool in_double_quotes = false;
+	for (size_t i = 0; i < words.size(); i++) {
+		char c = words[i];
+		if (c == '\\') {
+			i++;
+			continue;
+		}
+		if (c == '\'' && !in_double_quotes) {
+			size_t closing_quote = words.find('\'', i + 1);
+			if (closing_quote == std::string_view::npos) return false;
+			i = closing_quote;
+			continue;
+		}
+		if (c == '"') {
+			in_double_quotes = !in_double_quotes;
+			continue;
+		}
+		if (c == '`') return false;
+		if (!in_double_quotes && std::string_view(";&|<>()").find(c) != std::string_view::npos) return false;
+		if (c != '$' || i + 1 >= words.size()) continue;
+
+		// Parameter expansion: find the name of the variable being expanded
+		size_t name_start = i + 1;
+		if (words[name_start] == '{') {
+			name_start++;
+			if (name_start < words.size() && (words[name_start] == '!' || words[name_start] == '#')) name_start++;
+		} else if (words[name_start] == '\'' || words[name_start] == '"') {
+			continue; // $'...' or $"..."
+		}
+		if (name_start >= words.size() || !_is_identifier_character(words[name_start]) || (words[name_start] >= '0' && words[name_start] <= '9')) {
+			return false; // Positional or special parameter, or a command substitution
+		}
+		size_t name_end = name_start;
+		while (name_end < words.size() && _is_identifier_character(words[name_end])) name_end++;
+		if (is_unsafe_variable(words.substr(name_start, name_end - name_start))) return false;
+		i = name_end - 1;
+	}
+	return !in_double_quotes;
+}
+
+/**
+ * @brief Generates a code segment which runs a method's body in place of an rvalue call to it
+ *
+ * Calling a method as an rvalue means running it in a supershell and capturing its output,
+ * which costs far more than the bodies of trivial methods such as getters or the default toPrimitive.
+ * If the method's compiled body is nothing but a single echo, along with the temporary variables used to resolve its references to @this,
+ * the body can instead be run at the call site, with the echo turned into an assignment to a temporary variable.
+ *
+ * A method is only inlined if:
+ * 	- It has been compiled in full (so never from within its own body)
+ * 	- It was marked @inline, or its body is no longer than the program's inline threshold
+ * 	- Its echo doesn't depend on anything local to the method (see _can_echo_in_place)
+ *
+ * Rvalue calls never receive any arguments, so the method's parameters don't need to be bound to anything;
+ * the method just can't refer to them.
+ * The temporary variables derived from __this are renamed so that they can't clash with the caller's own.
+ *
+ * Only these echo-only methods are inlined.
+ * Calls made as commands (e.g. setters) and methods which run anything else (e.g. wrappers around other methods)
+ * are always called normally, since inlining them would mean binding their arguments and renaming their locals in the compiled text.
+ *
+ * The caller is responsible for only inlining calls whose target is known at compile time.
+ *
+ * @param reference_code The code representing the object the method is called on
+ * @param method The method to inline
+ * @param assumed_class The class of the object the method is called on
+ * @return std::optional<code_segment> The inlined call, or std::nullopt if the method can't be inlined
+ */
+std::optional<code_segment> generate_inline_method_call_code(
+	const std::string& reference_code,
+	std::shared_ptr<bpp::bpp_method> method,
+	std::shared_ptr<bpp::bpp_class> assumed_class,
+	std::shared_ptr<bpp::bpp_program> program
+) {
+	if (method == nullptr || !method->is_finalized()) return std::nullopt;
+
+	auto is_this_temporary_variable = [](std::string_view name) {
+		if (!name.starts_with("__this")) return false;
+		return std::all_of(name.begin(), name.end(), _is_identifier_character);
+	};
+
+	// Split the body into the assignments and unsets of temporary variables, and the echo
+	std::vector<std::string> pre_echo_lines;
+	std::vector<std::string> post_echo_lines;
+	std::optional<std::string> echoed_words;
+	std::string body = method->get_code();
+	std::string_view remaining_body = body;
+	while (!remaining_body.empty()) {
+		size_t line_end = remaining_body.find('\n');
+		std::string_view line = remaining_body.substr(0, line_end);
+		remaining_body.remove_prefix(line_end == std::string_view::npos ? remaining_body.size() : line_end + 1);
+
+		size_t line_start = line.find_first_not_of(" \t");
+		if (line_start == std::string_view::npos || line[line_start] == '#') continue;
+		line.remove_prefix(line_start);
+		while (line.back() == ' ' || line.back() == '\t') line.remove_suffix(1);
+
+		if (line == "echo" || line.starts_with("echo ")) {
+			if (echoed_words.has_value()) return std::nullopt;
+			std::string_view words = line.substr(4);
+			words.remove_prefix(std::min(words.find_first_not_of(" \t"), words.size()));
+			if (!_can_echo_in_place(words, method->get_parameters())) return std::nullopt;
+			echoed_words = std::string(words);
+			continue;
+		}
+
+		if (line.starts_with("unset ")) {
+			std::string_view names = line.substr(6);
+			while (!names.empty()) {
+				size_t name_end = names.find(' ');
+				if (!is_this_temporary_variable(names.substr(0, name_end))) return std::nullopt;
+				names.remove_prefix(name_end == std::string_view::npos ? names.size() : name_end + 1);
+			}
+			(echoed_words.has_value() ? post_echo_lines : pre_echo_lines).emplace_back(line);
+			continue;
+		}
+
+		// Anything else has to be the assignment of a temporary variable, before the echo
+		// The inlined code might not be in a function, so it can't declare them local (they're unset at the end of the body anyway)
+		if (line.starts_with("local ")) line.remove_prefix(6);
+		size_t equals = line.find('=');
+		if (echoed_words.has_value()
+			|| equals == std::string_view::npos
+			|| !is_this_temporary_variable(line.substr(0, equals))
+			|| line.find_first_of(" \t;&|<>()`", equals) != std::string_view::npos
+		) {
+			return std::nullopt;
+		}
+		pre_echo_lines.emplace_back(line);
+	}
+
+	if (!echoed_words.has_value()) return std::nullopt;
+
+	uint64_t body_length = pre_echo_lines.size() + 1 + post_echo_lines.size();
+	if (!method->has_inline_hint() && body_length > program->get_inline_threshold()) return std::nullopt;
+
+	// The function the call would have gone to
+	std::string class_name = assumed_class->get_name();
+	if (method->is_virtual() && !method->get_last_override().empty()) {
+		class_name = method->get_last_override();
+	} else if (auto class_containing_the_method = method->get_containing_class().lock(); class_containing_the_method != nullptr) {
+		class_name = class_containing_the_method->get_name();
+	}
+
+	code_segment result;
+
+	const std::string prefix = "__inline" + std::to_string(program->get_inline_counter());
+	const std::string this_variable = prefix + "__this";
+	const std::string output_variable = prefix + "__output";
+	const std::string vPointer_variable = prefix + "__vPointer";
+	program->add_temporary(this_variable);
+	program->add_temporary(output_variable);
+	program->add_temporary(vPointer_variable);
+	const bool associative = program->get_associative_objects();
+
+	auto rename_this = [&](const std::string& code) {
+		std::string renamed;
+		size_t position = 0;
+		for (size_t match = code.find("__this"); match != std::string::npos; match = code.find("__this", match + 6)) {
+			if (match > 0 && _is_identifier_character(code[match - 1])) continue;
+			renamed += code.substr(position, match - position) + prefix;
+			position = match;
+		}
+		return renamed + code.substr(position);
+	};
+
+	std::string inlined_body;
+	for (const auto& line : pre_echo_lines) inlined_body += rename_this(line) + "\n";
+
+	// Turn the echo into an assignment
+	// A command substitution would have stripped any trailing newlines from the output, so we strip them too
+	const std::string strip_trailing_newlines = output_variable + "=\"${" + output_variable + "%\"${" + output_variable + "##*[!$'\\n']}\"}\"\n";
+	std::string words = rename_this(*echoed_words);
+	bool single_quoted_word = words.size() >= 2 && words.front() == '"' && words.back() == '"';
+	for (size_t i = 1; single_quoted_word && i + 1 < words.size(); i++) {
+		if (words[i] == '\\') i++;
+		else if (words[i] == '"') single_quoted_word = false;
+	}
+	bool literal_words = words.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_.,:+=/%@- \t") == std::string::npos;
+
+	if (words.empty()) {
+		// Nothing to do; the output variable is already empty
+	} else if (literal_words) {
+		// Known at compile time (e.g., the default toPrimitive)
+		std::string joined_words;
+		for (size_t i = 0; i < words.size(); i++) {
+			if (words[i] == ' ' || words[i] == '\t') {
+				if (!joined_words.empty() && joined_words.back() != ' ') joined_words += ' ';
+				continue;
+			}
+			joined_words += words[i];
+		}
+		if (!joined_words.empty() && joined_words.back() == ' ') joined_words.pop_back();
+		inlined_body += output_variable + "=\"" + joined_words + "\"\n";
+	} else if (single_quoted_word) {
+		inlined_body += output_variable + "=" + words + "\n";
+		inlined_body += strip_trailing_newlines;
+	} else {
+		// Echo joins its arguments with spaces
+		inlined_body += "printf -v " + output_variable + " '%s ' " + words + "\n";
+		inlined_body += output_variable + "=\"${" + output_variable + "% }\"\n";
+		inlined_body += strip_trailing_newlines;
+	}
+
+	for (const auto& line : post_echo_lines) inlined_body += rename_this(line) + "\n";
+
+	result.pre_code = this_variable + "=" + reference_code + "\n";
+	result.pre_code += output_variable + "=\n";
+	if (program->get_release_mode() && reference_code == "${__this}") {
+		// Inside of a method, ${__this} has already been validated by the method itself
+		result.pre_code += inlined_body;
+	} else {
+		// Follow the reference to the object and check that it exists, just as the method itself would have
+		result.pre_code += "while [[ " + generate_reference_check(this_variable, associative) + " && -n \"${!" + this_variable + "-}\" ]]; do\n"
+			"	" + this_variable + "=\"${!" + this_variable + "}\"\n"
+			"done\n"
+			+ vPointer_variable + "=\"" + get_vpointer_variable("${" + this_variable + "}", associative) + "\"\n"
+			"if [[ \"${" + this_variable + "}\" != [A-Za-z_]* || \"${" + this_variable + "}\" == *[!A-Za-z0-9_]* || -z \"${!" + vPointer_variable + "-}\" ]]; then\n"
+			"	>&2 echo \"Bash++: Error: Attempted to call @" + class_name + "." + method->get_name() + " on null object\"\n"
+			"else\n"
+			+ inlined_body +
+			"fi\n"
+			"unset " + vPointer_variable + "\n";
+	}
+	result.code = "${" + output_variable + "}";
+	result.post_code = "unset " + this_variable + " " + output_variable + "\n";
+
+	program->increment_inline_counter();
+
+	return result;
+}
+
+/**
+ * @brief Generates a code segment for calling a class's constructor (if it has one).
+ *
+ * Constructors are only ever called on objects which have just been created,
+ * or on ${__this} from within a derived class's constructor.
+ * So in release mode, the constructor's "validated this" entry point is always called.
+ *
+ * @param reference_code The resolved address of the object being constructed
+ * @param assumed_class The class whose constructor should be called
+ * @return code_segment The code segment to call the constructor (empty if the class has no constructor)
+ */
 code_segment generate_constructor_call_code(
 	const std::string& reference_code,
-	std::shared_ptr<bpp_class> assumed_class
+	std::shared_ptr<bpp_class> assumed_class,
+	std::shared_ptr<bpp::bpp_program> program
 ) {
 	code_segment result;
 	auto constructor_method = assumed_class->get_method_UNSAFE("__constructor");
@@ -190,7 +489,9 @@ code_segment generate_constructor_call_code(
 		class_name = class_containing_the_constructor->get_name();
 	}
 
-	result.code = "bpp__" + class_name + "____constructor " + reference_code + "\n";
+	result.code = "bpp__" + class_name + "____constructor";
+	if (program != nullptr && program->get_release_mode()) result.code += validated_method_suffix;
+	result.code += " " + reference_code + "\n";
 
 	return result;
 }
@@ -214,7 +515,11 @@ code_segment generate_destructor_call_code(
 			class_name = class_containing_the_destructor->get_name();
 		}
 		code_segment result;
-		result.code = "bpp__" + class_name + "____destructor " + reference_code;
+		result.code = "bpp__" + class_name + "____destructor";
+		if (program->get_release_mode() && reference_code == "${__this}") {
+			result.code += validated_method_suffix;
+		}
+		result.code += " " + reference_code;
 		return result;
 	}
 }
@@ -245,6 +550,7 @@ code_segment generate_dynamic_cast_code(
 	result.pre_code = "bpp____dynamic__cast \"" + class_name + "\" \"__dynamicCast" + std::to_string(program->get_dynamic_cast_counter()) + "\" " + reference_code + "\n";
 	result.code = "${__dynamicCast" + std::to_string(program->get_dynamic_cast_counter()) + "}";
 	result.post_code = "unset __dynamicCast" + std::to_string(program->get_dynamic_cast_counter()) + "\n";
+	program->add_temporary("__dynamicCast" + std::to_string(program->get_dynamic_cast_counter()));
 
 	program->increment_dynamic_cast_counter();
 
@@ -260,12 +566,59 @@ code_segment generate_typeof_code(
 	result.pre_code = "bpp____typeof " + reference_code + " __typeof" + std::to_string(program->get_typeof_counter()) + "\n";
 	result.code = "${__typeof" + std::to_string(program->get_typeof_counter()) + "}";
 	result.post_code = "unset __typeof" + std::to_string(program->get_typeof_counter()) + "\n";
+	program->add_temporary("__typeof" + std::to_string(program->get_typeof_counter()));
 
 	program->increment_typeof_counter();
 
 	return result;
 }
 
+/**
+ * @brief Generates a code segment which checks that a reference points to an object.
+ *
+ * This stands in for a dynamic cast whose outcome is known at compile time, apart from whether there's an object there at all.
+ * That is, when the type of the referenced object (if any) is known to be compatible with the cast.
+ * No call into the runtime is needed: as in the runtime's own functions, pointers to pointers are followed to the object,
+ * and the object exists if and only if it has a vPointer.
+ *
+ * @param reference_code The code representing the object reference
+ *
+ * @return A code segment structure containing the null check:
+ * 	- pre_code: The check itself
+ * 	- post_code: Code for cleaning up the check's temporary variable
+ * 	- code: The temporary variable containing the result (either the address or the @nullptr value)
+ */
+code_segment generate_null_check_code(
+	const std::string& reference_code,
+	std::shared_ptr<bpp::bpp_program> program
+) {
+	code_segment result;
+
+	const std::string result_variable = "__nullCheck" + std::to_string(program->get_null_check_counter());
+	const bool associative = program->get_associative_objects();
+	result.pre_code = result_variable + "=" + reference_code + "\n"
+		"if [[ -z \"${" + result_variable + "}\" ]] || [[ \"${" + result_variable + "}\" == \"" + bpp_nullptr + "\" ]]; then\n"
+		"	" + result_variable + "=" + bpp_nullptr + "\n"
+		"else\n"
+		"	while [[ " + generate_reference_check(result_variable, associative) + " && -n \"${!" + result_variable + "-}\" ]]; do\n"
+		"		" + result_variable + "=\"${!" + result_variable + "}\"\n"
+		"	done\n"
+		"	" + result_variable + "__vPointer=\"" + get_vpointer_variable("${" + result_variable + "}", associative) + "\"\n"
+		"	if [[ \"${" + result_variable + "}\" != [A-Za-z_]* || \"${" + result_variable + "}\" == *[!A-Za-z0-9_]* || -z \"${!" + result_variable + "__vPointer-}\" ]]; then\n"
+		"		" + result_variable + "=" + bpp_nullptr + "\n"
+		"	fi\n"
+		"	unset " + result_variable + "__vPointer\n"
+		"fi\n";
+	result.code = "${" + result_variable + "}";
+	result.post_code = "unset " + result_variable + "\n";
+	program->add_temporary(result_variable);
+	program->add_temporary(result_variable + "__vPointer");
+
+	program->increment_null_check_counter();
+
+	return result;
+}
+
 /**
  * @brief Generates a code segment for creating a new object of a given class.
  *
@@ -315,20 +668,44 @@ code_segment generate_code_for_new_method(
 ) {
 	code_segment result;
 	std::string maybe_local = inline_new ? "local " : "";
-
-	result.pre_code += "	eval \"" + maybe_local + new_address + "____vPointer=bpp__" + new_class->get_name() + "____vTable\"\n";
+	const bool associative = new_class->get_containing_program().lock()->get_associative_objects();
+
+	// In the associative array layout, the vPointer and every data member which isn't an array or an object
+	// are set in a single compound assignment once all of their values are known
+	// Array and object data members are set up after the object's array has been created
+	std::string compound_assignment;
+	std::string compound_assignment_cleanup;
+	std::string deferred_code;
+	std::string& member_code = associative ? deferred_code : result.pre_code;
+
+	if (associative) {
+		compound_assignment = "[__vPointer]=bpp__" + new_class->get_name() + "____vTable";
+	} else {
+		result.pre_code += "	eval \"" + maybe_local + new_address + "____vPointer=bpp__" + new_class->get_name() + "____vTable\"\n";
+	}
 
 	for (const auto& dm : new_class->get_datamembers()) {
-		result.pre_code += dm->get_pre_access_code() + "\n";
+		if (associative && (dm->is_pointer() || (dm->get_class() == nullptr && !dm->is_array()))) {
+			// Work out the value now, and store it with the rest in the compound assignment
+			std::string value_variable = "__objAssignment__" + dm->get_name();
+			result.pre_code += dm->get_pre_access_code() + "\n";
+			result.pre_code += "	local " + value_variable + "=" + dm->get_default_value() + "\n";
+			result.pre_code += dm->get_post_access_code() + "\n";
+			compound_assignment += " [" + dm->get_name() + "]=\\\"\\${" + value_variable + "}\\\"";
+			compound_assignment_cleanup += "	unset " + value_variable + "\n";
+			continue;
+		}
+
+		member_code += dm->get_pre_access_code() + "\n";
 		if (dm->get_class() == nullptr) {
 			// class == nullptr indicates a primitive
 			// Is it an array?
 			if (dm->is_array()) {
-				result.pre_code += "	eval \"" + maybe_local + new_address + "__" + dm->get_name() + "=" + dm->get_default_value() + "\"\n";
+				member_code += "	eval \"" + maybe_local + new_address + "__" + dm->get_name() + "=" + dm->get_default_value() + "\"\n";
 			} else {
-				result.pre_code += "	local __objAssignment=" + dm->get_default_value() + "\n";
-				result.pre_code += "	eval \"" + maybe_local + new_address + "__" + dm->get_name() + "=\\$__objAssignment\"\n";
-				result.pre_code += "	unset __objAssignment\n";
+				member_code += "	local __objAssignment=" + dm->get_default_value() + "\n";
+				member_code += "	eval \"" + maybe_local + new_address + "__" + dm->get_name() + "=\\$__objAssignment\"\n";
+				member_code += "	unset __objAssignment\n";
 			}
 		} else if (dm->is_pointer()) {
 			std::string default_value = dm->get_default_value();
@@ -336,30 +713,53 @@ code_segment generate_code_for_new_method(
 			if (!default_value.empty() && default_value[0] == '$') {
 				default_value_preface = "\\";
 			}
-			result.pre_code += "	eval \"" + maybe_local + new_address + "__" + dm->get_name() + "=" + default_value_preface + default_value + "\"\n";
+			member_code += "	eval \"" + maybe_local + new_address + "__" + dm->get_name() + "=" + default_value_preface + default_value + "\"\n";
 		} else {
+			std::string member_address = new_address + "__" + dm->get_name();
 			if (inline_new) {
 				// Recursively inline 'new' for the data member
-				code_segment inline_new_code = generate_code_for_new_method(new_address + "__" + dm->get_name(), dm->get_class(), true);
-				result.pre_code += inline_new_code.full_code() + "\n";
+				code_segment inline_new_code = generate_code_for_new_method(member_address, dm->get_class(), true);
+				member_code += inline_new_code.full_code() + "\n";
+				if (associative) {
+					// The member object has its own array, and the containing object's element points to it
+					compound_assignment += " [" + dm->get_name() + "]=" + member_address;
+				}
 			} else {
 				// Call 'new' in a supershell and assign its output
+				// The constructor (if any) is given the new object's resolved address, rather than the member which points to it:
+				// in release mode, it skips this_pointer_validation, and in the associative array layout, the member is an array element
 				code_segment supershell_code = generate_supershell_code(
 					"bpp__" + dm->get_class()->get_name() + "____new",
 					new_class->get_containing_program().lock()
 				);
-				result.pre_code += supershell_code.pre_code;
-				result.pre_code += "	eval \"" + new_address + "__" + dm->get_name() + "=" + supershell_code.code + "\"\n";
-				result.pre_code += supershell_code.post_code;
+				member_code += supershell_code.pre_code;
+				member_code += "	local __newMember=" + supershell_code.code + "\n";
+				member_code += supershell_code.post_code;
+				member_code += "	eval \"" + get_member_variable(new_address, dm->get_name(), associative) + "=\\$__newMember\"\n";
+				member_address = "${__newMember}";
 			}
 
 			// Call the constructor if it exists
 			if (dm->get_class()->get_method_UNSAFE("__constructor") != nullptr) {
-				auto constructor_code = generate_constructor_call_code(new_address + "__" + dm->get_name(), dm->get_class());
-				result.pre_code += constructor_code.full_code();
+				auto constructor_code = generate_constructor_call_code(
+					member_address,
+					dm->get_class(),
+					new_class->get_containing_program().lock()
+				);
+				member_code += constructor_code.full_code();
 			}
+			if (!inline_new) member_code += "	unset __newMember\n";
 		}
-		result.pre_code += dm->get_post_access_code() + "\n";
+		member_code += dm->get_post_access_code() + "\n";
+	}
+
+	if (associative) {
+		// A quoted compound assignment given to declare is expanded once more, just like eval would,
+		// but without the cost of running the parser on a whole new command
+		std::string declaration = inline_new ? "local -A " : "declare -gA ";
+		result.pre_code += "	" + declaration + "\"" + new_address + "=(" + compound_assignment + ")\"\n";
+		result.pre_code += compound_assignment_cleanup;
+		result.pre_code += deferred_code;
 	}
 	return result;
 }
@@ -371,8 +771,11 @@ code_segment generate_code_for_new_method(
  * It takes, of course, the '@this' pointer as its implicit first parameter (as do all methods),
  * and one explicit parameter: the address to copy from.
  *
- * The copy-from address is dynamically cast to the containing class type,
- * and therefore must point to an object which is convertible to the containing class type.
+ * The copy-from address must point to an object which is convertible to the containing class type.
+ * Every copy is type-checked at compile time: the source's class is always the class of the destination as the compiler sees it.
+ * The only way for the destination's actual class to be more derived than that (making the copy invalid)
+ * is for the destination to be a dereferenced pointer, in which case the caller checks the types at runtime before calling __copy.
+ * So the copy method itself only checks that there's an object at the copy-from address.
  *
  * TODO(@rail5): This method duplicates some code from other portions of the compiler.
  * 
@@ -400,17 +803,16 @@ std::shared_ptr<bpp::bpp_method> generate_copy_method(
 		throw bpp::ErrorHandling::InternalError("Failed to add parameter to copy method");
 	}
 
-	// Necessary type verification
-	code_segment dynamic_cast_code = generate_dynamic_cast_code(
-		param_name,
-		containing_class->get_name(),
+	// Verify that we're copying from an actual object (see above)
+	code_segment null_check_code = generate_null_check_code(
+		"${" + param_name + "}",
 		program
 	);
-	copy_method->add_code_to_previous_line(dynamic_cast_code.pre_code);
-	copy_method->add_code_to_next_line(dynamic_cast_code.post_code);
-	copy_method->add_code(param_name + "=" + dynamic_cast_code.code + "\n");
+	copy_method->add_code_to_previous_line(null_check_code.pre_code);
+	copy_method->add_code_to_next_line(null_check_code.post_code);
+	copy_method->add_code(param_name + "=" + null_check_code.code + "\n");
 
-	// Verify that the dynamic cast was successful
+	// Verify that the check was successful
 	copy_method->add_code_to_previous_line("if [[ ${" + param_name + "} == " + bpp::bpp_nullptr + " ]]; then\n"
 		"	>&2 echo \"Bash++: Error: " + containing_class->get_name() + ": Attempted to copy between incompatible types.\"\n"
 		"	return 1\n"
@@ -422,13 +824,28 @@ std::shared_ptr<bpp::bpp_method> generate_copy_method(
 	// Add the copy code for each data member
 	// WARNING: VERY FRAGILE. Also code duplication
 	for (const auto& dm : containing_class->get_datamembers()) {
+		const bool associative = program->get_associative_objects() && !dm->is_array();
 		copy_code += dm->get_pre_access_code() + "\n";
 		if (dm->get_class() == nullptr || dm->is_pointer()) {
 			copy_code += "	local __" + param_name + "__" + dm->get_name()
-				+ "=\"${" + param_name + "}__" + dm->get_name() + "\"\n";
+				+ "=\"" + get_member_variable("${" + param_name + "}", dm->get_name(), associative) + "\"\n";
 
-			copy_code += "	eval \"${__this}__" + dm->get_name()
+			copy_code += "	eval \"" + get_member_variable("${__this}", dm->get_name(), associative)
 				+ "=\\${!__" + param_name + "__" + dm->get_name() + "}\"\n";
+		} else if (associative) {
+			// Array elements are handed to the runtime through temporary variables holding their names
+			copy_code += "	local __this__" + dm->get_name() + "=\"${__this}[" + dm->get_name() + "]\"\n";
+			copy_code += "	local __" + param_name + "__" + dm->get_name() + "=\"${" + param_name + "}[" + dm->get_name() + "]\"\n";
+			code_segment method_call_code = generate_method_call_code(
+				"__this__" + dm->get_name(),
+				"__copy",
+				dm->get_class(),
+				false,
+				program
+			);
+			copy_code += method_call_code.pre_code + "\n";
+			copy_code += method_call_code.code + " __" + param_name + "__" + dm->get_name() + "\n";
+			copy_code += method_call_code.post_code + "\n";
 		} else {
 			code_segment method_call_code = generate_method_call_code(
 				"${__this}__" + dm->get_name(),
@@ -463,7 +880,7 @@ std::shared_ptr<bpp::bpp_method> generate_new_method(
 		"if [[ \"${__this}\" == \"\" ]]; then\n"
 		"	while : ; do\n"
 		"		__this=\"bpp__" + containing_class->get_name() + "__$RANDOM$RANDOM$RANDOM$RANDOM\"\n"
-		"		local __unusedVar=\"${__this}____vPointer\"\n"
+		"		local __unusedVar=\"" + get_vpointer_variable("${__this}", containing_class->get_containing_program().lock()->get_associative_objects()) + "\"\n"
 		"		[[ -z \"${!__unusedVar+x}\" ]] && break\n"
 		"	done\n"
 		"fi\n"
@@ -488,9 +905,23 @@ std::shared_ptr<bpp::bpp_method> generate_delete_method(
 	delete_method->inherit(containing_class->get_containing_program().lock());
 	delete_method->set_containing_class(containing_class);
 
+	const bool associative = containing_class->get_containing_program().lock()->get_associative_objects();
+
 	for (const auto& dm : containing_class->get_datamembers()) {
 		delete_method->add_code(dm->get_pre_access_code() + "\n");
-		if (dm->get_class() == nullptr || dm->is_pointer()) {
+		if (associative && !dm->is_array()) {
+			// The object's array is unset in one go below
+			// Only member objects need deleting first
+			if (dm->get_class() != nullptr && !dm->is_pointer()) {
+				delete_method->add_code("local __this__" + dm->get_name() + "=\"${__this}[" + dm->get_name() + "]\"\n");
+				code_segment inner_delete_code = generate_delete_code(
+					dm,
+					"__this__" + dm->get_name(),
+					containing_class->get_containing_program().lock()
+				);
+				delete_method->add_code(inner_delete_code.full_code() + "\n");
+			}
+		} else if (dm->get_class() == nullptr || dm->is_pointer()) {
 			delete_method->add_code("unset \"${__this}__" + dm->get_name() + "\"\n");
 		} else {
 			code_segment inner_delete_code = generate_delete_code(
@@ -504,8 +935,13 @@ std::shared_ptr<bpp::bpp_method> generate_delete_method(
 		delete_method->add_code(dm->get_post_access_code() + "\n");
 	}
 
-	// Unset the vPointer
-	delete_method->add_code("unset \"${__this}____vPointer\"\n");
+	if (associative) {
+		// Unset the object's array, including its vPointer
+		delete_method->add_code("unset \"${__this}\"\n");
+	} else {
+		// Unset the vPointer
+		delete_method->add_code("unset \"${__this}____vPointer\"\n");
+	}
 
 	delete_method->flush_code_buffers();
 	return delete_method;
@@ -550,6 +986,58 @@ std::string get_encased_ref(const std::string& ref, uint8_t indirection_level) {
 	return encased;
 }
 
+/**
+ * @brief Get the name of the shell variable which holds an object's data member
+ *
+ * In the default layout, every data member is its own variable, named '<address>__<member>'.
+ * In the associative array layout, the object is a single associative array named after its address,
+ * and the data member is the element '<address>[<member>]'.
+ * Array data members can't be elements of an associative array,
+ * so callers should only ask for the associative layout for data members which aren't arrays.
+ *
+ * Either way, the result can be expanded indirectly (${!var}), assigned to with eval or printf -v, and unset.
+ *
+ * @param address The object's address (may itself be an expansion, e.g. '${__this}')
+ * @param member_name The name of the data member
+ * @param associative Whether the object uses the associative array layout
+ */
+std::string get_member_variable(const std::string& address, const std::string& member_name, bool associative) {
+	if (associative) return address + "[" + member_name + "]";
+	return address + "__" + member_name;
+}
+
+/**
+ * @brief Get the name of the shell variable which holds an object's vPointer
+ *
+ * The vPointer is stored under the key '__vPointer' in the associative array layout.
+ * Since Bash++ identifiers can't contain double underscores, it can never clash with a data member.
+ */
+std::string get_vpointer_variable(const std::string& address, bool associative) {
+	if (associative) return address + "[__vPointer]";
+	return address + "____vPointer";
+}
+
+/**
+ * @brief Generate a condition (for use inside [[ ... ]]) which is true if the given variable holds something we can follow as a pointer
+ *
+ * Indirect expansion of anything which isn't a valid variable name is a fatal expansion error,
+ * so the runtime checks every pointer before following it.
+ *
+ * In the default layout, a pointer is always a valid identifier.
+ * In the associative array layout, a pointer may also be the name of an element of an object's array (e.g. 'bpp__Class__obj[member]'),
+ * so a valid identifier followed by a non-empty [key] of identifier characters is also accepted.
+ *
+ * @param variable The name of the variable to check (not an expansion)
+ * @param associative Whether the program uses the associative array layout
+ */
+std::string generate_reference_check(const std::string& variable, bool associative) {
+	if (!associative) {
+		return "\"${" + variable + "}\" == [A-Za-z_]* && \"${" + variable + "}\" != *[!A-Za-z0-9_]*";
+	}
+	return "\"${" + variable + "}\" == [A-Za-z_]* && \"${" + variable + "%%\\[*}\" != *[!A-Za-z0-9_]*"
+		" && ( \"${" + variable + "}\" != *\\[* || ( \"${" + variable + "#*\\[}\" == ?*\\] && \"${" + variable + "#*\\[}\" != *[!A-Za-z0-9_]*\\] ) )";
+}
+
 
 /**
  * @brief Resolves a reference to an entity in a particular context.
@@ -607,6 +1095,8 @@ entity_reference resolve_reference_impl(
 	entity_reference result;
 
 	std::shared_ptr<bpp::bpp_class> current_class = context->get_containing_class().lock();
+	// Temporaries which start from '__this' only mean the same thing within one class
+	const std::string const_member_class = (self_reference && current_class != nullptr) ? current_class->get_name() : "";
 
 	result.entity = context;
 	if (self_reference) {
@@ -757,17 +1247,41 @@ entity_reference resolve_reference_impl(
 					: bpp::reference_type::ref_object;
 			result.entity = datamember;
 
+			// In the associative array layout, the reference so far may be an element of an object's array (e.g. 'bpp__Class__obj[member]')
+			// Temporary variables still need valid names which can't clash with any object's array
+			const bool associative = program->get_associative_objects() && !datamember->is_array();
 			std::string temporary_variable_lvalue = result.reference_code.code + "__" + ids.front();
-			std::string temporary_variable_rvalue = get_encased_ref(result.reference_code.code, indirection_level) + "__" + ids.front();
+			if (program->get_associative_objects()) {
+				temporary_variable_lvalue = replace_all(replace_all(result.reference_code.code, "[", "____"), "]", "") + "__" + ids.front();
+			}
+			std::string temporary_variable_rvalue = get_member_variable(get_encased_ref(result.reference_code.code, indirection_level), ids.front(), associative);
 
 			if (result.created_first_temporary_variable) {
 				result.reference_code.pre_code += 
 					temporary_variable_declaration_prefix + temporary_variable_lvalue + "=" + temporary_variable_rvalue + "\n";
 				result.reference_code.post_code += "unset " + temporary_variable_lvalue + "\n";
+				program->add_temporary(temporary_variable_lvalue);
+				result.created_second_temporary_variable = true;
+				result.reference_code.code = temporary_variable_lvalue;
+			} else if (associative && datamember->get_class() != nullptr) {
+				// Objects and pointers are handed to the runtime by name
+				// Rather than pass an array element as a bare word (which would be subject to pathname expansion),
+				// Refer to it through a temporary variable holding its name
+				result.reference_code.pre_code +=
+					temporary_variable_declaration_prefix + temporary_variable_lvalue + "=" + temporary_variable_rvalue + "\n";
+				result.reference_code.post_code += "unset " + temporary_variable_lvalue + "\n";
+				program->add_temporary(temporary_variable_lvalue);
 				result.created_second_temporary_variable = true;
+				result.reference_code.code = temporary_variable_lvalue;
+			} else {
+				result.reference_code.code = temporary_variable_rvalue;
+			}
+
+			// Let the loop optimizer know that this member can't change (see bpp::ir::hoist_loop_invariants)
+			if (datamember->is_const() && !program->get_associative_objects()) {
+				program->add_const_member(const_member_class, result.reference_code.code, result.created_first_temporary_variable);
 			}
 
-			result.reference_code.code = temporary_variable_lvalue;
 			result.created_first_temporary_variable = true;
 
 			if (!nds.empty()) {
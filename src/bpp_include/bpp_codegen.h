@@ -64,7 +64,8 @@ code_segment generate_delete_code(
 
 code_segment generate_constructor_call_code(
 	const std::string&					reference_code,
-	std::shared_ptr<bpp_class>			assumed_class
+	std::shared_ptr<bpp_class>			assumed_class,
+	std::shared_ptr<bpp::bpp_program>	program
 	);
 
 code_segment generate_destructor_call_code(
@@ -82,6 +83,13 @@ code_segment generate_method_call_code(
 	std::shared_ptr<bpp::bpp_program>	program
 	);
 
+std::optional<code_segment> generate_inline_method_call_code(
+	const std::string&					reference_code,
+	std::shared_ptr<bpp::bpp_method>	method,
+	std::shared_ptr<bpp_class>			assumed_class,
+	std::shared_ptr<bpp::bpp_program>	program
+	);
+
 code_segment generate_dynamic_cast_code(
 	const std::string&					reference_code,
 	const std::string&					class_name,
@@ -93,6 +101,11 @@ code_segment generate_typeof_code(
 	std::shared_ptr<bpp::bpp_program>	program
 	);
 
+code_segment generate_null_check_code(
+	const std::string&					reference_code,
+	std::shared_ptr<bpp::bpp_program>	program
+	);
+
 code_segment generate_new_code(
 	const std::string&					new_address,
 	std::shared_ptr<bpp_class>			new_class,
@@ -122,6 +135,11 @@ std::shared_ptr<bpp::bpp_method> generate_delete_method(
 
 std::string get_encased_ref(const std::string& ref, uint8_t indirection_level);
 
+// Object layout
+std::string get_member_variable(const std::string& address, const std::string& member_name, bool associative);
+std::string get_vpointer_variable(const std::string& address, bool associative);
+std::string generate_reference_check(const std::string& variable, bool associative);
+
 
 // Entity reference resolution
 
@@ -20,6 +20,10 @@ void bpp_datamember::set_array(bool is_array) {
 	array = is_array;
 }
 
+void bpp_datamember::set_const(bool is_const) {
+	constant = is_const;
+}
+
 std::string bpp_datamember::get_address() const {
 	return "${__this}__" + name;
 }
@@ -36,4 +40,8 @@ bool bpp_datamember::is_array() const {
 	return array;
 }
 
+bool bpp_datamember::is_const() const {
+	return constant;
+}
+
 } // namespace bpp
@@ -23,15 +23,18 @@ class bpp_datamember : public bpp_object {
 		std::string default_value;
 		bpp_scope scope = bpp_scope::SCOPE_PRIVATE;
 		bool array = false;
+		bool constant = false; // Whether the member was marked @const (only assigned by its class's constructor)
 	public:
 		void set_default_value(const std::string& default_value);
 		void set_scope(bpp_scope scope);
 		void set_array(bool is_array);
+		void set_const(bool is_const);
 
 		std::string get_address() const override;
 		std::string get_default_value() const;
 		bpp_scope get_scope() const;
 		bool is_array() const;
+		bool is_const() const;
 };
 
 
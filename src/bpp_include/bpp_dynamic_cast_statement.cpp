@@ -8,6 +8,22 @@
 
 namespace bpp {
 
+void bpp_type_inspection::set_operand(std::shared_ptr<bpp_class> operand_class, const std::string& operand_code, bool exact_type) {
+	this->operand_class = std::move(operand_class);
+	this->operand_code = operand_code;
+	this->exact_operand_type = exact_type;
+}
+
+std::shared_ptr<bpp_class> bpp_type_inspection::get_operand_class() const {
+	// The recorded class only describes the operand if the reference it came from was the entire operand
+	if (operand_class == nullptr || get_code() != operand_code) return nullptr;
+	return operand_class;
+}
+
+bool bpp_type_inspection::operand_type_is_exact() const {
+	return exact_operand_type;
+}
+
 void bpp_dynamic_cast_statement::set_cast_to(const std::string& cast_to) {
 	this->cast_to = cast_to;
 }
@@ -16,4 +32,12 @@ std::string bpp_dynamic_cast_statement::get_cast_to() const {
 	return cast_to;
 }
 
+void bpp_dynamic_cast_statement::set_cast_to_class(std::shared_ptr<bpp_class> cast_to_class) {
+	this->cast_to_class = std::move(cast_to_class);
+}
+
+std::shared_ptr<bpp_class> bpp_dynamic_cast_statement::get_cast_to_class() const {
+	return cast_to_class;
+}
+
 } // namespace bpp
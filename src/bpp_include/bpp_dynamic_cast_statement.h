@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "bpp.h"
@@ -13,6 +14,39 @@
 
 namespace bpp {
 
+/**
+ * @class bpp_type_inspection
+ *
+ * @brief A statement which inspects the runtime type of an object (i.e., a dynamic_cast or typeof)
+ *
+ * If the operand is a single reference to an object whose class is known at compile time,
+ * the object reference records that class here, so that the statement can be resolved
+ * (entirely or partially) at compile time instead of with a call into the runtime.
+ *
+ * If the operand is a non-pointer object, its class is exactly the recorded class.
+ * If it's a pointer, it points to an object of the recorded class or of some class derived from it (or to nothing at all).
+ */
+class bpp_type_inspection : public bpp_string {
+	private:
+		std::shared_ptr<bpp_class> operand_class;
+		std::string operand_code;
+		bool exact_operand_type = false;
+	public:
+		void set_operand(std::shared_ptr<bpp_class> operand_class, const std::string& operand_code, bool exact_type);
+
+		/**
+		 * @brief Get the class of the operand, if it's known at compile time
+		 *
+		 * @return std::shared_ptr<bpp_class> The class, or nullptr if the operand is anything other than a single reference to an object
+		 */
+		std::shared_ptr<bpp_class> get_operand_class() const;
+
+		/**
+		 * @brief Whether the operand's class is known exactly (i.e., the operand isn't a pointer)
+		 */
+		bool operand_type_is_exact() const;
+};
+
 /**
  * @class bpp_dynamic_cast_statement
  * 
@@ -24,14 +58,26 @@ namespace bpp {
  * 
  * The 'bpp_' prefix signifies that this is used to parse a statement type which is unique to Bash++
  */
-class bpp_dynamic_cast_statement : public bpp_string {
+class bpp_dynamic_cast_statement : public bpp_type_inspection {
 	private:
 		std::string cast_to;
+		std::shared_ptr<bpp_class> cast_to_class; // Only set if the target is a class name known at compile time
 	public:
 		void set_cast_to(const std::string& cast_to);
 		std::string get_cast_to() const;
+
+		void set_cast_to_class(std::shared_ptr<bpp_class> cast_to_class);
+		std::shared_ptr<bpp_class> get_cast_to_class() const;
 };
 
+/**
+ * @class bpp_typeof_expression
+ * @brief A typeof expression in Bash++
+ *
+ * This entity gets pushed onto the entity stack when we encounter a `@typeof` expression in Bash++ code.
+ */
+class bpp_typeof_expression : public bpp_type_inspection {};
+
 /**
  * @class bpp_dynamic_cast_target
  * @brief The target of a dynamic_cast in Bash++
@@ -63,7 +63,8 @@ bool bpp_entity::set_containing_class(std::weak_ptr<bpp::bpp_class> containing_c
 
 void bpp_entity::set_definition_position(const std::string& file, uint64_t line, uint64_t column) {
 	initial_definition = bpp::SymbolPosition(file, line, column);
-	references.emplace_front(file, line, column); // Set the definition as the entity's first reference
+	// Set the definition as the entity's first reference
+	references.emplace(references.begin(), intern_file_path(file), static_cast<uint32_t>(line), static_cast<uint32_t>(column));
 }
 
 bpp::SymbolPosition bpp_entity::get_initial_definition() const {
@@ -71,7 +72,7 @@ bpp::SymbolPosition bpp_entity::get_initial_definition() const {
 }
 
 void bpp_entity::add_reference(const std::string& file, uint64_t line, uint64_t column) {
-	references.emplace_back(file, line, column);
+	references.emplace_back(intern_file_path(file), static_cast<uint32_t>(line), static_cast<uint32_t>(column));
 	// If this is a derived class's version of an overridden method, add the reference to the overridden method as well
 	// This is useful in the language server for "find all references" functionality,
 	// And, for example, for "rename symbol" -- renaming the original method should rename all overridden versions as well
@@ -81,10 +82,14 @@ void bpp_entity::add_reference(const std::string& file, uint64_t line, uint64_t
 	}
 }
 
-std::list<bpp::SymbolPosition> bpp_entity::get_references() const {
+const std::vector<bpp::ReferencePosition>& bpp_entity::get_references() const {
 	return references;
 }
 
+size_t bpp_entity::number_of_references() const {
+	return references.size();
+}
+
 /**
  * @brief Inherit from a parent entity
  *
@@ -9,7 +9,6 @@
 #include <string>
 #include <memory>
 #include <vector>
-#include <list>
 
 #include "bpp.h"
 
@@ -42,7 +41,7 @@ class bpp_entity {
 		
 		std::weak_ptr<bpp_method> overridden_method;
 		bpp::SymbolPosition initial_definition;
-		std::list<bpp::SymbolPosition> references;
+		std::vector<bpp::ReferencePosition> references; // The definition first, then every reference in the order they were found
 	public:
 		bpp_entity() = default;
 		virtual ~bpp_entity() = default;
@@ -70,7 +69,8 @@ class bpp_entity {
 		void add_reference(const std::string& file, uint64_t line, uint64_t column);
 
 		bpp::SymbolPosition get_initial_definition() const;
-		std::list<bpp::SymbolPosition> get_references() const;
+		const std::vector<bpp::ReferencePosition>& get_references() const;
+		size_t number_of_references() const;
 
 		virtual std::shared_ptr<bpp_class> get_class(const std::string& name, size_t max_visible_index = SIZE_MAX);
 		std::shared_ptr<bpp_object> get_object(const std::string& name, size_t max_visible_index = SIZE_MAX);
@@ -0,0 +1,1089 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "bpp_ir.h"
+
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace bpp::ir {
+
+static inline bool _is_identifier_character(char c) {
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static bool _is_identifier(std::string_view text) {
+	if (text.empty() || (text.front() >= '0' && text.front() <= '9')) return false;
+	return std::all_of(text.begin(), text.end(), _is_identifier_character);
+}
+
+/**
+ * @brief Whether a variable is one of the temporaries which the compiler created
+ *
+ * The passes only ever remove or merge commands which deal with these.
+ * The name alone doesn't tell: a program may use its own shell variables with double underscores in their names.
+ */
+static inline bool _is_temporary(const std::unordered_set<std::string>* temporaries, std::string_view name) {
+	return temporaries != nullptr && temporaries->contains(std::string(name));
+}
+
+/**
+ * @brief Whether a value refers to the given variable by name
+ */
+static bool _mentions(std::string_view value, std::string_view name) {
+	for (size_t position = value.find(name); position != std::string_view::npos; position = value.find(name, position + 1)) {
+		const bool starts_identifier = position == 0 || !_is_identifier_character(value[position - 1]);
+		const bool ends_identifier = position + name.size() >= value.size() || !_is_identifier_character(value[position + name.size()]);
+		if (starts_identifier && ends_identifier) return true;
+	}
+	return false;
+}
+
+/**
+ * @brief Whether a value reads a variable whose name is only known at runtime (e.g. ${!pointer})
+ *
+ * Such a value may depend on any variable at all.
+ */
+static inline bool _reads_indirectly(std::string_view value) {
+	return value.find("${!") != std::string_view::npos;
+}
+
+/**
+ * @brief Whether expanding a value twice in a row is sure to give the same result
+ *
+ * Rules out parameter expansions which assign (${x:=y}) or evaluate prompt strings (${x@P}),
+ * and the special variables whose values change by themselves.
+ */
+static bool _is_pure(std::string_view value) {
+	if (value.find_first_of("=@") != std::string_view::npos) return false;
+	constexpr std::array<std::string_view, 5> volatile_variables = {"RANDOM", "SECONDS", "EPOCH", "LINENO", "BASHPID"};
+	return std::none_of(volatile_variables.begin(), volatile_variables.end(), [&](std::string_view variable) {
+		return value.find(variable) != std::string_view::npos;
+	});
+}
+
+/**
+ * @brief Whether a value can be recognized without a full shell parser
+ *
+ * Only single words with no quoting (other than balanced double quotes), no command substitutions and no operators qualify.
+ */
+static bool _is_simple_value(std::string_view value) {
+	if (value.find_first_of(" \t;&|<>()`'\\") != std::string_view::npos) return false;
+	return std::count(value.begin(), value.end(), '"') % 2 == 0;
+}
+
+/**
+ * @brief Whether a logical line is continued on the next physical line by a trailing pipe, '&&' or '||'
+ */
+static bool _continues(std::string_view line) {
+	size_t last = line.find_last_not_of(" \t");
+	if (last == std::string_view::npos) return false;
+	line = line.substr(0, last + 1);
+	return line.ends_with('|') || line.ends_with("&&");
+}
+
+enum class _scanner_context : uint8_t {
+	double_quotes,
+	parentheses,
+	braces
+};
+
+struct _heredoc {
+	std::string delimiter;
+	bool strip_tabs = false;
+};
+
+/**
+ * @brief Split compiled code into logical lines
+ *
+ * A logical line ends at a newline which isn't escaped, isn't inside of quotes, a command substitution,
+ * a parameter expansion or parentheses, and doesn't follow a pipe, '&&' or '||'.
+ * Here-documents are kept together with the line which opens them.
+ *
+ * Whenever the scanner can't make sense of something, everything from there on is returned as a single logical line,
+ * which build() will treat as opaque. A mistake can only ever cost an optimization, never change the meaning of the code.
+ */
+static std::vector<std::string_view> _split_logical_lines(std::string_view code, bool* trailing_newline) {
+	std::vector<std::string_view> lines;
+	std::vector<_scanner_context> stack;
+	std::vector<_heredoc> pending_heredocs;
+
+	size_t line_start = 0;
+	bool at_word_start = true;
+
+	auto give_up = [&]() {
+		lines.push_back(code.substr(line_start));
+		*trailing_newline = false;
+		return lines;
+	};
+
+	auto skip_backquotes = [&](size_t* position) {
+		for (size_t j = *position + 1; j < code.size(); j++) {
+			if (code[j] == '\\') {
+				j++;
+			} else if (code[j] == '`') {
+				*position = j;
+				return true;
+			}
+		}
+		return false;
+	};
+
+	size_t i = 0;
+	while (i < code.size()) {
+		const char c = code[i];
+		const char next = i + 1 < code.size() ? code[i + 1] : '\0';
+
+		if (c == '\\') {
+			i += 2;
+			at_word_start = false;
+			continue;
+		}
+
+		if (c == '\n') {
+			if (!stack.empty() || _continues(code.substr(line_start, i - line_start))) {
+				i++;
+				at_word_start = true;
+				continue;
+			}
+
+			// The logical line ends here, unless it opened here-documents, whose bodies follow
+			size_t end = i;
+			for (const auto& heredoc : pending_heredocs) {
+				bool found = false;
+				while (!found && end + 1 < code.size()) {
+					size_t next_start = end + 1;
+					size_t next_end = code.find('\n', next_start);
+					if (next_end == std::string_view::npos) next_end = code.size();
+					std::string_view body_line = code.substr(next_start, next_end - next_start);
+					if (heredoc.strip_tabs) {
+						body_line.remove_prefix(std::min(body_line.find_first_not_of('\t'), body_line.size()));
+					}
+					end = next_end;
+					found = body_line == heredoc.delimiter;
+				}
+				if (!found) return give_up();
+			}
+			pending_heredocs.clear();
+
+			lines.push_back(code.substr(line_start, end - line_start));
+			line_start = end + 1;
+			i = end + 1;
+			at_word_start = true;
+			continue;
+		}
+
+		if (!stack.empty() && stack.back() == _scanner_context::double_quotes) {
+			if (c == '"') {
+				stack.pop_back();
+			} else if (c == '$' && next == '(') {
+				stack.push_back(_scanner_context::parentheses);
+				i++;
+			} else if (c == '$' && next == '{') {
+				stack.push_back(_scanner_context::braces);
+				i++;
+			} else if (c == '`' && !skip_backquotes(&i)) {
+				return give_up();
+			}
+			i++;
+			continue;
+		}
+
+		switch (c) {
+			case '\'':
+			{
+				// $'...' strings may contain escaped single quotes
+				const bool ansi_c_quoted = i > 0 && code[i - 1] == '$';
+				size_t closing_quote = i + 1;
+				while (closing_quote < code.size() && code[closing_quote] != '\'') {
+					closing_quote += (ansi_c_quoted && code[closing_quote] == '\\') ? 2 : 1;
+				}
+				if (closing_quote >= code.size()) return give_up();
+				i = closing_quote;
+				break;
+			}
+			case '"':
+				stack.push_back(_scanner_context::double_quotes);
+				break;
+			case '`':
+				if (!skip_backquotes(&i)) return give_up();
+				break;
+			case '(':
+				stack.push_back(_scanner_context::parentheses);
+				break;
+			case ')':
+				// Unmatched closing parentheses (e.g. in case patterns) are ignored
+				if (!stack.empty() && stack.back() == _scanner_context::parentheses) stack.pop_back();
+				break;
+			case '{':
+				if (i > 0 && code[i - 1] == '$') stack.push_back(_scanner_context::braces);
+				break;
+			case '}':
+				if (!stack.empty() && stack.back() == _scanner_context::braces) stack.pop_back();
+				break;
+			case '#':
+				if (at_word_start) {
+					// A comment runs until the end of the physical line
+					i = code.find('\n', i);
+					if (i == std::string_view::npos) i = code.size();
+					continue;
+				}
+				break;
+			case '<':
+				if (next == '<' && i + 2 < code.size() && code[i + 2] == '<') {
+					i += 2; // Here-string
+				} else if (next == '<') {
+					_heredoc heredoc;
+					size_t j = i + 2;
+					if (j < code.size() && code[j] == '-') {
+						heredoc.strip_tabs = true;
+						j++;
+					}
+					while (j < code.size() && (code[j] == ' ' || code[j] == '\t')) j++;
+					while (j < code.size() && std::string_view(" \t\n;&|<>()").find(code[j]) == std::string_view::npos) {
+						if (code[j] != '\'' && code[j] != '"' && code[j] != '\\') heredoc.delimiter += code[j];
+						j++;
+					}
+					if (heredoc.delimiter.empty()) return give_up();
+					pending_heredocs.push_back(std::move(heredoc));
+					i = j - 1;
+				}
+				break;
+			default:
+				break;
+		}
+
+		at_word_start = (c == ' ' || c == '\t' || c == ';' || c == '&' || c == '|' || c == '(');
+		i++;
+	}
+
+	if (line_start < code.size()) {
+		lines.push_back(code.substr(line_start));
+		*trailing_newline = false;
+	} else {
+		*trailing_newline = line_start == code.size() && !code.empty();
+	}
+	return lines;
+}
+
+static std::vector<std::string_view> _split_words(std::string_view text) {
+	std::vector<std::string_view> words;
+	size_t position = 0;
+	while (position < text.size()) {
+		size_t word_start = text.find_first_not_of(" \t", position);
+		if (word_start == std::string_view::npos) break;
+		size_t word_end = text.find_first_of(" \t", word_start);
+		if (word_end == std::string_view::npos) word_end = text.size();
+		words.push_back(text.substr(word_start, word_end - word_start));
+		position = word_end;
+	}
+	return words;
+}
+
+static instruction _classify(std::string_view line) {
+	instruction result;
+	result.text = line;
+
+	if (line.find('\n') != std::string_view::npos) return result;
+
+	size_t first = line.find_first_not_of(" \t");
+	if (first == std::string_view::npos || line[first] == '#') {
+		result.type = instruction_type::comment;
+		return result;
+	}
+	result.indentation = line.substr(0, first);
+
+	std::vector<std::string_view> words = _split_words(line.substr(first));
+	const std::string_view command = words.front();
+
+	if (command == "unset") {
+		size_t first_name = (words.size() > 1 && words[1] == "-v") ? 2 : 1;
+		if (first_name < words.size() && std::all_of(words.begin() + static_cast<std::ptrdiff_t>(first_name), words.end(), _is_identifier)) {
+			result.type = instruction_type::unset;
+			for (size_t i = first_name; i < words.size(); i++) result.names.emplace_back(words[i]);
+		}
+		return result;
+	}
+
+	size_t first_assignment = 0;
+	if (command == "local" && words.size() > 1) {
+		result.local = true;
+		first_assignment = 1;
+	}
+	bool all_assignments = true;
+	for (size_t i = first_assignment; i < words.size() && all_assignments; i++) {
+		size_t equals = words[i].find('=');
+		all_assignments = equals != std::string_view::npos
+			&& _is_identifier(words[i].substr(0, equals))
+			&& _is_simple_value(words[i].substr(equals + 1));
+		if (all_assignments) {
+			result.assignments.push_back({std::string(words[i].substr(0, equals)), std::string(words[i].substr(equals + 1))});
+		}
+	}
+	if (all_assignments) {
+		result.type = instruction_type::assignment;
+		return result;
+	}
+	result.local = false;
+	result.assignments.clear();
+
+	constexpr std::array<std::string_view, 20> control_flow_keywords = {
+		"if", "then", "else", "elif", "fi",
+		"while", "until", "for", "select", "do", "done",
+		"case", "esac", ";;", "function",
+		"{", "}", "(", ")", "!"
+	};
+	const std::string_view last_word = words.back();
+	if (std::find(control_flow_keywords.begin(), control_flow_keywords.end(), command) != control_flow_keywords.end()
+		|| last_word == "{" || last_word.ends_with("()")) {
+		result.type = instruction_type::control_flow;
+	} else if (command.starts_with("bpp____supershell")) {
+		result.type = instruction_type::capture;
+	} else if (command.starts_with("bpp__")) {
+		result.type = instruction_type::call;
+	}
+	return result;
+}
+
+/**
+ * @brief Recover the instructions of a piece of compiled code
+ */
+block build(std::string_view code, const std::unordered_set<std::string>& temporaries) {
+	block result;
+	result.temporaries = &temporaries;
+	for (std::string_view line : _split_logical_lines(code, &result.trailing_newline)) {
+		result.instructions.push_back(_classify(line));
+	}
+	return result;
+}
+
+static std::string _lower_instruction(const instruction& instruction) {
+	if (!instruction.modified) return instruction.text;
+
+	std::string line = instruction.indentation;
+	if (instruction.type == instruction_type::unset) {
+		line += "unset";
+		for (const auto& name : instruction.names) line += " " + name;
+	} else if (instruction.type == instruction_type::assignment) {
+		if (instruction.local) line += "local ";
+		for (size_t i = 0; i < instruction.assignments.size(); i++) {
+			if (i > 0) line += " ";
+			line += instruction.assignments[i].name + "=" + instruction.assignments[i].value;
+		}
+	}
+	return line;
+}
+
+/**
+ * @brief Turn a block back into Bash code
+ */
+std::string lower(const block& instructions) {
+	std::string code;
+	for (size_t i = 0; i < instructions.instructions.size(); i++) {
+		if (i > 0) code += "\n";
+		code += _lower_instruction(instructions.instructions[i]);
+	}
+	if (instructions.trailing_newline) code += "\n";
+	return code;
+}
+
+/**
+ * @brief Whether the passes have to assume that an instruction may read or write any variable
+ *
+ * Assignments of several variables at once are included,
+ * since 'local a=1 b=$a' expands every value before assigning any of them.
+ */
+static inline bool _is_barrier(const instruction& instruction) {
+	switch (instruction.type) {
+		case instruction_type::assignment:
+			return instruction.assignments.size() != 1;
+		case instruction_type::unset:
+		case instruction_type::comment:
+			return false;
+		default:
+			return true;
+	}
+}
+
+/**
+ * @brief Remove assignments which give a variable the value it's already known to hold
+ *
+ * Several references to the same object in one statement (e.g. "@a.b.x @a.b.y") each resolve their shared prefix
+ * into the same temporary variable. Only the first of those assignments is needed.
+ */
+void eliminate_common_reference_chains(block* instructions, pass_statistics* statistics) {
+	struct available_value {
+		std::string value;
+		bool local = false;
+	};
+	std::unordered_map<std::string, available_value> available;
+
+	auto invalidate = [&](const std::string& name) {
+		std::erase_if(available, [&](const auto& entry) {
+			return entry.first == name || _mentions(entry.second.value, name) || _reads_indirectly(entry.second.value);
+		});
+	};
+
+	std::vector<instruction> result;
+	result.reserve(instructions->instructions.size());
+	for (auto& instruction : instructions->instructions) {
+		if (_is_barrier(instruction)) {
+			available.clear();
+		} else if (instruction.type == instruction_type::unset) {
+			for (const auto& name : instruction.names) invalidate(name);
+		} else if (instruction.type == instruction_type::assignment) {
+			const auto& [name, value] = instruction.assignments.front();
+			auto known_value = available.find(name);
+			if (known_value != available.end()
+				&& known_value->second.value == value
+				&& (known_value->second.local || !instruction.local)
+				&& _is_temporary(instructions->temporaries, name)
+			) {
+				statistics->removed_assignments++;
+				continue;
+			}
+			invalidate(name);
+			if (_is_pure(value) && !_mentions(value, name)) {
+				available[name] = {value, instruction.local};
+			}
+		}
+		result.push_back(std::move(instruction));
+	}
+	instructions->instructions = std::move(result);
+}
+
+/**
+ * @brief How much a control flow instruction changes the nesting depth (+1 for 'if', -1 for 'fi', etc)
+ */
+static int _nesting_change(const instruction& instruction) {
+	if (instruction.type != instruction_type::control_flow) return 0;
+	constexpr std::array<std::string_view, 7> openers = {"if", "while", "until", "for", "select", "case", "{"};
+	constexpr std::array<std::string_view, 4> closers = {"fi", "done", "esac", "}"};
+	int change = 0;
+	for (std::string_view word : _split_words(instruction.text)) {
+		while (word.ends_with(';')) word.remove_suffix(1);
+		if (std::find(openers.begin(), openers.end(), word) != openers.end()) change++;
+		if (std::find(closers.begin(), closers.end(), word) != closers.end()) change--;
+	}
+	return change;
+}
+
+/**
+ * @brief Whether a control flow instruction begins a function definition (e.g. 'function name() {' or 'name()')
+ */
+static bool _is_function_header(const instruction& instruction) {
+	if (instruction.type != instruction_type::control_flow) return false;
+	std::vector<std::string_view> words = _split_words(instruction.text);
+	return words.front() == "function" || std::any_of(words.begin(), words.end(), [](std::string_view word) {
+		return word.ends_with("()");
+	});
+}
+
+/**
+ * @brief Whether a variable unset by the instruction at the given index is bound to be assigned again before anything reads it
+ *
+ * Re-declaring a variable with 'local' only has the same effect as assigning it if the variable is already local to the function.
+ */
+static bool _is_dead_unset(
+	const std::vector<instruction>& instructions,
+	size_t index,
+	const std::string& name,
+	const std::unordered_set<std::string>& declared_locals
+) {
+	for (size_t i = index + 1; i < instructions.size(); i++) {
+		const instruction& next = instructions[i];
+		if (next.type == instruction_type::comment) continue;
+
+		if (next.type == instruction_type::unset) {
+			if (std::find(next.names.begin(), next.names.end(), name) != next.names.end()) return true;
+			continue;
+		}
+
+		if (next.type != instruction_type::assignment) return false;
+
+		// Bash assigns from left to right, so anything which reads the variable before it's assigned again keeps the unset alive
+		// ('local' expands all of its arguments before it assigns any of them)
+		if (next.local && std::any_of(next.assignments.begin(), next.assignments.end(), [&](const auto& assignment) {
+			return _mentions(assignment.value, name) || _reads_indirectly(assignment.value);
+		})) {
+			return false;
+		}
+		for (const auto& [assigned_name, value] : next.assignments) {
+			if (_mentions(value, name) || _reads_indirectly(value)) return false;
+			if (assigned_name == name) return !next.local || declared_locals.contains(name);
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Remove unsets of variables which are about to be assigned (or unset) again anyway
+ *
+ * The temporaries of one statement are unset right after it,
+ * and the next statement referring to the same object assigns the very same temporaries again.
+ *
+ * Which variables have been declared 'local' is tracked separately for each function body,
+ * since a variable which is local to one function isn't local to any other.
+ */
+void remove_dead_unsets(block* instructions, pass_statistics* statistics) {
+	struct function_scope {
+		int depth = 0; // The nesting depth just outside of the function's body
+		std::unordered_set<std::string> declared_locals;
+	};
+	std::vector<function_scope> scopes(1);
+	int depth = 0;
+	bool function_body_follows = false; // Whether we've seen a function's header, but not yet the start of its body
+	auto& list = instructions->instructions;
+
+	for (size_t i = 0; i < list.size(); i++) {
+		instruction& current = list[i];
+		if (current.type == instruction_type::control_flow) {
+			const int change = _nesting_change(current);
+			const bool function_header = _is_function_header(current);
+			if (change > 0 && (function_header || function_body_follows)) {
+				scopes.push_back({depth, {}});
+			}
+			// A header alone on its line (e.g. 'name()') has its body on the lines which follow
+			function_body_follows = change == 0 && function_header && _split_words(current.text).back() != "}";
+			depth += change;
+			while (scopes.size() > 1 && depth <= scopes.back().depth) scopes.pop_back();
+		}
+		std::unordered_set<std::string>& declared_locals = scopes.back().declared_locals;
+		if (current.type == instruction_type::assignment && current.local) {
+			for (const auto& assignment : current.assignments) declared_locals.insert(assignment.name);
+		}
+		if (current.type != instruction_type::unset) continue;
+
+		std::vector<std::string> kept_names;
+		for (const auto& name : current.names) {
+			const bool duplicate = std::find(kept_names.begin(), kept_names.end(), name) != kept_names.end();
+			if (_is_temporary(instructions->temporaries, name) && (duplicate || _is_dead_unset(list, i, name, declared_locals))) {
+				statistics->removed_unsets++;
+				continue;
+			}
+			kept_names.push_back(name);
+		}
+		if (kept_names.size() != current.names.size()) {
+			current.names = std::move(kept_names);
+			current.modified = true;
+		}
+	}
+
+	std::erase_if(list, [](const instruction& instruction) {
+		return instruction.type == instruction_type::unset && instruction.names.empty();
+	});
+}
+
+static bool _can_merge_assignments(const std::unordered_set<std::string>* temporaries, const instruction& group, const instruction& next) {
+	if (group.local != next.local) return false;
+	for (const auto& assignment : next.assignments) {
+		if (!_is_temporary(temporaries, assignment.name) || _reads_indirectly(assignment.value)) return false;
+		for (const auto& earlier : group.assignments) {
+			if (earlier.name == assignment.name || _mentions(assignment.value, earlier.name)) return false;
+		}
+	}
+	return std::all_of(group.assignments.begin(), group.assignments.end(), [&](const auto& assignment) {
+		return _is_temporary(temporaries, assignment.name) && !_reads_indirectly(assignment.value);
+	});
+}
+
+/**
+ * @brief Merge runs of unsets, and of independent assignments of temporaries, into single commands
+ *
+ * Bash spends more time setting up each simple command than it does on any one of these assignments or unsets.
+ */
+void coalesce_temporaries(block* instructions, pass_statistics* statistics) {
+	std::vector<instruction> result;
+	result.reserve(instructions->instructions.size());
+	auto is_temporary = [&](const std::string& name) { return _is_temporary(instructions->temporaries, name); };
+
+	for (auto& instruction : instructions->instructions) {
+		if (!result.empty()) {
+			auto& previous = result.back();
+			if (previous.type == instruction_type::unset && instruction.type == instruction_type::unset
+				&& std::all_of(previous.names.begin(), previous.names.end(), is_temporary)
+				&& std::all_of(instruction.names.begin(), instruction.names.end(), is_temporary)
+			) {
+				for (const auto& name : instruction.names) {
+					if (std::find(previous.names.begin(), previous.names.end(), name) != previous.names.end()) {
+						statistics->removed_unsets++;
+					} else {
+						previous.names.push_back(name);
+					}
+				}
+				previous.modified = true;
+				statistics->merged_commands++;
+				continue;
+			}
+			if (previous.type == instruction_type::assignment && instruction.type == instruction_type::assignment
+				&& _can_merge_assignments(instructions->temporaries, previous, instruction)
+			) {
+				previous.assignments.insert(previous.assignments.end(), instruction.assignments.begin(), instruction.assignments.end());
+				previous.modified = true;
+				statistics->merged_commands++;
+				continue;
+			}
+		}
+		result.push_back(std::move(instruction));
+	}
+	instructions->instructions = std::move(result);
+}
+
+void pass_manager::add_pass(const std::string& name, pass function) {
+	passes.emplace_back(name, function);
+}
+
+const std::vector<std::pair<std::string, pass_manager::pass>>& pass_manager::get_passes() const {
+	return passes;
+}
+
+void pass_manager::run(block* instructions, pass_statistics* statistics) const {
+	pass_statistics discarded_statistics;
+	if (statistics == nullptr) statistics = &discarded_statistics;
+	for (const auto& [name, function] : passes) {
+		function(instructions, statistics);
+	}
+}
+
+pass_manager pass_manager::for_level(uint8_t optimization_level) {
+	pass_manager manager;
+	if (optimization_level >= 1) {
+		manager.add_pass("common-reference-chains", eliminate_common_reference_chains);
+		manager.add_pass("dead-unsets", remove_dead_unsets);
+		manager.add_pass("coalesce-temporaries", coalesce_temporaries);
+	}
+	return manager;
+}
+
+/**
+ * @brief Split a command line into the simple commands it's made of
+ *
+ * Splits at ';', '&', '|' and newlines, except inside of quotes, parentheses (command substitutions, subshells and arithmetic)
+ * and [[ ... ]] tests.
+ */
+static std::vector<std::string_view> _split_commands(std::string_view text) {
+	std::vector<std::string_view> commands;
+	size_t start = 0;
+	int depth = 0;
+	bool in_test = false;
+	char quote = '\0';
+	for (size_t i = 0; i < text.size(); i++) {
+		const char c = text[i];
+		if (quote != '\0') {
+			if (c == '\\' && quote == '"') i++;
+			else if (c == quote) quote = '\0';
+			continue;
+		}
+		const bool starts_word = i == 0 || text[i - 1] == ' ' || text[i - 1] == '\t';
+		switch (c) {
+			case '\\':
+				i++;
+				break;
+			case '\'':
+			case '"':
+				quote = c;
+				break;
+			case '(':
+				depth++;
+				break;
+			case ')':
+				depth = std::max(depth - 1, 0); // Case patterns close parentheses which were never opened
+				break;
+			case '[':
+				if (starts_word && text.substr(i).starts_with("[[")) in_test = true;
+				break;
+			case ']':
+				if (text.substr(i).starts_with("]]")) in_test = false;
+				break;
+			case ';':
+			case '&':
+			case '|':
+			case '\n':
+				if (depth == 0 && !in_test) {
+					commands.push_back(text.substr(start, i - start));
+					start = i + 1;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+	commands.push_back(text.substr(start));
+	return commands;
+}
+
+/**
+ * @brief Split a simple command into words, keeping quoted strings, parentheses and parameter expansions together
+ */
+static std::vector<std::string_view> _split_command_words(std::string_view command) {
+	std::vector<std::string_view> words;
+	size_t start = std::string_view::npos;
+	int depth = 0;
+	char quote = '\0';
+	for (size_t i = 0; i < command.size(); i++) {
+		const char c = command[i];
+		const bool separator = quote == '\0' && depth == 0 && (c == ' ' || c == '\t');
+		if (separator) {
+			if (start != std::string_view::npos) words.push_back(command.substr(start, i - start));
+			start = std::string_view::npos;
+			continue;
+		}
+		if (start == std::string_view::npos) start = i;
+		if (quote != '\0') {
+			if (c == '\\' && quote == '"') i++;
+			else if (c == quote) quote = '\0';
+			continue;
+		}
+		switch (c) {
+			case '\\':
+				i++;
+				break;
+			case '\'':
+			case '"':
+				quote = c;
+				break;
+			case '{':
+				if (i > 0 && command[i - 1] == '$') depth++;
+				break;
+			case '(':
+				depth++;
+				break;
+			case ')':
+			case '}':
+				depth = std::max(depth - 1, 0);
+				break;
+			default:
+				break;
+		}
+	}
+	if (start != std::string_view::npos) words.push_back(command.substr(start));
+	return words;
+}
+
+/**
+ * @brief Add every identifier which appears in a piece of text to the set
+ */
+static void _collect_identifiers(std::string_view text, std::unordered_set<std::string>* identifiers) {
+	size_t position = 0;
+	while (position < text.size()) {
+		if (!_is_identifier_character(text[position])) {
+			position++;
+			continue;
+		}
+		size_t end = position;
+		while (end < text.size() && _is_identifier_character(text[end])) end++;
+		std::string_view word = text.substr(position, end - position);
+		if (_is_identifier(word)) identifiers->emplace(word);
+		position = end;
+	}
+}
+
+/**
+ * @brief Whether expanding a piece of text could assign variables
+ *
+ * That is: ${x:=y}, assignments and increments in arithmetic, and Bash 5.3's ${ command; } substitutions,
+ * which run in the current shell.
+ */
+static bool _has_assigning_expansion(std::string_view text) {
+	for (size_t position = text.find("${"); position != std::string_view::npos; position = text.find("${", position + 2)) {
+		if (position + 2 >= text.size() || std::string_view(" \t\n|").find(text[position + 2]) != std::string_view::npos) return true;
+		size_t end = text.find('}', position);
+		if (text.substr(position, end - position).find('=') != std::string_view::npos) return true;
+	}
+	for (size_t position = text.find("(("); position != std::string_view::npos; position = text.find("((", position + 2)) {
+		std::string_view expression = text.substr(position + 2, text.find("))", position) - position - 2);
+		if (expression.find("++") != std::string_view::npos || expression.find("--") != std::string_view::npos) return true;
+		for (size_t equals = expression.find('='); equals != std::string_view::npos; equals = expression.find('=', equals + 1)) {
+			const bool comparison = (equals > 0 && std::string_view("=!<>").find(expression[equals - 1]) != std::string_view::npos)
+				|| (equals + 1 < expression.size() && expression[equals + 1] == '=');
+			if (!comparison) return true;
+		}
+	}
+	return text.find("$[") != std::string_view::npos;
+}
+
+/**
+ * @brief Add every variable which a line of compiled code may assign or unset to the set
+ *
+ * Only commands which are known not to assign variables (echo, printf without -v, tests, etc),
+ * or whose variables can be read off the command line (plain and declared assignments, read, for, arithmetic commands),
+ * are understood.
+ *
+ * @return true if the line was understood, false if it may assign anything at all
+ */
+static bool _collect_writes(std::string_view line, std::unordered_set<std::string>* written) {
+	constexpr std::array<std::string_view, 9> leading_keywords = {"if", "elif", "while", "until", "then", "else", "do", "!", "{"};
+	constexpr std::array<std::string_view, 5> closing_keywords = {"fi", "done", "esac", "}", ";;"};
+	constexpr std::array<std::string_view, 5> declaration_commands = {"local", "declare", "typeset", "export", "readonly"};
+	constexpr std::array<std::string_view, 14> harmless_commands = {
+		"echo", "printf", "test", "[", "[[", "true", "false", ":",
+		"sleep", "cat", "break", "continue", "return", "exit"
+	};
+	auto is_one_of = [](const auto& list, std::string_view word) {
+		return std::find(list.begin(), list.end(), word) != list.end();
+	};
+	auto assigned_name = [](std::string_view word) {
+		return word.substr(0, std::min(word.find_first_of("+=["), word.size()));
+	};
+
+	for (std::string_view command : _split_commands(line)) {
+		std::vector<std::string_view> words = _split_command_words(command);
+		size_t first = 0;
+		while (first < words.size()) {
+			const std::string_view word = words[first];
+			const bool case_pattern = word.ends_with(')') && word.find_first_of("$`") == std::string_view::npos && !word.starts_with("((");
+			if (!is_one_of(leading_keywords, word) && word != "(" && !case_pattern) break;
+			first++;
+		}
+		if (first == words.size()) continue;
+		std::string_view name = words[first];
+
+		if (is_one_of(closing_keywords, name)) continue;
+
+		if (name.starts_with("((") || name == "let" || (name == "for" && first + 1 < words.size() && words[first + 1].starts_with("(("))) {
+			_collect_identifiers(command, written);
+			continue;
+		}
+
+		if (_has_assigning_expansion(command)) return false;
+
+		if (name == "for" || name == "select") {
+			if (first + 1 >= words.size() || !_is_identifier(words[first + 1])) return false;
+			written->emplace(words[first + 1]);
+			continue;
+		}
+
+		if (name == "case" || name == "function" || name.ends_with("()") || words.back() == "{") continue;
+
+		if (is_one_of(declaration_commands, name)) {
+			for (size_t i = first + 1; i < words.size(); i++) {
+				std::string_view declared = assigned_name(words[i]);
+				if (_is_identifier(declared)) written->emplace(declared);
+			}
+			continue;
+		}
+
+		// Assignments which come before a command
+		while (first < words.size() && words[first].find('=') != std::string_view::npos && _is_identifier(assigned_name(words[first]))) {
+			written->emplace(assigned_name(words[first]));
+			first++;
+		}
+		if (first == words.size()) continue;
+		name = words[first];
+
+		if (name == "read" || name == "mapfile" || name == "readarray") {
+			written->emplace(name == "read" ? "REPLY" : "MAPFILE");
+			for (size_t i = first + 1; i < words.size(); i++) {
+				if (_is_identifier(words[i])) written->emplace(words[i]);
+			}
+			continue;
+		}
+
+		if (!is_one_of(harmless_commands, name)) return false;
+		if (name == "printf" && std::find(words.begin() + static_cast<std::ptrdiff_t>(first), words.end(), "-v") != words.end()) return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Whether a line of compiled code may leave the loop it's in without running the code which follows the loop
+ *
+ * That is: 'return', 'exit', and 'break' or 'continue' with a count (which leave the loops around it as well).
+ * Any word is taken to be one of those commands, wherever it appears.
+ */
+static bool _may_skip_loop_exit(std::string_view line) {
+	for (std::string_view command : _split_commands(line)) {
+		std::vector<std::string_view> words = _split_command_words(command);
+		for (size_t i = 0; i < words.size(); i++) {
+			if (words[i] == "return" || words[i] == "exit") return true;
+			if ((words[i] == "break" || words[i] == "continue") && i + 1 < words.size() && words[i + 1] != "1") return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Collect the variables which a value reads
+ *
+ * @param followed If given, the variables whose values are followed as names (${!name}) are collected here
+ *
+ * @return false if the value refers to anything other than plainly-named variables (e.g. $1, $@, or ${!name} without 'followed')
+ */
+static bool _collect_reads(std::string_view value, std::vector<std::string>* reads, std::vector<std::string>* followed = nullptr) {
+	for (size_t position = value.find('$'); position != std::string_view::npos; position = value.find('$', position + 1)) {
+		size_t start = position + 1;
+		const bool braced = start < value.size() && value[start] == '{';
+		if (braced) start++;
+		const bool indirect = braced && start < value.size() && value[start] == '!';
+		if (indirect) start++;
+		size_t end = start;
+		while (end < value.size() && _is_identifier_character(value[end])) end++;
+		std::string_view name = value.substr(start, end - start);
+		if (!_is_identifier(name)) return false;
+		if (indirect) {
+			if (followed == nullptr || end >= value.size() || value[end] != '}') return false;
+			followed->emplace_back(name);
+		} else {
+			reads->emplace_back(name);
+		}
+	}
+	return true;
+}
+
+hoisted_loop hoist_loop_invariants(
+	std::string_view header,
+	std::string_view body,
+	const std::unordered_set<std::string>& temporaries,
+	const const_members& constants,
+	pass_statistics* statistics
+) {
+	hoisted_loop result;
+	result.body = body;
+	if (temporaries.empty()) return result;
+
+	// If anything in the loop could assign variables we can't see, only @const members are known not to change
+	std::unordered_set<std::string> written;
+	bool opaque = !_collect_writes(header, &written);
+
+	block instructions = build(body, temporaries);
+
+	struct candidate {
+		std::string value;
+		bool local = false;
+		bool eligible = true;
+	};
+	std::unordered_map<std::string, candidate> candidates;
+	std::vector<std::string> candidate_order;
+	std::unordered_set<std::string> ineligible;
+	bool may_skip_exit = false;
+
+	int depth = 0;
+	for (const auto& instruction : instructions.instructions) {
+		if (instruction.text.find('\n') != std::string::npos) return result;
+		switch (instruction.type) {
+			case instruction_type::comment:
+				break;
+			case instruction_type::assignment:
+				for (const auto& [name, value] : instruction.assignments) {
+					written.insert(name);
+					if (instruction.assignments.size() != 1 || depth != 0 || !_is_temporary(&temporaries, name)) {
+						ineligible.insert(name);
+						continue;
+					}
+					auto [entry, inserted] = candidates.try_emplace(name, candidate{value, instruction.local});
+					if (inserted) {
+						candidate_order.push_back(name);
+					} else if (entry->second.value != value || entry->second.local != instruction.local) {
+						entry->second.eligible = false;
+					}
+				}
+				break;
+			case instruction_type::unset:
+				for (const auto& name : instruction.names) {
+					written.insert(name);
+					if (depth != 0) ineligible.insert(name);
+				}
+				break;
+			default:
+				{
+					// Anything written by a command, rather than by the compiler's own assignments, is off-limits
+					std::unordered_set<std::string> written_by_command;
+					if (!_collect_writes(instruction.text, &written_by_command)) opaque = true;
+					for (const auto& name : written_by_command) {
+						written.insert(name);
+						ineligible.insert(name);
+					}
+					if (_may_skip_loop_exit(instruction.text)) may_skip_exit = true;
+				}
+				depth += _nesting_change(instruction);
+				if (depth < 0) return result;
+				break;
+		}
+	}
+	if (depth != 0 || (opaque && constants.variables.empty() && constants.referents.empty())) return result;
+
+	std::unordered_set<std::string> hoisted;
+
+	// Following a temporary (${!temporary}) is only safe before the loop if it names a @const member of '__this',
+	// Since then it's sure to name a variable, even in a loop which never runs
+	auto names_const_member_of_this = [&](const std::string& temporary) {
+		if (!hoisted.contains(temporary) || !constants.referents.contains(temporary)) return false;
+		std::vector<std::string> reads;
+		return _collect_reads(candidates.at(temporary).value, &reads)
+			&& std::all_of(reads.begin(), reads.end(), [](const std::string& read) { return read == "__this"; });
+	};
+
+	std::vector<std::string> hoisted_order;
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (const auto& name : candidate_order) {
+			const candidate& entry = candidates.at(name);
+			if (hoisted.contains(name) || !entry.eligible || ineligible.contains(name)) continue;
+			// Temporaries which aren't local to a function would be left behind if the loop were left without running the exit code
+			if (may_skip_exit && !entry.local) continue;
+
+			std::vector<std::string> reads;
+			std::vector<std::string> followed;
+			if (!_is_pure(entry.value) || !_collect_reads(entry.value, &reads, &followed)) continue;
+			const bool invariant = std::all_of(reads.begin(), reads.end(), [&](const std::string& read) {
+				if (read == name) return false;
+				if (hoisted.contains(read)) return true;
+				return !written.contains(read) && (!opaque || read == "__this" || constants.variables.contains(read));
+			}) && std::all_of(followed.begin(), followed.end(), names_const_member_of_this);
+			if (!invariant) continue;
+
+			hoisted.insert(name);
+			hoisted_order.push_back(name);
+			changed = true;
+		}
+	}
+	if (hoisted.empty()) return result;
+
+	std::vector<instruction> kept;
+	kept.reserve(instructions.instructions.size());
+	for (auto& instruction : instructions.instructions) {
+		if (instruction.type == instruction_type::assignment && hoisted.contains(instruction.assignments.front().name)) continue;
+		if (instruction.type == instruction_type::unset) {
+			if (std::erase_if(instruction.names, [&](const std::string& name) { return hoisted.contains(name); }) > 0) {
+				instruction.modified = true;
+			}
+			if (instruction.names.empty()) continue;
+		}
+		kept.push_back(std::move(instruction));
+	}
+	instructions.instructions = std::move(kept);
+	result.body = lower(instructions);
+
+	result.exit_code = "unset";
+	for (const auto& name : hoisted_order) {
+		const candidate& entry = candidates.at(name);
+		result.preheader += (entry.local ? "local " : "") + name + "=" + entry.value + "\n";
+		result.exit_code += " " + name;
+	}
+	result.exit_code += "\n";
+
+	if (statistics != nullptr) statistics->hoisted_assignments += hoisted_order.size();
+	return result;
+}
+
+std::string optimize(
+	std::string_view code,
+	uint8_t optimization_level,
+	const std::unordered_set<std::string>& temporaries,
+	pass_statistics* statistics
+) {
+	pass_manager manager = pass_manager::for_level(optimization_level);
+	if (manager.get_passes().empty() || temporaries.empty()) return std::string(code);
+
+	block instructions = build(code, temporaries);
+	manager.run(&instructions, statistics);
+	return lower(instructions);
+}
+
+} // namespace bpp::ir
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * Peephole optimization of compiled code
+ *
+ * This isn't an intermediate representation which the listener builds and lowers to Bash:
+ * the passes work on the Bash which the listener has already emitted, split back into lines by build().
+ * The one thing they take from the listener is the set of temporaries it created (see bpp_program::add_temporary),
+ * and only commands which assign or unset those temporaries are ever changed.
+ * Anything which build() can't recognize with certainty is left alone, and treated as a barrier.
+ */
+namespace bpp::ir {
+
+/**
+ * @enum instruction_type
+ * @brief The kinds of instructions which the optimizer distinguishes in compiled code
+ *
+ * Only assignments and unsets are ever rewritten.
+ * Every other kind of instruction is a barrier: the passes assume that it may read or write any variable.
+ */
+enum class instruction_type : uint8_t {
+	assignment,   // [local ]NAME=VALUE [NAME=VALUE ...]
+	unset,        // unset NAME [NAME ...]
+	call,         // A call to a compiled method or to a runtime function (bpp__...)
+	capture,      // A Bash++ supershell (bpp____supershell ...)
+	control_flow, // if/then/while/do/done/case/function definitions, braces, etc
+	comment,      // Blank lines and comments
+	opaque        // Anything else (including anything spanning several lines)
+};
+
+struct assignment {
+	std::string name;
+	std::string value;
+};
+
+/**
+ * @struct instruction
+ * @brief One logical line of compiled code
+ *
+ * Instructions keep their original text, which is what they're lowered to unless a pass has changed them.
+ */
+struct instruction {
+	instruction_type type = instruction_type::opaque;
+	std::string text; // The original text, without the trailing newline
+	std::string indentation;
+	bool local = false; // For assignments: whether they're declared with 'local'
+	std::vector<assignment> assignments;
+	std::vector<std::string> names; // For unsets: the variables unset
+	bool modified = false;
+};
+
+/**
+ * @struct block
+ * @brief A sequence of instructions, as recovered from compiled code by build()
+ */
+struct block {
+	std::vector<instruction> instructions;
+	bool trailing_newline = false;
+	const std::unordered_set<std::string>* temporaries = nullptr; // The temporaries which the compiler created
+};
+
+/**
+ * @struct pass_statistics
+ * @brief What the optimization passes have done, for reporting with -V
+ */
+struct pass_statistics {
+	size_t removed_assignments = 0;
+	size_t removed_unsets = 0; // Counted per variable, not per command
+	size_t merged_commands = 0;
+	size_t hoisted_assignments = 0;
+
+	bool empty() const {
+		return removed_assignments == 0 && removed_unsets == 0 && merged_commands == 0 && hoisted_assignments == 0;
+	}
+};
+
+block build(std::string_view code, const std::unordered_set<std::string>& temporaries);
+std::string lower(const block& instructions);
+
+/**
+ * @class pass_manager
+ * @brief Runs a sequence of optimization passes over a block
+ *
+ * Levels:
+ * 	- 0: No passes
+ * 	- 1 and up: Common-subexpression elimination of reference chains, dead unset removal, and coalescing of temporaries
+ *
+ * Loop-invariant hoisting (hoist_loop_invariants) isn't a pass over a block, since it needs to know where a loop begins and ends.
+ * The listener runs it on each loop as it's compiled.
+ */
+class pass_manager {
+	public:
+		using pass = void(*)(block*, pass_statistics*);
+	private:
+		std::vector<std::pair<std::string, pass>> passes;
+	public:
+		void add_pass(const std::string& name, pass function);
+		const std::vector<std::pair<std::string, pass>>& get_passes() const;
+
+		void run(block* instructions, pass_statistics* statistics) const;
+
+		static pass_manager for_level(uint8_t optimization_level);
+};
+
+void eliminate_common_reference_chains(block* instructions, pass_statistics* statistics);
+void remove_dead_unsets(block* instructions, pass_statistics* statistics);
+void coalesce_temporaries(block* instructions, pass_statistics* statistics);
+
+/**
+ * @struct hoisted_loop
+ * @brief The code of a loop after hoist_loop_invariants()
+ */
+struct hoisted_loop {
+	std::string preheader; // To run once before the loop
+	std::string body;
+	std::string exit_code; // To run once after the loop
+};
+
+/**
+ * @struct const_members
+ * @brief What hoist_loop_invariants() may assume about the data members which were marked @const
+ *
+ * Their values are only ever assigned by their classes' constructors, so nothing in a loop can change them.
+ */
+struct const_members {
+	std::unordered_set<std::string> variables; // Variables which hold @const data members (e.g. 'bpp__Class__object__member')
+	std::unordered_set<std::string> referents; // Temporaries which hold the names of @const data members (e.g. '__this__member')
+};
+
+/**
+ * @brief Move the resolution of references which can't change during a loop out of the loop
+ *
+ * Every statement in a loop which refers to an object re-resolves the reference into its temporary variables
+ * on every iteration, and unsets them again afterwards.
+ * If nothing in the loop can change what the reference resolves to, the temporaries are assigned once before the loop,
+ * and unset once after it.
+ *
+ * A temporary can be hoisted if:
+ * 	- It's only ever assigned at the top level of the loop body, always to the same value
+ * 	- That value only reads variables which the loop never writes (or other hoisted temporaries)
+ * 	- That value doesn't follow a pointer (${!...}), since a loop which never runs mustn't fail on a null pointer,
+ * 	  unless the pointer is a @const member of '__this'
+ *
+ * In a loop which calls any methods or functions, or runs any command which could assign variables
+ * (other than the plain assignments the compiler generates, and 'read', 'for' and arithmetic commands, whose variables are taken into account),
+ * the only variables which are known not to change are '__this', the @const members, and the temporaries hoisted from them.
+ * Temporaries which aren't local to a function are also left in the loop if it may be left without running the exit code
+ * ('return', 'exit', or 'break'/'continue' out of the loops around it), since they'd never be unset.
+ *
+ * @param header The part of the loop which runs on every iteration, but not in the body (its condition, or its 'for' line)
+ * @param body The compiled body of the loop
+ * @param temporaries The temporaries which the compiler created (nothing else is ever hoisted)
+ * @param constants The variables and temporaries which hold @const data members
+ */
+hoisted_loop hoist_loop_invariants(
+	std::string_view header,
+	std::string_view body,
+	const std::unordered_set<std::string>& temporaries,
+	const const_members& constants,
+	pass_statistics* statistics = nullptr
+);
+
+/**
+ * @brief Run the passes for the given optimization level over compiled code
+ *
+ * @param temporaries The temporaries which the compiler created
+ *
+ * @return std::string The optimized code (identical to the input if nothing could be done)
+ */
+std::string optimize(
+	std::string_view code,
+	uint8_t optimization_level,
+	const std::unordered_set<std::string>& temporaries,
+	pass_statistics* statistics = nullptr
+);
+
+} // namespace bpp::ir
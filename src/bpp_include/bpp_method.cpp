@@ -98,6 +98,14 @@ void bpp_method::set_overridden_method(std::weak_ptr<bpp_method> method) {
 	overridden_method = std::move(method);
 }
 
+void bpp_method::set_inline_hint(bool inline_hint) {
+	this->inline_hint = inline_hint;
+}
+
+void bpp_method::set_finalized(bool finalized) {
+	this->finalized = finalized;
+}
+
 std::vector<std::shared_ptr<bpp_method_parameter>> bpp_method::get_parameters() const {
 	return parameters;
 }
@@ -122,6 +130,14 @@ std::string bpp_method::get_last_override() const {
 	return last_override;
 }
 
+bool bpp_method::has_inline_hint() const {
+	return inline_hint;
+}
+
+bool bpp_method::is_finalized() const {
+	return finalized;
+}
+
 bool bpp_method::add_object(std::shared_ptr<bpp_object> object, bool make_local) {
 	std::string name = object->get_name();
 	if (this->get_object(name) != nullptr) return false;
@@ -160,7 +176,7 @@ bool bpp_method::add_object(std::shared_ptr<bpp_object> object, bool make_local)
 			object_code += generate_new_code(object->get_address(), object->get_class(), true, false).full_code() + "\n";
 			// Call the constructor if it exists
 			if (object->get_class()->get_method_UNSAFE("__constructor") != nullptr) {
-				auto constructor_code = generate_constructor_call_code(object->get_address(), object->get_class());
+				auto constructor_code = generate_constructor_call_code(object->get_address(), object->get_class(), get_containing_program().lock());
 				object_code += constructor_code.full_code();
 			}
 		}
@@ -27,6 +27,8 @@ class bpp_method : public bpp_code_entity {
 		bool m_is_virtual = false;
 		bool m_is_overridable = false;
 		bool inherited = false;
+		bool inline_hint = false; // Whether the method was marked @inline
+		bool finalized = false; // Whether the method's body has been compiled in full
 		bool add_object_as_parameter(std::shared_ptr<bpp_object> object);
 		std::string last_override; // Name of the latest class to override this virtual method
 	public:
@@ -37,6 +39,8 @@ class bpp_method : public bpp_code_entity {
 		void set_inherited(bool is_inherited);
 		void set_last_override(const std::string& class_name);
 		void set_overridden_method(std::weak_ptr<bpp_method> method);
+		void set_inline_hint(bool inline_hint);
+		void set_finalized(bool finalized);
 		bool add_object(std::shared_ptr<bpp_object> object, bool make_local) override;
 
 		std::vector<std::shared_ptr<bpp_method_parameter>> get_parameters() const;
@@ -45,6 +49,8 @@ class bpp_method : public bpp_code_entity {
 		bool is_overridable() const;
 		bool is_inherited() const;
 		std::string get_last_override() const;
+		bool has_inline_hint() const;
+		bool is_finalized() const;
 };
 
 /**
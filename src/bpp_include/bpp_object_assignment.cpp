@@ -24,6 +24,10 @@ void bpp_object_assignment::set_rvalue_nonprimitive(bool is_nonprimitive) {
 	rvalue_nonprimitive = is_nonprimitive;
 }
 
+void bpp_object_assignment::set_lvalue_dereferenced(bool is_dereferenced) {
+	lvalue_dereferenced = is_dereferenced;
+}
+
 void bpp_object_assignment::set_lvalue_object(std::shared_ptr<bpp_entity> object) {
 	lvalue_object = std::move(object);
 }
@@ -56,6 +60,10 @@ bool bpp_object_assignment::rvalue_is_nonprimitive() const {
 	return rvalue_nonprimitive;
 }
 
+bool bpp_object_assignment::lvalue_is_dereferenced() const {
+	return lvalue_dereferenced;
+}
+
 std::shared_ptr<bpp_entity> bpp_object_assignment::get_lvalue_object() const {
 	return lvalue_object;
 }
@@ -27,6 +27,7 @@ class bpp_object_assignment : public bpp_string {
 		std::string rvalue;
 		bool lvalue_nonprimitive = false;
 		bool rvalue_nonprimitive = false;
+		bool lvalue_dereferenced = false; // Whether the lvalue is a dereferenced pointer (whose object may be of a derived class)
 		std::shared_ptr<bpp_entity> lvalue_object;
 		std::shared_ptr<bpp_entity> rvalue_object;
 		bool adding = false;
@@ -36,6 +37,7 @@ class bpp_object_assignment : public bpp_string {
 		void set_rvalue(const std::string& rvalue);
 		void set_lvalue_nonprimitive(bool is_nonprimitive);
 		void set_rvalue_nonprimitive(bool is_nonprimitive);
+		void set_lvalue_dereferenced(bool is_dereferenced);
 		void set_lvalue_object(std::shared_ptr<bpp_entity> object);
 		void set_rvalue_object(std::shared_ptr<bpp_entity> object);
 		void set_adding(bool is_adding);
@@ -45,6 +47,7 @@ class bpp_object_assignment : public bpp_string {
 		std::string get_rvalue() const;
 		bool lvalue_is_nonprimitive() const;
 		bool rvalue_is_nonprimitive() const;
+		bool lvalue_is_dereferenced() const;
 		std::shared_ptr<bpp_entity> get_lvalue_object() const;
 		std::shared_ptr<bpp_entity> get_rvalue_object() const;
 		bool is_adding() const;
@@ -7,10 +7,17 @@
 #include "bpp_program.h"
 #include "bpp_class.h"
 #include "bpp_method.h"
+#include "bpp_datamember.h"
+#include "bpp_object.h"
 #include "bpp_codegen.h"
 #include "templates.h"
 #include "replace_all.h"
 
+#include <charconv>
+#include <unordered_set>
+
+#include <AST/ASTNode.h>
+
 namespace bpp {
 
 bool bpp_program::set_containing_class(std::weak_ptr<bpp_class> /* containing_class */) {
@@ -54,6 +61,18 @@ bool bpp_program::prepare_class(std::shared_ptr<bpp_class> class_) {
 	return true;
 }
 
+/**
+ * @brief Fill in the parts of a runtime function which depend on the object layout
+ *
+ * The runtime functions in templates.h are written against the '__this' variable,
+ * leaving placeholders for the check made before following a pointer (%IS_REFERENCE%)
+ * and for the name of the object's vPointer (%VPOINTER%).
+ */
+std::string bpp_program::adapt_to_object_layout(const std::string& runtime_code) const {
+	std::string result = replace_all(runtime_code, "%IS_REFERENCE%", generate_reference_check("__this", associative_objects));
+	return replace_all(result, "%VPOINTER%", get_vpointer_variable("${__this}", associative_objects));
+}
+
 /**
  * @brief Add a class to the program
  * 
@@ -65,7 +84,8 @@ bool bpp_program::add_class(std::shared_ptr<bpp_class> class_) {
 	// Verify that the class has been prepared
 	if (!owned_classes.find(name)) return false;
 
-	std::string class_code;
+	deferred_class class_chunk;
+	class_chunk.name = name;
 
 	// Declare the vTable
 	std::string class_vTable = "declare -A bpp__" + name + "____vTable\n";
@@ -75,6 +95,18 @@ bool bpp_program::add_class(std::shared_ptr<bpp_class> class_) {
 		class_vTable += "bpp__" + name + "____vTable[\"__parent__\"]=\"bpp__" + class_->get_parent()->get_name() + "____vTable\"\n";
 	}
 
+	// Declare the set of the class's ancestors (including itself), keyed by their vTable names
+	// And store its name, so that dynamic_cast and typeof need only a single lookup at runtime
+	std::string class_ancestors = "declare -A bpp__" + name + "____ancestors=(";
+	for (std::shared_ptr<bpp_class> ancestor = class_; ancestor != nullptr; ancestor = ancestor->get_parent()) {
+		class_ancestors += "[\"bpp__" + ancestor->get_name() + "____vTable\"]=1";
+		if (ancestor->get_parent() != nullptr) class_ancestors += " ";
+	}
+	class_ancestors += ")\n";
+	class_vTable += class_ancestors;
+	class_vTable += "bpp__" + name + "____vTable[\"__ancestors__\"]=\"bpp__" + name + "____ancestors\"\n";
+	class_vTable += "bpp__" + name + "____vTable[\"__typeName__\"]=\"" + name + "\"\n";
+
 	// Add the methods
 	for (const auto& method : class_->get_methods()) {
 		if (method->is_inherited() && !method->is_virtual()) continue;
@@ -83,13 +115,14 @@ bool bpp_program::add_class(std::shared_ptr<bpp_class> class_) {
 			if (method->get_last_override() != name) {
 				// Add the vTable entry to point to the last override
 				class_vTable += "bpp__" + name + "____vTable[\"" + method->get_name() + "\"]=\"bpp__" + method->get_last_override() + "__" + method->get_name() + "\"\n";
+				class_chunk.vTable_functions.push_back("bpp__" + method->get_last_override() + "__" + method->get_name());
 				continue; // Skip generating the method again
 			} else {
 				class_vTable += "bpp__" + name + "____vTable[\"" + method->get_name() + "\"]=\"bpp__" + name + "__" + method->get_name() + "\"\n";
+				class_chunk.vTable_functions.push_back("bpp__" + name + "__" + method->get_name());
 			}
 		}
 
-		std::string method_code = template_method;
 		std::string params = method->get_parameters().empty() ? "" : "local ";
 		for (size_t i = 0; i < method->get_parameters().size(); i++) {
 			params += method->get_parameters()[i]->get_name() + "=\"$" + std::to_string(i + 1) + "\"";
@@ -97,24 +130,250 @@ bool bpp_program::add_class(std::shared_ptr<bpp_class> class_) {
 				params += " ";
 			}
 		}
+
+		const std::string method_body = optimize_code(method->get_code());
+
+		auto add_method_function = [&](const std::string& signature, const std::string& validation) {
+			std::string method_code = template_method;
+			method_code = replace_all(method_code, "%THIS_POINTER_VALIDATION%", validation);
+			method_code = replace_all(method_code, "%CLASS%", class_->get_name());
+			method_code = replace_all(method_code, "%SIGNATURE%", signature);
+			method_code = replace_all(method_code, "%PARAMS%", params);
+			method_code = replace_all(method_code, "%METHODBODY%", method_body);
+			class_chunk.functions.emplace_back("bpp__" + name + "__" + signature, std::move(method_code));
+		};
+
 		if (method->get_name() == "__new") {
 			// __new is the only method that doesn't need this_pointer_validation
-			method_code = replace_all(method_code, "%THIS_POINTER_VALIDATION%", "");
+			add_method_function(method->get_name(), "");
+			continue;
+		}
+
+		auto add_forwarding_function = [&](const std::string& signature, const std::string& validation, const std::string& target) {
+			std::string forwarder_code = template_method_forwarder;
+			forwarder_code = replace_all(forwarder_code, "%THIS_POINTER_VALIDATION%", validation);
+			forwarder_code = replace_all(forwarder_code, "%CLASS%", class_->get_name());
+			forwarder_code = replace_all(forwarder_code, "%SIGNATURE%", signature);
+			forwarder_code = replace_all(forwarder_code, "%TARGET%", "bpp__" + name + "__" + target);
+			class_chunk.functions.emplace_back("bpp__" + name + "__" + signature, std::move(forwarder_code));
+		};
+
+		// Every method has a checked entry point and a "validated this" entry point, which skips this_pointer_validation
+		// Callers which already hold the object's resolved address call the latter (see generate_method_call_code)
+		// The body is only generated once: whichever entry point doesn't hold it forwards to the one which does
+		const std::string validated_signature = method->get_name() + bpp::validated_method_suffix;
+		if (release_mode) {
+			add_method_function(validated_signature, "");
+			add_forwarding_function(method->get_name(), adapt_to_object_layout(this_pointer_validation), validated_signature);
 		} else {
-			method_code = replace_all(method_code, "%THIS_POINTER_VALIDATION%", this_pointer_validation);
+			add_method_function(method->get_name(), adapt_to_object_layout(this_pointer_validation));
+			add_forwarding_function(validated_signature, "", method->get_name());
 		}
-		method_code = replace_all(method_code, "%CLASS%", class_->get_name());
-		method_code = replace_all(method_code, "%SIGNATURE%", method->get_name());
-		method_code = replace_all(method_code, "%PARAMS%", params);
-		method_code = replace_all(method_code, "%METHODBODY%", method->get_code());
-		class_code += method_code;
 	}
 
-	*code << class_code << class_vTable << std::flush;
+	class_chunk.vTable_code = std::move(class_vTable);
+
+	if (remove_unused_code || lazy_class_loading) {
+		// Hold the class back until the whole program has been compiled (see link_deferred_classes)
+		*code << deferred_class_marker << deferred_classes.size() << deferred_class_marker << std::flush;
+		deferred_classes.push_back(std::move(class_chunk));
+		return true;
+	}
+
+	for (const auto& function : class_chunk.functions) {
+		*code << function.second;
+	}
+	*code << class_chunk.vTable_code << std::flush;
 
 	return true;
 }
 
+/**
+ * @brief Split the compiled program into its top-level code and the placeholders left by add_class
+ *
+ * @return A list of segments of top-level code, each paired with the index of the deferred class which follows it (or SIZE_MAX)
+ */
+std::vector<std::pair<std::string_view, size_t>> bpp_program::split_deferred_classes(std::string_view compiled_code) const {
+	std::vector<std::pair<std::string_view, size_t>> segments;
+	std::string_view remaining = compiled_code;
+	while (!remaining.empty()) {
+		size_t marker_start = remaining.find(deferred_class_marker);
+		size_t marker_end = (marker_start == std::string_view::npos) ? std::string_view::npos : remaining.find(deferred_class_marker, marker_start + 1);
+		if (marker_end == std::string_view::npos) {
+			segments.emplace_back(remaining, SIZE_MAX);
+			break;
+		}
+		size_t class_index = 0;
+		auto index_text = remaining.substr(marker_start + 1, marker_end - marker_start - 1);
+		auto parsed = std::from_chars(index_text.data(), index_text.data() + index_text.size(), class_index);
+		if (parsed.ec != std::errc() || parsed.ptr != index_text.data() + index_text.size() || class_index >= deferred_classes.size()) {
+			// Not one of our placeholders after all
+			segments.emplace_back(remaining.substr(0, marker_start + 1), SIZE_MAX);
+			remaining.remove_prefix(marker_start + 1);
+			continue;
+		}
+		segments.emplace_back(remaining.substr(0, marker_start), class_index);
+		remaining.remove_prefix(marker_end + 1);
+	}
+	return segments;
+}
+
+/**
+ * @brief Determine which of the deferred classes' functions and vTables can be reached from the top-level code
+ *
+ * Reachability is determined from the compiled code itself:
+ * 	- A function is reachable if its name appears in reachable code
+ * 	- A class is live if the name of its vTable appears in reachable code,
+ * 		which is the case wherever an object of the class is created (whether by its __new method, or inline)
+ * 	- Every function a live class's vTable points to is reachable, since any of them may be called through a vTable lookup
+ * 	- The code of every reachable function is itself reachable
+ *
+ * The names of functions and vTables can't be computed at runtime from anything other than a vTable lookup,
+ * so this never finds anything unreachable which could actually be called.
+ */
+void bpp_program::find_reachable_code(
+	const std::vector<std::pair<std::string_view, size_t>>& segments,
+	std::vector<std::vector<bool>>* reachable_functions,
+	std::vector<bool>* live_classes
+) const {
+	struct function_location {
+		size_t class_index;
+		size_t function_index;
+	};
+
+	std::unordered_map<std::string_view, function_location> functions;
+	std::unordered_map<std::string, size_t> vTables;
+	for (size_t i = 0; i < deferred_classes.size(); i++) {
+		for (size_t j = 0; j < deferred_classes[i].functions.size(); j++) {
+			functions.emplace(deferred_classes[i].functions[j].first, function_location{i, j});
+		}
+		vTables.emplace("bpp__" + deferred_classes[i].name + "____vTable", i);
+	}
+
+	std::vector<std::string_view> code_to_scan;
+
+	auto mark_function = [&](std::string_view function_name) {
+		auto it = functions.find(function_name);
+		if (it == functions.end()) return;
+		auto [class_index, function_index] = it->second;
+		if ((*reachable_functions)[class_index][function_index]) return;
+		(*reachable_functions)[class_index][function_index] = true;
+		code_to_scan.push_back(deferred_classes[class_index].functions[function_index].second);
+	};
+
+	auto mark_class = [&](size_t class_index) {
+		if ((*live_classes)[class_index]) return;
+		(*live_classes)[class_index] = true;
+		for (const auto& function_name : deferred_classes[class_index].vTable_functions) {
+			mark_function(function_name);
+			mark_function(function_name + validated_method_suffix);
+		}
+	};
+
+	auto is_identifier_character = [](char c) {
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+	};
+
+	// Scan the given code for the names of functions and vTables
+	auto scan = [&](std::string_view text) {
+		for (size_t position = text.find("bpp__"); position != std::string_view::npos; position = text.find("bpp__", position)) {
+			if (position > 0 && is_identifier_character(text[position - 1])) {
+				position++;
+				continue;
+			}
+			size_t end = position;
+			while (end < text.size() && is_identifier_character(text[end])) end++;
+			std::string_view identifier = text.substr(position, end - position);
+			mark_function(identifier);
+			auto vTable = vTables.find(std::string(identifier));
+			if (vTable != vTables.end()) mark_class(vTable->second);
+			position = end;
+		}
+	};
+
+	for (const auto& segment : segments) {
+		scan(segment.first);
+	}
+	while (!code_to_scan.empty()) {
+		std::string_view text = code_to_scan.back();
+		code_to_scan.pop_back();
+		scan(text);
+	}
+}
+
+/**
+ * @brief Replace the placeholders left by add_class with the classes' code
+ *
+ * This is run on the complete compiled program, after every class has been added.
+ *
+ * When removing unused code, only those of a class's functions which are reachable are kept, and its vTable only if the class is live
+ * (see find_reachable_code).
+ *
+ * With lazy class loading, a class's functions aren't defined until one of them is first called,
+ * so that Bash doesn't have to parse the code of every class the program includes before it can start running.
+ * The functions' code is stored in a single-quoted string (which Bash reads without parsing),
+ * and each function is replaced by a one-line stub which loads the class (redefining all of its functions) and then calls the real function.
+ *
+ * @param compiled_code The compiled program, including the placeholders left by add_class
+ * @param statistics If not null, filled in with the number of classes and functions removed
+ * @return std::string The complete program
+ */
+std::string bpp_program::link_deferred_classes(const std::string& compiled_code, dead_code_statistics* statistics) const {
+	if (deferred_classes.empty()) return compiled_code;
+
+	auto segments = split_deferred_classes(compiled_code);
+
+	std::vector<std::vector<bool>> reachable_functions(deferred_classes.size());
+	std::vector<bool> live_classes(deferred_classes.size(), !remove_unused_code);
+	for (size_t i = 0; i < deferred_classes.size(); i++) {
+		reachable_functions[i].assign(deferred_classes[i].functions.size(), !remove_unused_code);
+	}
+
+	if (remove_unused_code) {
+		find_reachable_code(segments, &reachable_functions, &live_classes);
+	}
+
+	std::string result;
+	result.reserve(compiled_code.size());
+	bool wrote_class_loader = false;
+	for (const auto& [top_level_code, class_index] : segments) {
+		result += top_level_code;
+		if (class_index == SIZE_MAX) continue;
+
+		const auto& class_chunk = deferred_classes[class_index];
+		std::string class_functions;
+		std::string class_function_stubs;
+		for (size_t i = 0; i < class_chunk.functions.size(); i++) {
+			if (!reachable_functions[class_index][i]) {
+				if (statistics != nullptr) statistics->removed_functions++;
+				continue;
+			}
+			const auto& [function_name, function_code] = class_chunk.functions[i];
+			class_functions += function_code;
+			class_function_stubs += "function " + function_name + "() { bpp____load__class " + class_chunk.name + "; " + function_name + " \"$@\"; }\n";
+		}
+
+		if (lazy_class_loading && !class_functions.empty()) {
+			if (!wrote_class_loader) {
+				result += bpp_load_class;
+				wrote_class_loader = true;
+			}
+			result += "bpp__" + class_chunk.name + "____lazyCode='" + replace_all(class_functions, "'", "'\\''") + "'\n";
+			result += class_function_stubs;
+		} else {
+			result += class_functions;
+		}
+
+		if (live_classes[class_index]) {
+			result += class_chunk.vTable_code;
+		} else if (statistics != nullptr) {
+			statistics->removed_classes++;
+		}
+	}
+
+	return result;
+}
+
 void bpp_program::set_include_paths(std::shared_ptr<std::vector<std::string>> paths) {
 	include_paths = std::move(paths);
 }
@@ -154,7 +413,7 @@ void bpp_program::increment_function_counter() {
 	if (function_counter == 1) {
 		// This is the first function called
 		// Write the vTable_lookup code to the program
-		add_code_to_previous_line(bpp_vtable_lookup);
+		add_code_to_previous_line(adapt_to_object_layout(bpp_vtable_lookup));
 	}
 }
 
@@ -168,7 +427,7 @@ void bpp_program::increment_dynamic_cast_counter() {
 	if (dynamic_cast_counter == 1) {
 		// This is the first dynamic_cast called
 		// Write the dynamic_cast code to the program
-		add_code_to_previous_line(bpp_dynamic_cast);
+		add_code_to_previous_line(adapt_to_object_layout(bpp_dynamic_cast));
 	}
 }
 
@@ -182,7 +441,7 @@ void bpp_program::increment_typeof_counter() {
 	if (typeof_counter == 1) {
 		// This is the first typeof called
 		// Write the typeof code to the program
-		add_code_to_previous_line(bpp_typeof_function);
+		add_code_to_previous_line(adapt_to_object_layout(bpp_typeof_function));
 	}
 }
 
@@ -190,6 +449,24 @@ uint64_t bpp_program::get_typeof_counter() const {
 	return typeof_counter;
 }
 
+void bpp_program::increment_null_check_counter() {
+	// Null checks are generated inline, so there's no runtime function to write to the program
+	null_check_counter++;
+}
+
+uint64_t bpp_program::get_null_check_counter() const {
+	return null_check_counter;
+}
+
+void bpp_program::increment_inline_counter() {
+	// Inlined method calls don't need any runtime support either
+	inline_counter++;
+}
+
+uint64_t bpp_program::get_inline_counter() const {
+	return inline_counter;
+}
+
 void bpp_program::set_target_bash_version(BashVersion target_bash_version) {
 	this->target_bash_version = target_bash_version;
 }
@@ -198,6 +475,83 @@ BashVersion bpp_program::get_target_bash_version() const {
 	return target_bash_version;
 }
 
+void bpp_program::set_release_mode(bool release_mode) {
+	this->release_mode = release_mode;
+}
+
+bool bpp_program::get_release_mode() const {
+	return release_mode;
+}
+
+void bpp_program::set_optimization_level(uint8_t optimization_level) {
+	this->optimization_level = optimization_level;
+}
+
+uint8_t bpp_program::get_optimization_level() const {
+	return optimization_level;
+}
+
+std::string bpp_program::optimize_code(std::string_view compiled_code) {
+	return ir::optimize(compiled_code, optimization_level, temporaries, &optimization_statistics);
+}
+
+void bpp_program::add_temporary(const std::string& name) {
+	temporaries.insert(name);
+}
+
+void bpp_program::add_const_member(const std::string& class_name, const std::string& variable, bool referent) {
+	ir::const_members& members = const_members[class_name];
+	(referent ? members.referents : members.variables).insert(variable);
+}
+
+ir::hoisted_loop bpp_program::hoist_loop_invariants(std::string_view loop_header, std::string_view loop_body, std::shared_ptr<bpp_class> containing_class) {
+	if (optimization_level == 0) return {"", std::string(loop_body), ""};
+
+	ir::const_members constants = const_members[""];
+	if (containing_class != nullptr) {
+		const ir::const_members& class_constants = const_members[containing_class->get_name()];
+		constants.variables.insert(class_constants.variables.begin(), class_constants.variables.end());
+		constants.referents.insert(class_constants.referents.begin(), class_constants.referents.end());
+	}
+	return ir::hoist_loop_invariants(loop_header, loop_body, temporaries, constants, &optimization_statistics);
+}
+
+const ir::pass_statistics& bpp_program::get_optimization_statistics() const {
+	return optimization_statistics;
+}
+
+void bpp_program::set_lazy_class_loading(bool lazy_class_loading) {
+	this->lazy_class_loading = lazy_class_loading;
+}
+
+bool bpp_program::get_lazy_class_loading() const {
+	return lazy_class_loading;
+}
+
+void bpp_program::set_remove_unused_code(bool remove_unused_code) {
+	this->remove_unused_code = remove_unused_code;
+}
+
+bool bpp_program::get_remove_unused_code() const {
+	return remove_unused_code;
+}
+
+void bpp_program::set_associative_objects(bool associative_objects) {
+	this->associative_objects = associative_objects;
+}
+
+bool bpp_program::get_associative_objects() const {
+	return associative_objects;
+}
+
+void bpp_program::set_inline_threshold(uint64_t inline_threshold) {
+	this->inline_threshold = inline_threshold;
+}
+
+uint64_t bpp_program::get_inline_threshold() const {
+	return inline_threshold;
+}
+
 void bpp_program::mark_entity(
 	const std::string& file,
 	uint32_t start_line, uint32_t start_column,
@@ -258,6 +612,38 @@ std::shared_ptr<AST::Program> bpp_program::get_source_file_ast(const std::string
 	return nullptr; // No AST found for the file
 }
 
+std::vector<std::shared_ptr<AST::Program>> bpp_program::get_source_file_asts() const {
+	std::vector<std::shared_ptr<AST::Program>> asts;
+	asts.reserve(source_file_asts.size());
+	for (const auto& [file, ast] : source_file_asts) {
+		if (ast != nullptr) asts.push_back(ast);
+	}
+	return asts;
+}
+
+void bpp_program::build_position_indices() {
+	for (auto& [file, entity_map] : entity_maps) {
+		entity_map.build();
+	}
+
+	source_file_position_indices.clear();
+	for (const auto& [file, ast] : source_file_asts) {
+		source_file_position_indices.emplace(file, AST::PositionIndex(ast));
+	}
+}
+
+std::shared_ptr<AST::ASTNode> bpp_program::find_node_at(const std::string& file, uint32_t line, uint32_t column) const {
+	auto index = source_file_position_indices.find(file);
+	if (index != source_file_position_indices.end()) {
+		return index->second.find(line, column);
+	}
+
+	// No index built: build a throwaway one, which costs about as much as walking the AST once
+	auto ast = source_file_asts.find(file);
+	if (ast == source_file_asts.end() || ast->second == nullptr) return nullptr;
+	return AST::PositionIndex(ast->second).find(line, column);
+}
+
 void bpp_program::add_diagnostic(
 	const std::string& file,
 	diagnostic_type type,
@@ -290,4 +676,57 @@ void bpp_program::clear_diagnostics(const std::string& file) {
 	}
 }
 
+size_t bpp_program::estimate_memory_usage() const {
+	// Rough overheads of the allocations we can't see into:
+	// Every heap object owned through a shared_ptr also has a control block
+	constexpr size_t control_block_overhead = 2 * sizeof(long);
+
+	size_t total = sizeof(bpp_program);
+
+	// The ASTs themselves aren't counted here (see get_source_file_asts())
+	for (const auto& [file, ast] : source_file_asts) {
+		total += file.capacity();
+	}
+
+	// Position indices
+	for (const auto& [file, index] : source_file_position_indices) {
+		total += file.capacity() + index.memory_usage();
+	}
+
+	// Entities, with their references
+	// An entity can be reachable in more than one way (e.g., through an entity map and through its class),
+	// So we make sure to only count each one once
+	std::unordered_set<const bpp_entity*> counted_entities;
+	auto count_entity = [&](const std::shared_ptr<bpp_entity>& entity) {
+		if (entity == nullptr || !counted_entities.insert(entity.get()).second) return;
+		total += sizeof(bpp_code_entity) + control_block_overhead + entity->get_name().capacity();
+		total += entity->get_references().capacity() * sizeof(ReferencePosition);
+	};
+
+	for (const auto& class_ : owned_classes.get_entities()) {
+		count_entity(class_);
+		for (const auto& method : class_->get_methods()) count_entity(method);
+		for (const auto& datamember : class_->get_datamembers()) count_entity(datamember);
+	}
+	for (const auto& object : get_local_objects().get_entities()) {
+		count_entity(object);
+	}
+
+	// Entity maps
+	for (const auto& [file, entity_map] : entity_maps) {
+		total += file.capacity() + entity_map.memory_usage();
+		entity_map.for_each_entity(count_entity);
+	}
+
+	// Diagnostics
+	for (const auto& [file, file_diagnostics] : diagnostics) {
+		total += file.capacity() + file_diagnostics.capacity() * sizeof(bpp::diagnostic);
+		for (const auto& diagnostic : file_diagnostics) {
+			total += diagnostic.message.capacity();
+		}
+	}
+
+	return total;
+}
+
 } // namespace bpp
@@ -8,15 +8,19 @@
 
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <ranges>
 
 #include <include/EntityMap.h>
+#include <AST/PositionIndex.h>
 #include <include/BashVersion.h>
 
 #include "bpp.h"
 #include "bpp_code_entity.h"
+#include "bpp_ir.h"
 
 namespace bpp {
 
@@ -32,8 +36,19 @@ class bpp_program : public bpp_code_entity, public std::enable_shared_from_this<
 		uint64_t function_counter = 0;
 		uint64_t dynamic_cast_counter = 0;
 		uint64_t typeof_counter = 0;
+		uint64_t null_check_counter = 0;
+		uint64_t inline_counter = 0;
 		
 		BashVersion target_bash_version = {5, 2};
+		bool release_mode = false; // Whether to omit runtime checks which are redundant in a correct program
+		uint8_t optimization_level = 0; // Which passes to run over the compiled code (see bpp::ir::pass_manager)
+		bool lazy_class_loading = false; // Whether to defer defining each class's methods until one of them is first called
+		bool remove_unused_code = false; // Whether to remove classes and methods which the program never uses
+		bool associative_objects = false; // Whether to store each object's data members in a single associative array
+		uint64_t inline_threshold = 8; // The longest method body (in lines) which may be inlined without an @inline hint
+		ir::pass_statistics optimization_statistics;
+		std::unordered_set<std::string> temporaries; // Every temporary variable the compiler has created (the only variables the optimizer may touch)
+		std::unordered_map<std::string, ir::const_members> const_members; // Keyed by class name for temporaries which start from '__this', "" for the rest
 
 		std::string main_source_file;
 
@@ -44,6 +59,7 @@ class bpp_program : public bpp_code_entity, public std::enable_shared_from_this<
 		// Source file -> AST
 		// Used for advanced analysis, e.g. LSP features
 		std::unordered_map<std::string, std::shared_ptr<AST::Program>> source_file_asts;
+		std::unordered_map<std::string, AST::PositionIndex> source_file_position_indices; // Built by build_position_indices()
 
 		// Source file -> EntityMap
 		std::unordered_map<std::string, EntityMap> entity_maps;
@@ -56,6 +72,27 @@ class bpp_program : public bpp_code_entity, public std::enable_shared_from_this<
 
 		// For debug info:
 		std::shared_ptr<std::vector<std::string>> include_paths;
+
+		// When removing unused code (or with lazy class loading), the code for each class is held back until the whole program has been compiled
+		// add_class() writes a placeholder to the output stream in its place,
+		// and link_deferred_classes() replaces the placeholder with the class's code (or whatever of it turns out to be reachable)
+		struct deferred_class {
+			std::string name;
+			std::vector<std::pair<std::string, std::string>> functions; // Function name -> function definition
+			std::vector<std::string> vTable_functions; // The functions the vTable points to
+			std::string vTable_code;
+		};
+		std::vector<deferred_class> deferred_classes;
+		static constexpr char deferred_class_marker = '\x1e';
+
+		std::string adapt_to_object_layout(const std::string& runtime_code) const;
+
+		std::vector<std::pair<std::string_view, size_t>> split_deferred_classes(std::string_view compiled_code) const;
+		void find_reachable_code(
+			const std::vector<std::pair<std::string_view, size_t>>& segments,
+			std::vector<std::vector<bool>>* reachable_functions,
+			std::vector<bool>* live_classes
+		) const;
 	public:
 		bpp_program() = default;
 		~bpp_program() override = default;
@@ -96,9 +133,73 @@ class bpp_program : public bpp_code_entity, public std::enable_shared_from_this<
 		void increment_typeof_counter();
 		uint64_t get_typeof_counter() const;
 
+		void increment_null_check_counter();
+		uint64_t get_null_check_counter() const;
+
+		void increment_inline_counter();
+		uint64_t get_inline_counter() const;
+
 		void set_target_bash_version(BashVersion target_bash_version);
 		BashVersion get_target_bash_version() const;
 
+		void set_release_mode(bool release_mode);
+		bool get_release_mode() const;
+
+		void set_optimization_level(uint8_t optimization_level);
+		uint8_t get_optimization_level() const;
+
+		/**
+		 * @brief Run the optimization passes for the program's optimization level over a piece of compiled code
+		 *
+		 * What the passes did is added to the program's optimization statistics.
+		 */
+		std::string optimize_code(std::string_view compiled_code);
+
+		/**
+		 * @brief Record a temporary variable which the compiler created
+		 *
+		 * The optimizer only ever removes or merges assignments and unsets of the variables recorded here,
+		 * so a program's own variables are left alone, whatever they're called.
+		 */
+		void add_temporary(const std::string& name);
+
+		/**
+		 * @brief Record a variable which holds a @const data member, or a temporary which holds the name of one
+		 *
+		 * @param class_name The class in which a reference starting from '__this' was resolved, or "" for any other reference
+		 * @param referent Whether the variable is a temporary holding the member's name, rather than the member itself
+		 */
+		void add_const_member(const std::string& class_name, const std::string& variable, bool referent);
+
+		/**
+		 * @brief Move loop-invariant reference resolution out of a compiled loop body (see bpp::ir::hoist_loop_invariants)
+		 *
+		 * Nothing is hoisted at optimization level 0.
+		 *
+		 * @param containing_class The class whose code the loop is in (nullptr outside of classes)
+		 */
+		ir::hoisted_loop hoist_loop_invariants(std::string_view loop_header, std::string_view loop_body, std::shared_ptr<bpp_class> containing_class);
+		const ir::pass_statistics& get_optimization_statistics() const;
+
+		void set_lazy_class_loading(bool lazy_class_loading);
+		bool get_lazy_class_loading() const;
+
+		void set_remove_unused_code(bool remove_unused_code);
+		bool get_remove_unused_code() const;
+
+		void set_associative_objects(bool associative_objects);
+		bool get_associative_objects() const;
+
+		void set_inline_threshold(uint64_t inline_threshold);
+		uint64_t get_inline_threshold() const;
+
+		struct dead_code_statistics {
+			size_t removed_classes = 0;
+			size_t removed_functions = 0;
+		};
+
+		std::string link_deferred_classes(const std::string& compiled_code, dead_code_statistics* statistics = nullptr) const;
+
 		void mark_entity(
 			const std::string& file,
 			uint32_t start_line, uint32_t start_column,
@@ -118,6 +219,23 @@ class bpp_program : public bpp_code_entity, public std::enable_shared_from_this<
 
 		void set_source_file_ast(const std::string& file, std::shared_ptr<AST::Program> ast);
 		std::shared_ptr<AST::Program> get_source_file_ast(const std::string& file) const;
+		std::vector<std::shared_ptr<AST::Program>> get_source_file_asts() const;
+
+		/**
+		 * @brief Build the position indices used by the language server to look things up by position
+		 *
+		 * Builds a PositionIndex over the AST of every source file, and prepares every entity map for lookups.
+		 * Should be called once the program has been fully walked; afterwards,
+		 * find_node_at and get_active_entity can safely be called from several threads at once.
+		 */
+		void build_position_indices();
+
+		/**
+		 * @brief Find the innermost AST node at a given position in one of the program's source files
+		 *
+		 * Uses the position index if it's been built, or walks the AST otherwise.
+		 */
+		std::shared_ptr<AST::ASTNode> find_node_at(const std::string& file, uint32_t line, uint32_t column) const;
 
 		void add_diagnostic(
 			const std::string& file,
@@ -129,6 +247,19 @@ class bpp_program : public bpp_code_entity, public std::enable_shared_from_this<
 
 		std::vector<bpp::diagnostic> get_diagnostics(const std::string& file) const;
 		void clear_diagnostics(const std::string& file);
+
+		/**
+		 * @brief Estimate how many bytes of memory this program's analysis results occupy
+		 *
+		 * Covers the entity maps, entities (with their references), position indices and diagnostics.
+		 * The estimate is approximate: it counts the allocations we know about, plus a rough per-allocation overhead.
+		 *
+		 * The ASTs aren't included, since they may be shared with other programs.
+		 * Their sizes are given by AST::Program::memory_usage().
+		 *
+		 * Used by the language server to keep its program pool within a memory budget.
+		 */
+		size_t estimate_memory_usage() const;
 };
 
 } // namespace bpp
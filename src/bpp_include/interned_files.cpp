@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "interned_files.h"
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace bpp {
+
+struct InternedFileTable {
+	std::deque<std::string> paths; // Indexed by FileId; a deque never moves its elements
+	std::unordered_map<std::string_view, FileId> ids; // Views into 'paths'
+	std::shared_mutex table_mutex;
+};
+
+static InternedFileTable& get_interned_file_table() {
+	static InternedFileTable table;
+	return table;
+}
+
+FileId intern_file_path(const std::string& path) {
+	// References are usually recorded many times in a row for the same file,
+	// So remember the last path each thread interned
+	thread_local std::string last_path;
+	thread_local FileId last_id = 0;
+	thread_local bool has_last = false;
+	if (has_last && path == last_path) return last_id;
+
+	InternedFileTable& table = get_interned_file_table();
+	FileId id;
+	{
+		std::shared_lock<std::shared_mutex> lock(table.table_mutex);
+		auto it = table.ids.find(path);
+		if (it != table.ids.end()) {
+			id = it->second;
+		} else {
+			lock.unlock();
+			std::unique_lock<std::shared_mutex> write_lock(table.table_mutex);
+			// Somebody else may have interned it while we weren't holding the lock
+			it = table.ids.find(path);
+			if (it != table.ids.end()) {
+				id = it->second;
+			} else {
+				id = static_cast<FileId>(table.paths.size());
+				const std::string& stored = table.paths.emplace_back(path);
+				table.ids.emplace(std::string_view(stored), id);
+			}
+		}
+	}
+
+	last_path = path;
+	last_id = id;
+	has_last = true;
+	return id;
+}
+
+const std::string& get_interned_file_path(FileId id) {
+	InternedFileTable& table = get_interned_file_table();
+	std::shared_lock<std::shared_mutex> lock(table.table_mutex);
+	return table.paths.at(id);
+}
+
+} // namespace bpp
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace bpp {
+
+/**
+ * @brief A small integer standing in for a source file path
+ *
+ * Paths are interned process-wide: every distinct path is stored exactly once,
+ * and is given an ID which never changes and is never reused.
+ * This lets things which are recorded very many times (e.g., symbol references)
+ * carry a 4-byte ID instead of a copy of the path.
+ */
+using FileId = uint32_t;
+
+/**
+ * @brief Get the ID for a path, interning it if it hasn't been seen before
+ *
+ * Thread-safe.
+ */
+FileId intern_file_path(const std::string& path);
+
+/**
+ * @brief Get the path for an ID returned by intern_file_path
+ *
+ * Thread-safe. The returned reference stays valid for the lifetime of the process.
+ */
+const std::string& get_interned_file_path(FileId id);
+
+} // namespace bpp
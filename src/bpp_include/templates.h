@@ -17,6 +17,22 @@
  *
  * - Associative arrays were introduced in Bash 4.0.
  *    This is used by the vTable lookup and dynamic_cast functions to store method pointers and to check types.
+ *    Every class also has an associative array of its ancestors, so that dynamic_cast is a single lookup however deep the hierarchy.
+ *
+ * - The runtime functions follow pointers with indirect expansion (`${!var-}`) rather than `eval "declare -p ..."`,
+ *    so that a method call doesn't have to parse a new command for every pointer it dereferences.
+ *    A name is only ever expanded indirectly after it's been checked to be a valid identifier,
+ *    since `${!var}` on anything else is a fatal expansion error (and `${!0}` would expand $0).
+ *    Results are stored with `printf -v`, which was introduced in Bash 3.1.
+ *    Since every target already requires Bash 4.0, the same code is generated for every target version.
+ *
+ * - With the associative array object layout (-A), every object is a global associative array, created with `declare -gA`.
+ *    `declare -g` was introduced in Bash 4.2, which is the minimum target version for that layout.
+ *    Pointers may then also hold the name of an array element (e.g. `bpp__Class__obj[member]`),
+ *    so the check before following a pointer accepts a valid identifier followed by an optional [key].
+ *
+ * The %IS_REFERENCE% and %VPOINTER% placeholders are filled in according to the object layout
+ * by bpp_program::adapt_to_object_layout().
  */
 
 
@@ -47,44 +63,35 @@ function bpp____supershell() {
 })EOF";
 
 [[maybe_unused]] constexpr static const char* bpp_vtable_lookup = R"EOF(function bpp____vTable__lookup() {
-	local __this="$1" __method="$2" __outputVar="$3"
-	([[ -z "${__this}" ]] || [[ -z "${__method}" ]] || [[ -z "${__outputVar}" ]]) && >&2 echo "Bash++: Error: Invalid vTable lookup" && exit 1
-	while : ; do
-		if ! eval "declare -p \"${__this}\"" &>/dev/null; then
-			break
-		fi
-		[[ -z "${!__this}" ]] && break
+	local __this="$1" __method="$2" __outputVar="$3" __thisOutputVar="$4"
+	[[ -z "${__this}" || -z "${__method}" || -z "${__outputVar}" ]] && >&2 echo "Bash++: Error: Invalid vTable lookup" && exit 1
+	while [[ %IS_REFERENCE% && -n "${!__this-}" ]]; do
 		__this="${!__this}"
 	done
-	local __vTable="${__this}____vPointer"
-	if ! eval "declare -p \"${__vTable}\"" &>/dev/null; then
-		return 1
-	fi
+	[[ "${__this}" == [A-Za-z_]* && "${__this}" != *[!A-Za-z0-9_]* ]] || return 1
+	local __vTable="%VPOINTER%"
+	[[ -n "${!__vTable-}" ]] || return 1
 	local __result="${!__vTable}[\"${__method}\"]"
-	[[ -z "${!__result}" ]] && >&2 echo "Bash++: Error: Method '${__method}' not found in vTable for object '${__this}'" && return 1
-	eval "${__outputVar}=\$__result"
+	[[ -z "${!__result-}" ]] && >&2 echo "Bash++: Error: Method '${__method}' not found in vTable for object '${__this}'" && return 1
+	printf -v "${__outputVar}" '%s' "${__result}"
+	[[ -z "${__thisOutputVar}" ]] || printf -v "${__thisOutputVar}" '%s' "${__this}"
 }
 )EOF";
 
 [[maybe_unused]] constexpr static const char* bpp_dynamic_cast = R"EOF(function bpp____dynamic__cast() {
 	local __type="$1" __outputVar="$2" __this="$3"
-	([[ -z "${__outputVar}" ]]) && >&2 echo "Bash++: Error: Invalid dynamic_cast" && exit 1
-	eval "${__outputVar}=0"
-	while : ; do
-		if ! eval "declare -p \"${__this}\"" &>/dev/null; then
-			break
-		fi
-		[[ -z "${!__this}" ]] && break
+	[[ -z "${__outputVar}" ]] && >&2 echo "Bash++: Error: Invalid dynamic_cast" && exit 1
+	printf -v "${__outputVar}" '%s' 0
+	while [[ %IS_REFERENCE% && -n "${!__this-}" ]]; do
 		__this="${!__this}"
 	done
-	local __vTable="${__this}____vPointer"
-	if ! eval "declare -p \"${__vTable}\"" &>/dev/null; then
-		return 1
-	fi
-	while [[ ! -z "${!__vTable}" ]] 2>/dev/null; do
-		[[ "${!__vTable}" == "bpp__${__type}____vTable" ]] && eval "${__outputVar}=\"${__this}\"" && return 0
-		__vTable="${!__vTable}[\"__parent__\"]"
-	done
+	[[ "${__this}" == [A-Za-z_]* && "${__this}" != *[!A-Za-z0-9_]* ]] || return 1
+	local __vTable="%VPOINTER%"
+	[[ -n "${!__vTable-}" ]] || return 1
+	[[ "${__type}" == *[!A-Za-z0-9_]* ]] && return 1
+	local __ancestors="${!__vTable}[\"__ancestors__\"]"
+	__ancestors="${!__ancestors}[\"bpp__${__type}____vTable\"]"
+	[[ -n "${!__ancestors-}" ]] 2>/dev/null && printf -v "${__outputVar}" '%s' "${__this}" && return 0
 	return 1
 }
 )EOF";
@@ -92,21 +99,21 @@ function bpp____supershell() {
 [[maybe_unused]] constexpr static const char* bpp_typeof_function = R"EOF(function bpp____typeof() {
 	local __this="$1" __outputVar="$2"
 	[[ -z "${__this}" ]] && >&2 echo "Bash++: Error: Invalid type name request" && exit 1
-	while : ; do
-		if ! eval "declare -p \"${__this}\"" &>/dev/null; then
-			break
-		fi
-		[[ -z "${!__this}" ]] && break
+	while [[ %IS_REFERENCE% && -n "${!__this-}" ]]; do
 		__this="${!__this}"
 	done
-	local __vTable="${__this}____vPointer"
-	if ! eval "declare -p \"${__vTable}\"" &>/dev/null; then
-		return 1
-	fi
-	__vTable="${!__vTable}"
-	local __typeName="${__vTable/bpp__/}"
-	__typeName="${__typeName/____vTable/}"
-	eval "${__outputVar}=\"${__typeName}\""
+	[[ "${__this}" == [A-Za-z_]* && "${__this}" != *[!A-Za-z0-9_]* ]] || return 1
+	local __vTable="%VPOINTER%"
+	[[ -n "${!__vTable-}" ]] || return 1
+	local __typeName="${!__vTable}[\"__typeName__\"]"
+	printf -v "${__outputVar}" '%s' "${!__typeName-}"
+}
+)EOF";
+
+[[maybe_unused]] constexpr static const char* bpp_load_class = R"EOF(function bpp____load__class() {
+	local __lazyCode="bpp__${1}____lazyCode"
+	eval "${!__lazyCode}"
+	unset "${__lazyCode}"
 }
 )EOF";
 
@@ -119,15 +126,19 @@ function bpp____supershell() {
 }
 )EOF";
 
-[[maybe_unused]] constexpr static const char* this_pointer_validation = R"EOF(while : ; do
-		if ! eval "declare -p \"${__this}\"" &>/dev/null; then
-			break
-		fi
-		[[ -z "${!__this}" ]] && break
+[[maybe_unused]] constexpr static const char* template_method_forwarder = R"EOF(function bpp__%CLASS%__%SIGNATURE%() {
+	local __this="$1"
+	shift 1
+	%THIS_POINTER_VALIDATION%
+	%TARGET% "${__this}" "$@"
+}
+)EOF";
+
+[[maybe_unused]] constexpr static const char* this_pointer_validation = R"EOF(while [[ %IS_REFERENCE% && -n "${!__this-}" ]]; do
 		__this="${!__this}"
 	done
-	local __vPointer="${__this}____vPointer"
-	if [[ "${__this}" == "0" ]] || [[ -z "${!__vPointer}" ]]; then
+	local __vPointer="%VPOINTER%"
+	if [[ "${__this}" != [A-Za-z_]* || "${__this}" == *[!A-Za-z0-9_]* || -z "${!__vPointer-}" ]]; then
 		>&2 echo "Bash++: Error: Attempted to call @%CLASS%.%SIGNATURE% on null object"
 		return 1
 	fi
@@ -98,7 +98,7 @@ void yyerror(const char *s);
 %token <int> DEPRECATED_SUBSHELL_START DEPRECATED_SUBSHELL_END
 %token LPAREN RPAREN
 
-%token KEYWORD_CLASS KEYWORD_VIRTUAL KEYWORD_METHOD KEYWORD_CONSTRUCTOR KEYWORD_DESTRUCTOR
+%token KEYWORD_CLASS KEYWORD_VIRTUAL KEYWORD_INLINE KEYWORD_CONST KEYWORD_METHOD KEYWORD_CONSTRUCTOR KEYWORD_DESTRUCTOR
 %token KEYWORD_NEW KEYWORD_DELETE KEYWORD_NULLPTR
 
 %token <AST::Token<std::string>> IDENTIFIER IDENTIFIER_LVALUE
@@ -1058,6 +1058,16 @@ datamember_declaration:
 
 		$$ = node;
 	}
+	| KEYWORD_CONST WS datamember_declaration {
+		auto node = std::static_pointer_cast<AST::DatamemberDeclaration>($3);
+		uint32_t line_number = @1.begin.line;
+		uint32_t column_number = @1.begin.column;
+		node->setPosition(line_number, column_number);
+
+		node->setConst(true);
+
+		$$ = node;
+	}
 	;
 
 access_modifier:
@@ -1141,6 +1151,16 @@ method_definition:
 
 		$$ = node;
 	}
+	| KEYWORD_INLINE WS method_definition {
+		auto node = std::static_pointer_cast<AST::MethodDefinition>($3);
+		uint32_t line_number = @1.begin.line;
+		uint32_t column_number = @1.begin.column;
+		node->setPosition(line_number, column_number);
+
+		node->setInline(true);
+
+		$$ = node;
+	}
 	;
 
 maybe_parameter_list:
@@ -63,6 +63,16 @@ class EntityMap {
 			tree.insert(start, end, entity);
 		}
 
+		/**
+		 * @brief Prepare the map for lookups
+		 *
+		 * Done lazily by the first lookup otherwise, but calling it up front
+		 * means that lookups from several threads don't race to do it.
+		 */
+		void build() {
+			tree.build();
+		}
+
 		std::shared_ptr<bpp::bpp_entity> find(FilePosition point) {
 			return tree.find_innermost_overlap(point);
 		}
@@ -73,4 +83,17 @@ class EntityMap {
 		std::shared_ptr<bpp::bpp_entity> find(uint32_t line, uint32_t column) {
 			return find(FilePosition(line, column));
 		}
+
+		size_t size() const {
+			return tree.size();
+		}
+
+		size_t memory_usage() const {
+			return tree.memory_usage();
+		}
+
+		template <class F>
+		void for_each_entity(F&& function) const {
+			tree.for_each(std::forward<F>(function));
+		}
 };
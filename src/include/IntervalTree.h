@@ -31,54 +31,81 @@
  *
  * These invariants allow us to use a sorted vector and binary search for efficient querying,
  * avoiding the complexity of a traditional tree structure.
+ *
+ * Because intervals are either nested or disjoint, they form a forest.
+ * When the tree is built, every interval is given a link to the interval immediately enclosing it.
+ * A query binary searches for the last interval starting at or before the point,
+ * and if that one has already ended, follows the links outwards until it finds one which contains the point.
+ * That costs O(log n) plus the nesting depth, no matter how many sibling intervals precede the point.
+ *
+ * The tree is built (sorted and linked) by build(), or lazily by the first query.
+ * Once built, queries don't modify anything, and can run concurrently.
  * 
  * @tparam T The type of the payload associated with each interval.
  */
 template <class T>
 class FlatIntervalTree {
 private:
+	static constexpr uint32_t no_parent = UINT32_MAX;
+
 	struct Interval {
 		uint64_t low, high;
 		T payload;
+		uint32_t parent = no_parent; // Index of the innermost interval enclosing this one
 		
 		bool contains(uint64_t point) const { return low <= point && point <= high; }
 		bool contains(const Interval& other) const { return low <= other.low && high >= other.high; }
 	};
 	
 	std::vector<Interval> intervals;
-	bool sorted = false;
+	bool built = false;
 	
-	void ensure_sorted() {
-		if (!sorted) {
-			// Sort by low, then by high (descending) so wider intervals come first
-			std::sort(intervals.begin(), intervals.end(),
-				[](const Interval& a, const Interval& b) {
-					return a.low < b.low || (a.low == b.low && a.high > b.high);
-				});
-			sorted = true;
+public:
+	/**
+	 * @brief Sort the intervals and link each one to the interval enclosing it
+	 */
+	void build() {
+		if (built) return;
+
+		// Sort by low, then by high (descending) so wider intervals come first
+		std::sort(intervals.begin(), intervals.end(),
+			[](const Interval& a, const Interval& b) {
+				return a.low < b.low || (a.low == b.low && a.high > b.high);
+			});
+
+		// Walk the intervals in order, keeping a stack of those which are still open
+		// The innermost open interval which contains the current one is its parent
+		std::vector<uint32_t> open_intervals;
+		for (uint32_t i = 0; i < intervals.size(); i++) {
+			while (!open_intervals.empty() && !intervals[open_intervals.back()].contains(intervals[i])) {
+				open_intervals.pop_back();
+			}
+			intervals[i].parent = open_intervals.empty() ? no_parent : open_intervals.back();
+			open_intervals.push_back(i);
 		}
+		built = true;
 	}
-	
-public:
+
 	void insert(uint64_t low, uint64_t high, T payload) {
 		// TODO(@rail5): Assertions to ensure that our invariants are maintained
 		intervals.push_back({low, high, payload});
-		sorted = false;
+		built = false;
 	}
 	
 	/**
 	 * @brief Find the innermost interval that overlaps a given point.
 	 *
-	 * This function performs a binary search to efficiently locate the innermost interval
-	 * that contains the specified point. If no such interval exists, it returns a default-constructed T.
+	 * This function performs a binary search to locate the last interval starting at or before the point,
+	 * and then follows the links to enclosing intervals until it finds one containing the point.
+	 * If no such interval exists, it returns a default-constructed T.
 	 * 
 	 * @param point The point to query.
 	 * @return T The payload of the innermost overlapping interval, or default-constructed T if none found.
 	 */
 	T find_innermost_overlap(uint64_t point) {
-		ensure_sorted();
+		build();
 		
-		// Binary search for first interval with low <= point
+		// Binary search for first interval with low > point
 		auto it = std::upper_bound(intervals.begin(), intervals.end(), point,
 			[](uint64_t point, const Interval& interval) {
 				return point < interval.low;
@@ -86,18 +113,34 @@ public:
 		
 		if (it == intervals.begin()) return T();
 		
-		// Scan backwards to find innermost (since sorted by low then wide-first)
-		--it;
-		const Interval* best = nullptr;
-		for (; it >= intervals.begin() && it->low <= point; --it) {
-			if (it->contains(point)) {
-				if (!best || it->low > best->low) {
-					best = &*it;
-				}
-			}
+		// The last interval starting at or before the point is the innermost candidate
+		// If it ends before the point, then the innermost interval containing the point (if any) must enclose it
+		uint32_t index = static_cast<uint32_t>(std::distance(intervals.begin(), it) - 1);
+		while (index != no_parent) {
+			if (intervals[index].contains(point)) return intervals[index].payload;
+			index = intervals[index].parent;
+		}
+		return T();
+	}
+
+	size_t size() const {
+		return intervals.size();
+	}
 
-			if (it == intervals.begin()) break; // Prevent underflow/UB
+	/**
+	 * @brief The number of bytes allocated for the intervals (not counting anything the payloads point to)
+	 */
+	size_t memory_usage() const {
+		return intervals.capacity() * sizeof(Interval);
+	}
+
+	/**
+	 * @brief Call the given function on the payload of every interval, in no particular order
+	 */
+	template <class F>
+	void for_each(F&& function) const {
+		for (const auto& interval : intervals) {
+			function(interval.payload);
 		}
-		return best ? best->payload : T();
 	}
 };
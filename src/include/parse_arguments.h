@@ -7,6 +7,7 @@
 #pragma once
 
 #include <iostream>
+#include <charconv>
 #include <string>
 #include <cstring>
 #include <vector>
@@ -47,6 +48,13 @@ constexpr XGetOpt::OptionParser<
 	XGetOpt::Option<'o', "output", "Specify output file (default: run on exit)", XGetOpt::RequiredArgument, "file">,
 	XGetOpt::Option<'b', "target-bash", "Compile to Bash version (default: 5.2)", XGetOpt::RequiredArgument, "version">,
 	XGetOpt::Option<'s', "no-warnings", "Suppress warnings", XGetOpt::NoArgument>,
+	XGetOpt::Option<'V', "verbose", "Report optimizations made at compile time", XGetOpt::NoArgument>,
+	XGetOpt::Option<'O', "optimize", "Optimization level: 0, 1 or 2 (default: 0; 2 if no level is given)", XGetOpt::OptionalArgument, "level">,
+	XGetOpt::Option<1001, "release", "Same as -O2", XGetOpt::NoArgument>,
+	XGetOpt::Option<1002, "remove-unused", "Remove classes and methods which the program never uses", XGetOpt::NoArgument>,
+	XGetOpt::Option<'L', "lazy-load", "Define each class's methods only when one of them is first called", XGetOpt::NoArgument>,
+	XGetOpt::Option<'A', "assoc-objects", "Store each object's data members in a single associative array", XGetOpt::NoArgument>,
+	XGetOpt::Option<'i', "inline-threshold", "Inline methods of up to this many lines (default: 8)", XGetOpt::RequiredArgument, "lines">,
 	XGetOpt::Option<'I', "include", "Add directory to include path", XGetOpt::RequiredArgument, "directory">,
 	XGetOpt::Option<'t', "tokens", "Display tokens from lexer (do not compile program)", XGetOpt::NoArgument>,
 	XGetOpt::Option<'p', "parse-tree", "Display parse tree (do not compile program)", XGetOpt::NoArgument>,
@@ -71,6 +79,12 @@ class Arguments {
 		BashVersion                               m_target_bash_version = {5, 2}; // Default to Bash 5.2
 		std::shared_ptr<std::vector<std::string>> m_include_paths = std::make_shared<std::vector<std::string>>();
 		bool f_suppress_warnings = false;
+		bool f_verbose = false;
+		uint8_t m_optimization_level = 0;
+		bool f_remove_unused_code = false;
+		bool f_lazy_class_loading = false;
+		bool f_associative_objects = false;
+		uint64_t m_inline_threshold = 8;
 		bool f_display_tokens = false;
 		bool f_display_parse_tree = false;
 		bool f_run_on_exit = true;
@@ -217,6 +231,83 @@ class Arguments {
 			return this->f_suppress_warnings;
 		}
 
+		void set_verbose(bool verbose) {
+			this->f_verbose = verbose;
+		}
+		bool verbose() const {
+			return this->f_verbose;
+		}
+
+		/**
+		 * @brief Parses a given optimization level argument and updates the Arguments object accordingly.
+		 *
+		 * Level 0 (the default) compiles every statement as-is.
+		 * Level 1 inlines small methods and runs the peephole passes over the compiled code.
+		 * Level 2 additionally omits runtime checks which are redundant in a correct program (release mode).
+		 * If no level is given (plain -O), level 2 is used.
+		 *
+		 * @param level_arg The optimization level argument string to parse (may be empty)
+		 * @throws std::runtime_error if the argument is not 0, 1 or 2
+		 */
+		void set_optimization_level(std::string_view level_arg) {
+			if (level_arg.empty()) {
+				this->m_optimization_level = 2;
+				return;
+			}
+			if (level_arg.size() != 1 || level_arg[0] < '0' || level_arg[0] > '2') {
+				throw std::runtime_error("Invalid optimization level '" + std::string(level_arg) + "'");
+			}
+			this->m_optimization_level = static_cast<uint8_t>(level_arg[0] - '0');
+		}
+		uint8_t optimization_level() const {
+			return this->m_optimization_level;
+		}
+		bool release_mode() const {
+			return this->m_optimization_level >= 2;
+		}
+
+		void set_remove_unused_code(bool remove_unused_code) {
+			this->f_remove_unused_code = remove_unused_code;
+		}
+		bool remove_unused_code() const {
+			return this->f_remove_unused_code;
+		}
+
+		void set_lazy_class_loading(bool lazy_class_loading) {
+			this->f_lazy_class_loading = lazy_class_loading;
+		}
+		bool lazy_class_loading() const {
+			return this->f_lazy_class_loading;
+		}
+
+		void set_associative_objects(bool associative_objects) {
+			this->f_associative_objects = associative_objects;
+		}
+		bool associative_objects() const {
+			return this->f_associative_objects;
+		}
+
+		/**
+		 * @brief Parses a given inline threshold argument and updates the Arguments object accordingly.
+		 *
+		 * Methods whose compiled bodies are no longer than this many lines may be inlined where they're called.
+		 * Methods marked @inline may be inlined regardless of the threshold.
+		 *
+		 * @param threshold_arg The inline threshold argument string to parse
+		 * @throws std::runtime_error if the argument is not a non-negative integer
+		 */
+		void set_inline_threshold(std::string_view threshold_arg) {
+			uint64_t threshold = 0;
+			auto parsed = std::from_chars(threshold_arg.data(), threshold_arg.data() + threshold_arg.size(), threshold);
+			if (threshold_arg.empty() || parsed.ec != std::errc() || parsed.ptr != threshold_arg.data() + threshold_arg.size()) {
+				throw std::runtime_error("Invalid inline threshold '" + std::string(threshold_arg) + "'");
+			}
+			this->m_inline_threshold = threshold;
+		}
+		uint64_t inline_threshold() const {
+			return this->m_inline_threshold;
+		}
+
 		void set_display_tokens(bool display) {
 			this->f_display_tokens = display;
 		}
@@ -302,6 +393,27 @@ inline Arguments parse_arguments(int argc, char* argv[]) {
 			case 't':
 				args.set_display_tokens(true);
 				break;
+			case 'V':
+				args.set_verbose(true);
+				break;
+			case 'O':
+				args.set_optimization_level(arg.getArgument());
+				break;
+			case 1001: // --release
+				args.set_optimization_level("2");
+				break;
+			case 1002: // --remove-unused
+				args.set_remove_unused_code(true);
+				break;
+			case 'L':
+				args.set_lazy_class_loading(true);
+				break;
+			case 'A':
+				args.set_associative_objects(true);
+				break;
+			case 'i':
+				args.set_inline_threshold(arg.getArgument());
+				break;
 			case 'v':
 				std::cout << program_name << " " << bpp_compiler_version << std::endl << copyright;
 				args.set_exit_early(true);
@@ -310,5 +422,10 @@ inline Arguments parse_arguments(int argc, char* argv[]) {
 		}
 	}
 
+	// Creating a global associative array from inside a function requires `declare -g`
+	if (args.associative_objects() && args.target_bash_version() < BashVersion{4, 2}) {
+		throw std::runtime_error("The associative array object layout (-A) requires a target Bash version of at least 4.2");
+	}
+
 	return args;
 }
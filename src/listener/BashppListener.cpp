@@ -21,7 +21,7 @@ void BashppListener::set_include_paths(std::shared_ptr<std::vector<std::string>>
 	// Ensure that the standard library directory is always included
 	//  and is always the LAST include path
 	//  (so that user-provided include paths can override the standard library if needed)
-	this->include_paths->emplace_back("/usr/lib/bpp/stdlib/");
+	this->include_paths->emplace_back(standard_library_path);
 }
 
 void BashppListener::set_included(bool included) {
@@ -64,6 +64,34 @@ void BashppListener::set_suppress_warnings(bool suppress_warnings) {
 	this->suppress_warnings = suppress_warnings;
 }
 
+void BashppListener::set_verbose(bool verbose) {
+	this->verbose = verbose;
+}
+
+void BashppListener::set_release_mode(bool release_mode) {
+	this->release_mode = release_mode;
+}
+
+void BashppListener::set_optimization_level(uint8_t optimization_level) {
+	this->optimization_level = optimization_level;
+}
+
+void BashppListener::set_lazy_class_loading(bool lazy_class_loading) {
+	this->lazy_class_loading = lazy_class_loading;
+}
+
+void BashppListener::set_remove_unused_code(bool remove_unused_code) {
+	this->remove_unused_code = remove_unused_code;
+}
+
+void BashppListener::set_associative_objects(bool associative_objects) {
+	this->associative_objects = associative_objects;
+}
+
+void BashppListener::set_inline_threshold(uint64_t inline_threshold) {
+	this->inline_threshold = inline_threshold;
+}
+
 void BashppListener::set_target_bash_version(BashVersion target_bash_version) {
 	this->target_bash_version = target_bash_version;
 }
@@ -100,6 +128,10 @@ bool BashppListener::get_lsp_mode() const {
 	return lsp_mode;
 }
 
+bool BashppListener::get_verbose() const {
+	return verbose;
+}
+
 bool BashppListener::get_utf16_mode() const {
 	return utf16_mode;
 }
@@ -108,6 +140,16 @@ int BashppListener::get_exit_code() const {
 	return exit_code;
 }
 
+void BashppListener::report_optimization(const std::shared_ptr<AST::ASTNode>& node, const std::string& message) const {
+	if (!verbose || lsp_mode) return;
+
+	// Internally, we 0-index lines and columns, but for user display we'll 1-index them
+	std::cerr << source_file << ":"
+		<< std::to_string(node->getPosition().line + 1) << ":"
+		<< std::to_string(node->getPosition().column + 1) << ": "
+		<< "note: " << message << std::endl;
+}
+
 bool BashppListener::should_declare_local() const {
 	return in_class || in_method || !bash_function_stack.empty();
 }
@@ -141,6 +183,10 @@ std::shared_ptr<bpp::bpp_code_entity> BashppListener::latest_code_entity() {
 	return latest_entity;
 }
 
-void BashppListener::set_replacement_file_contents(const std::string& file_path, const std::string& contents) {
-	replacement_file_contents[file_path] = contents;
+void BashppListener::set_replacement_file_contents(const std::string& file_path, std::shared_ptr<const std::string> contents) {
+	replacement_file_contents[file_path] = std::move(contents);
+}
+
+void BashppListener::set_parse_cache(std::shared_ptr<AST::ParseCache> parse_cache) {
+	this->parse_cache = std::move(parse_cache);
 }
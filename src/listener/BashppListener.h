@@ -14,6 +14,7 @@
 #include <unordered_map>
 
 #include <AST/Listener/BaseListener.h>
+#include <AST/ParseCache.h>
 
 class BashppListener;
 
@@ -70,6 +71,13 @@ class BashppListener : public AST::BaseListener<BashppListener>, std::enable_sha
 		std::shared_ptr<std::vector<std::string>> include_paths = nullptr;
 
 		bool suppress_warnings = false;
+		bool verbose = false; // Whether to report optimizations made at compile time
+		bool release_mode = false; // Whether to omit runtime checks which are redundant in a correct program
+		uint8_t optimization_level = 0; // 0: no optimizations, 1: inlining and peephole passes, 2: (also) release mode
+		bool lazy_class_loading = false; // Whether to defer defining each class's methods until one of them is first called
+		bool remove_unused_code = false; // Whether to remove classes and methods which the program never uses
+		bool associative_objects = false; // Whether to store each object's data members in a single associative array
+		uint64_t inline_threshold = 8; // The longest method body (in lines) which may be inlined without an @inline hint
 
 		/**
 		 * @var included_files
@@ -108,10 +116,12 @@ class BashppListener : public AST::BaseListener<BashppListener>, std::enable_sha
 		std::shared_ptr<bpp::bpp_program> program;
 
 		bool in_method = false;
+		bool in_constructor = false; // Used to allow assignments to @const data members
 
 		bool in_class = false;
 		std::stack<std::monostate> supershell_stack;
 		std::stack<std::monostate> bash_function_stack;
+		std::stack<std::monostate> loop_condition_stack; // Used to track whether we're inside a loop condition which is evaluated on every iteration
 
 		/**
 		 * @brief Whether the compiler should declare its temporary variables to be 'local' in the generated Bash code
@@ -167,13 +177,32 @@ class BashppListener : public AST::BaseListener<BashppListener>, std::enable_sha
 		 * @brief A map of file paths to replacement contents for those files
 		 * This is used by the language server to provide unsaved changes to the listener
 		 * so that we can report diagnostics/completions/etc based on the unsaved changes
+		 *
+		 * The contents are shared (not copied) between the listeners of included files
 		 * 
 		 */
-		std::unordered_map<std::string, std::string> replacement_file_contents;
+		std::unordered_map<std::string, std::shared_ptr<const std::string>> replacement_file_contents;
+
+		/**
+		 * @var parse_cache
+		 * @brief A cache of already-parsed ASTs for included files
+		 * This is used by the language server so that, when re-analyzing a program,
+		 * included files which haven't changed don't have to be parsed again.
+		 * If null (as in the compiler), included files are always parsed.
+		 */
+		std::shared_ptr<AST::ParseCache> parse_cache = nullptr;
 
 		bool lsp_mode = false; // Whether this listener is just running as part of the language server (i.e., not really compiling anything)
 		bool utf16_mode = false; // If we're in a language server, whether the client has demanded UTF-16 position encoding
 
+		/**
+		 * @brief Report an optimization made at compile time (only if verbose output was requested)
+		 *
+		 * @param node The node which was optimized
+		 * @param message What was done
+		 */
+		void report_optimization(const std::shared_ptr<AST::ASTNode>& node, const std::string& message) const;
+
 		#define show_warning(token, msg) \
 			if (!suppress_warnings) { \
 				bpp::ErrorHandling::Warning _msg(this, token, msg); \
@@ -181,6 +210,11 @@ class BashppListener : public AST::BaseListener<BashppListener>, std::enable_sha
 			}
 
 	public:
+		/**
+		 * @brief The directory holding the Bash++ standard library, which is always the last include path
+		 */
+		static constexpr const char* standard_library_path = "/usr/lib/bpp/stdlib/";
+
 		BashppListener();
 		void set_source_file(std::string source_file);
 		void set_include_paths(std::shared_ptr<std::vector<std::string>> include_paths);
@@ -192,18 +226,27 @@ class BashppListener : public AST::BaseListener<BashppListener>, std::enable_sha
 		void set_output_file(std::string output_file);
 		void set_run_on_exit(bool run_on_exit);
 		void set_suppress_warnings(bool suppress_warnings);
+		void set_verbose(bool verbose);
+		void set_release_mode(bool release_mode);
+		void set_optimization_level(uint8_t optimization_level);
+		void set_lazy_class_loading(bool lazy_class_loading);
+		void set_remove_unused_code(bool remove_unused_code);
+		void set_associative_objects(bool associative_objects);
+		void set_inline_threshold(uint64_t inline_threshold);
 		void set_target_bash_version(BashVersion target_bash_version);
 		void set_arguments(std::vector<char*> arguments);
 		void set_lsp_mode(bool lsp_mode);
 		void set_utf16_mode(bool utf16_mode);
 
-		void set_replacement_file_contents(const std::string& file_path, const std::string& contents);
+		void set_replacement_file_contents(const std::string& file_path, std::shared_ptr<const std::string> contents);
+		void set_parse_cache(std::shared_ptr<AST::ParseCache> parse_cache);
 
 		std::shared_ptr<bpp::bpp_program> get_program() const;
 		std::shared_ptr<std::set<std::string>> get_included_files() const;
 		const std::vector<std::string>& get_include_stack() const;
 		std::string get_source_file() const;
 		bool get_lsp_mode() const;
+		bool get_verbose() const;
 		bool get_utf16_mode() const;
 
 		int get_exit_code() const;
@@ -31,11 +31,17 @@ void BashppListener::exitBashArithmeticForStatement(std::shared_ptr<AST::BashAri
 	bpp_assert(topmost_entity_is<bpp::bpp_code_entity>(), "Current code entity not found in the entity stack");
 	auto current_code_entity = std::static_pointer_cast<bpp::bpp_code_entity>(entity_stack.top());
 
+	bpp::ir::hoisted_loop loop = program->hoist_loop_invariants(for_statement->get_header_code(),
+		for_statement->get_pre_code() + for_statement->get_code() + for_statement->get_post_code(),
+		for_statement->get_containing_class().lock());
+
 	current_code_entity->add_code_to_previous_line(for_statement->get_header_pre_code());
+	current_code_entity->add_code_to_previous_line(loop.preheader);
 	current_code_entity->add_code_to_next_line("done\n");
 	current_code_entity->add_code_to_next_line(for_statement->get_header_post_code());
+	current_code_entity->add_code_to_next_line(loop.exit_code);
 	current_code_entity->add_code_to_previous_line(for_statement->get_header_code());
-	current_code_entity->add_code(for_statement->get_pre_code() + for_statement->get_code() + for_statement->get_post_code());
+	current_code_entity->add_code(loop.body);
 
 	program->mark_entity(
 		source_file,
@@ -55,6 +61,7 @@ void BashppListener::enterBashArithmeticForCondition(std::shared_ptr<AST::BashAr
 	for_condition->set_containing_class(for_statement->get_containing_class());
 	for_condition->inherit(for_statement);
 	entity_stack.push(for_condition);
+	loop_condition_stack.push({});
 }
 
 void BashppListener::exitBashArithmeticForCondition(std::shared_ptr<AST::BashArithmeticForCondition> /*node*/) {
@@ -62,6 +69,7 @@ void BashppListener::exitBashArithmeticForCondition(std::shared_ptr<AST::BashAri
 	auto condition = std::static_pointer_cast<bpp::bpp_string>(entity_stack.top());
 
 	entity_stack.pop();
+	loop_condition_stack.pop();
 
 	bpp_assert(topmost_entity_is<bpp::bash_for_or_select>(), "For/select statement entity not found in the entity stack");
 	auto for_statement = std::static_pointer_cast<bpp::bash_for_or_select>(entity_stack.top());
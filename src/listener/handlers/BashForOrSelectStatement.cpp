@@ -52,11 +52,18 @@ void BashppListener::exitBashForStatement(std::shared_ptr<AST::BashForStatement>
 	for_loop->destruct_local_objects(program);
 	for_loop->flush_code_buffers();
 
+	// The header's post-code ends up at the top of the loop body, so it counts as part of the loop
+	bpp::ir::hoisted_loop loop = program->hoist_loop_invariants(for_loop->get_header_code() + for_loop->get_header_post_code(),
+		for_loop->get_pre_code() + for_loop->get_code() + for_loop->get_post_code(),
+		for_loop->get_containing_class().lock());
+
 	current_code_entity->add_code_to_previous_line(for_loop->get_header_pre_code());
+	current_code_entity->add_code_to_previous_line(loop.preheader);
 	current_code_entity->add_code_to_next_line(for_loop->get_header_post_code());
 	current_code_entity->add_code(for_loop->get_header_code());
-	current_code_entity->add_code(for_loop->get_pre_code() + for_loop->get_code() + for_loop->get_post_code());
+	current_code_entity->add_code(loop.body);
 	current_code_entity->add_code("done ", false);
+	current_code_entity->add_code_to_next_line(loop.exit_code);
 
 	program->mark_entity(
 		source_file,
@@ -47,12 +47,18 @@ void BashppListener::exitBashWhileStatement(std::shared_ptr<AST::BashWhileStatem
 	while_statement->destruct_local_objects(program);
 	while_statement->flush_code_buffers();
 
+	// Resolve references which can't change during the loop just once, before it
+	bpp::ir::hoisted_loop loop = program->hoist_loop_invariants(while_statement->get_condition()->get_code(),
+		while_statement->get_pre_code() + "\n" + while_statement->get_code(),
+		while_statement->get_containing_class().lock());
+
 	current_code_entity->add_code_to_previous_line(while_statement->get_condition()->get_pre_code());
+	current_code_entity->add_code_to_previous_line(loop.preheader);
 	current_code_entity->add_code_to_next_line(while_statement->get_condition()->get_post_code());
+	current_code_entity->add_code_to_next_line(loop.exit_code);
 
 	current_code_entity->add_code("while " + while_statement->get_condition()->get_code() + "; do\n"
-		+ while_statement->get_pre_code() + "\n"
-		+ while_statement->get_code() + "\ndone", false);
+		+ loop.body + "\ndone", false);
 
 	program->mark_entity(
 		source_file,
@@ -95,14 +101,20 @@ void BashppListener::exitBashUntilStatement(std::shared_ptr<AST::BashUntilStatem
 	until_statement->destruct_local_objects(program);
 	until_statement->flush_code_buffers();
 
+	// Resolve references which can't change during the loop just once, before it
+	bpp::ir::hoisted_loop loop = program->hoist_loop_invariants(until_statement->get_condition()->get_code(),
+		until_statement->get_pre_code() + "\n" + until_statement->get_code(),
+		until_statement->get_containing_class().lock());
+
 	current_code_entity->add_code_to_previous_line(until_statement->get_condition()->get_pre_code());
+	current_code_entity->add_code_to_previous_line(loop.preheader);
 	current_code_entity->add_code_to_next_line(until_statement->get_condition()->get_post_code());
+	current_code_entity->add_code_to_next_line(loop.exit_code);
 
 	// If we're targeting Bash 5.2 or earlier, extra logic is needed to re-evaluate supershells with each iteration of the loop
 	// If we're targeting Bash 5.3 or later, we can use the new native implementation
 	current_code_entity->add_code("until " + until_statement->get_condition()->get_code() + "; do\n"
-		+ until_statement->get_pre_code() + "\n"
-		+ until_statement->get_code() + "\ndone", false);
+		+ loop.body + "\ndone", false);
 
 	program->mark_entity(
 		source_file,
@@ -125,6 +137,7 @@ void BashppListener::enterBashWhileOrUntilCondition(std::shared_ptr<AST::BashWhi
 	loop->set_condition(condition);
 
 	entity_stack.push(condition);
+	loop_condition_stack.push({});
 }
 
 void BashppListener::exitBashWhileOrUntilCondition(std::shared_ptr<AST::BashWhileOrUntilCondition> /*node*/) {
@@ -132,5 +145,6 @@ void BashppListener::exitBashWhileOrUntilCondition(std::shared_ptr<AST::BashWhil
 	auto condition = std::static_pointer_cast<bpp::bash_while_or_until_condition>(entity_stack.top());
 
 	entity_stack.pop();
+	loop_condition_stack.pop();
 }
 
@@ -30,6 +30,7 @@ void BashppListener::enterConstructorDefinition(std::shared_ptr<AST::Constructor
 	constructor->set_overridable(true); // Constructors are overridable, but not virtual
 	constructor->inherit(program);
 	entity_stack.push(constructor);
+	in_constructor = true;
 
 	constructor->set_definition_position(
 		source_file,
@@ -45,7 +46,7 @@ void BashppListener::enterConstructorDefinition(std::shared_ptr<AST::Constructor
 		auto parent_constructor = parent_class->get_method_UNSAFE("__constructor");
 		if (parent_constructor != nullptr) {
 			// Call the parent constructor
-			bpp::code_segment parent_constructor_call = generate_constructor_call_code("${__this}", parent_class);
+			bpp::code_segment parent_constructor_call = generate_constructor_call_code("${__this}", parent_class, program);
 			constructor->add_code(parent_constructor_call.full_code() + "\n");
 		}
 	}
@@ -56,6 +57,7 @@ void BashppListener::exitConstructorDefinition(std::shared_ptr<AST::ConstructorD
 	auto constructor = std::static_pointer_cast<bpp::bpp_method>(entity_stack.top());
 
 	entity_stack.pop();
+	in_constructor = false;
 
 	// Call destructors for any objects created in the constructor before we exit it
 	constructor->destruct_local_objects(program);
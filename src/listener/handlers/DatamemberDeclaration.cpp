@@ -34,6 +34,8 @@ void BashppListener::enterDatamemberDeclaration(std::shared_ptr<AST::DatamemberD
 		throw bpp::ErrorHandling::SyntaxError(this, node, "Member declaration outside of class");
 	}
 
+	new_datamember->set_const(node->CONST());
+
 	/**
 	 * This will either be:
 	 * 	1. A primitive
@@ -7,6 +7,7 @@
 #include <listener/BashppListener.h>
 
 #include <bpp_include/bpp_dynamic_cast_statement.h>
+#include <bpp_include/bpp_class.h>
 
 void BashppListener::enterDynamicCast(std::shared_ptr<AST::DynamicCast> node) {
 	/**
@@ -24,6 +25,8 @@ void BashppListener::enterDynamicCast(std::shared_ptr<AST::DynamicCast> node) {
 	 * 
 	 * This statement performs a runtime check to verify the cast is valid
 	 * And substitutes either the address of the cast object or the @nullptr value
+	 *
+	 * Where the classes involved are known at compile time, the check is done (partially or entirely) by the compiler instead
 	*/
 
 	std::shared_ptr<bpp::bpp_code_entity> current_code_entity = std::dynamic_pointer_cast<bpp::bpp_code_entity>(entity_stack.top());
@@ -53,7 +56,24 @@ void BashppListener::exitDynamicCast(std::shared_ptr<AST::DynamicCast> node) {
 		throw bpp::ErrorHandling::SyntaxError(this, node, "Dynamic cast target not specified");
 	}
 
-	bpp::code_segment dynamic_cast_code = generate_dynamic_cast_code(dynamic_cast_entity->get_code(), dynamic_cast_entity->get_cast_to(), program);
+	bpp::code_segment dynamic_cast_code;
+
+	// Can we tell at compile time whether the cast will succeed?
+	// If we know the class being cast to, and we know the class of the object being cast (or at least a class it must derive from),
+	// then either the cast can't possibly succeed, or it can only fail if there's no object there at all
+	std::shared_ptr<bpp::bpp_class> cast_to_class = dynamic_cast_entity->get_cast_to_class();
+	std::shared_ptr<bpp::bpp_class> operand_class = dynamic_cast_entity->get_operand_class();
+	if (cast_to_class != nullptr && operand_class != nullptr && operand_class->is_derived_from(cast_to_class)) {
+		dynamic_cast_code = bpp::generate_null_check_code(dynamic_cast_entity->get_code(), program);
+		report_optimization(node, "@dynamic_cast<" + cast_to_class->get_name() + "> of an object of class "
+			+ operand_class->get_name() + " resolved at compile time (reduced to a null check)");
+	} else if (cast_to_class != nullptr && operand_class != nullptr && dynamic_cast_entity->operand_type_is_exact()) {
+		dynamic_cast_code.code = bpp::bpp_nullptr;
+		report_optimization(node, "@dynamic_cast<" + cast_to_class->get_name() + "> of an object of class "
+			+ operand_class->get_name() + " resolved at compile time (always fails)");
+	} else {
+		dynamic_cast_code = generate_dynamic_cast_code(dynamic_cast_entity->get_code(), dynamic_cast_entity->get_cast_to(), program);
+	}
 
 	current_code_entity->add_code_to_previous_line(dynamic_cast_entity->get_pre_code());
 	current_code_entity->add_code_to_previous_line(dynamic_cast_code.pre_code);
@@ -45,6 +45,7 @@ void BashppListener::exitDynamicCastTarget(std::shared_ptr<AST::DynamicCastTarge
 		if (cast_class == nullptr) {
 			show_warning(node->TARGETTYPE().value(), "Class not found: " + class_name + ". This cast may fail at runtime.");
 		} else {
+			dynamic_cast_entity->set_cast_to_class(cast_class);
 			cast_class->add_reference(
 				source_file,
 				node->TARGETTYPE().value().getLine(),
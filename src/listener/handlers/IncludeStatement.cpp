@@ -105,10 +105,18 @@ void BashppListener::enterIncludeStatement(std::shared_ptr<AST::IncludeStatement
 	listener.set_included_from(this);
 	listener.set_run_on_exit(false);
 	listener.set_suppress_warnings(suppress_warnings);
+	listener.set_verbose(verbose);
+	listener.set_release_mode(release_mode);
+	listener.set_optimization_level(optimization_level);
+	listener.set_lazy_class_loading(lazy_class_loading);
+	listener.set_remove_unused_code(remove_unused_code);
+	listener.set_associative_objects(associative_objects);
+	listener.set_inline_threshold(inline_threshold);
 	listener.set_target_bash_version(target_bash_version);
 	for (const auto& pair : replacement_file_contents) {
 		listener.set_replacement_file_contents(pair.first, pair.second);
 	}
+	listener.set_parse_cache(parse_cache);
 
 	if (!dynamic_linking) {
 		// If we're linking statically, copy the compiled code from the included file to the current program
@@ -120,21 +128,41 @@ void BashppListener::enterIncludeStatement(std::shared_ptr<AST::IncludeStatement
 	}
 	listener.set_output_file("");
 
-	// Create a new parser
-	AST::BashppParser parser;
-	parser.setUTF16Mode(utf16_mode);
-	std::vector<std::string> new_include_stack = this->include_stack;
-	new_include_stack.push_back(source_file);
-	parser.setIncludeChain(new_include_stack);
-	
+	// If we have a parse cache, and this file hasn't changed since it was last parsed,
+	// we can reuse the old AST instead of parsing the file again
+	std::shared_ptr<const std::string> file_contents = nullptr;
+	std::shared_ptr<AST::Program> tree = nullptr;
 	if (replacement_file_contents.contains(full_path)) {
-		parser.setInputFromStringContents(replacement_file_contents[full_path]);
-	} else {
-		parser.setInputFromFilePath(full_path);
+		file_contents = replacement_file_contents[full_path];
+	} else if (parse_cache != nullptr) {
+		file_contents = AST::ParseCache::read_file(full_path);
+	}
+
+	if (parse_cache != nullptr) {
+		tree = parse_cache->lookup(file_contents, utf16_mode);
 	}
 
-	auto tree = parser.program();
-	listener.set_parser_errors(parser.get_errors());
+	if (tree == nullptr) {
+		// Create a new parser
+		AST::BashppParser parser;
+		parser.setUTF16Mode(utf16_mode);
+		std::vector<std::string> new_include_stack = this->include_stack;
+		new_include_stack.push_back(source_file);
+		parser.setIncludeChain(new_include_stack);
+
+		if (file_contents != nullptr) {
+			parser.setInputFromStringContents(file_contents);
+		} else {
+			parser.setInputFromFilePath(full_path);
+		}
+
+		tree = parser.program();
+		listener.set_parser_errors(parser.get_errors());
+
+		if (parse_cache != nullptr && tree != nullptr && parser.get_errors().empty()) {
+			parse_cache->store(file_contents, utf16_mode, tree);
+		}
+	}
 	if (tree == nullptr) {
 		auto nodeCopy = source_path;
 		nodeCopy.setValue(nodeCopy.getValue() + "  "); // HACK
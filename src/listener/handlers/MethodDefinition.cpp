@@ -59,6 +59,9 @@ void BashppListener::enterMethodDefinition(std::shared_ptr<AST::MethodDefinition
 		method->set_virtual(true);
 	}
 
+	// Inline?
+	method->set_inline_hint(node->INLINE());
+
 	if (!current_class->add_method(method)) {
 		throw bpp::ErrorHandling::SyntaxError(this, node->NAME(), "Method redefinition: " + method->get_name());
 	}
@@ -138,6 +141,7 @@ void BashppListener::exitMethodDefinition(std::shared_ptr<AST::MethodDefinition>
 	// Call destructors for any objects created in the method before we exit it
 	method->destruct_local_objects(program);
 	method->flush_code_buffers();
+	method->set_finalized(true);
 	in_method = false;
 
 	program->mark_entity(
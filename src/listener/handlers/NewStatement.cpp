@@ -49,6 +49,7 @@ void BashppListener::enterNewStatement(std::shared_ptr<AST::NewStatement> node)
 	std::string tmp_storage_var = "__newAssignment" + std::to_string(program->get_assignment_counter());
 	current_code_entity->add_code_to_previous_line(tmp_storage_var + "=" + new_code.code + "\n");
 	current_code_entity->add_code_to_next_line("unset " + tmp_storage_var + "\n");
+	program->add_temporary(tmp_storage_var);
 	program->increment_assignment_counter();
 
 	// Call the constructor if it exists
@@ -56,8 +57,8 @@ void BashppListener::enterNewStatement(std::shared_ptr<AST::NewStatement> node)
 	if (constructor_method != nullptr) {
 		// The 'new' function was called in a supershell, and its output was stored in the variable given in new_code.code
 		// This output is the pointer to the new object
-		// Call the constructor with this pointer as the argument
-		auto constructor_code = generate_constructor_call_code(tmp_storage_var, new_class);
+		// Call the constructor with the address it holds as the argument
+		auto constructor_code = generate_constructor_call_code("${" + tmp_storage_var + "}", new_class, program);
 		current_code_entity->add_code_to_previous_line(constructor_code.full_code());
 	}
 
@@ -9,6 +9,7 @@
 #include <bpp_include/bpp_object_assignment.h>
 #include <bpp_include/bpp_entity.h>
 #include <bpp_include/bpp_class.h>
+#include <bpp_include/bpp_datamember.h>
 #include <bpp_include/bpp_program.h>
 
 void BashppListener::enterObjectAssignment(std::shared_ptr<AST::ObjectAssignment> /*node*/) {
@@ -26,6 +27,15 @@ void BashppListener::exitObjectAssignment(std::shared_ptr<AST::ObjectAssignment>
 	entity_stack.pop();
 	context_expectations_stack.pop();
 
+	// @const data members can only be assigned by the constructor of the class which declares them
+	auto assigned_datamember = std::dynamic_pointer_cast<bpp::bpp_datamember>(object_assignment->get_lvalue_object());
+	if (assigned_datamember != nullptr
+		&& assigned_datamember->is_const()
+		&& !(in_constructor && assigned_datamember->get_containing_class().lock() == object_assignment->get_containing_class().lock())
+	) {
+		throw bpp::ErrorHandling::SyntaxError(this, node, assigned_datamember->get_name() + " is @const, and can only be assigned in the constructor of its class");
+	}
+
 	bool is_nonprimitive_copy = object_assignment->lvalue_is_nonprimitive() && object_assignment->rvalue_is_nonprimitive();
 
 	if (is_nonprimitive_copy) {
@@ -54,6 +64,24 @@ void BashppListener::exitObjectAssignment(std::shared_ptr<AST::ObjectAssignment>
 		method_call += copy_call.code + " " + object_assignment->get_rvalue() + "\n";
 		method_call += copy_call.post_code + "\n";
 
+		// The classes were checked above, so the copy is valid as long as the lvalue object really is of its declared class
+		// The only case in which it might not be: the lvalue is a dereferenced pointer to an object of a derived class
+		// Only then do we have to check the types at runtime
+		if (object_assignment->lvalue_is_dereferenced()) {
+			auto typeof_code = bpp::generate_typeof_code(object_assignment->get_lvalue(), get_program());
+			auto dynamic_cast_code = bpp::generate_dynamic_cast_code(object_assignment->get_rvalue(), typeof_code.code, get_program());
+			method_call = typeof_code.pre_code
+				+ dynamic_cast_code.pre_code
+				+ "if [[ " + dynamic_cast_code.code + " == " + bpp::bpp_nullptr + " ]]; then\n"
+				+ "	>&2 echo \"Bash++: Error: " + typeof_code.code + ": Attempted to copy between incompatible types.\"\n"
+				+ "	false\n"
+				+ "else\n"
+				+ method_call
+				+ "fi\n"
+				+ dynamic_cast_code.post_code
+				+ typeof_code.post_code;
+		}
+
 		std::shared_ptr<bpp::bpp_code_entity> current_code_entity = std::dynamic_pointer_cast<bpp::bpp_code_entity>(entity_stack.top());
 		if (current_code_entity != nullptr) {
 			current_code_entity->add_code_to_previous_line(object_assignment->get_pre_code());
@@ -67,6 +95,17 @@ void BashppListener::exitObjectAssignment(std::shared_ptr<AST::ObjectAssignment>
 		throw bpp::ErrorHandling::SyntaxError(this, node, "Cannot assign a primitive value to a nonprimitive object");
 	}
 
+	// In the associative array layout, only data members declared as arrays are stored as arrays
+	auto lvalue_datamember = std::dynamic_pointer_cast<bpp::bpp_datamember>(object_assignment->get_lvalue_object());
+	if (object_assignment->rvalue_is_array()
+		&& program->get_associative_objects()
+		&& lvalue_datamember != nullptr
+		&& !lvalue_datamember->is_array()
+	) {
+		throw bpp::ErrorHandling::SyntaxError(this, node, lvalue_datamember->get_name() + " was not declared as an array\n"
+			"With the associative array object layout (-A), array data members must be declared with an array value (e.g., '@public " + lvalue_datamember->get_name() + "=()')");
+	}
+
 	std::string object_assignment_lvalue = object_assignment->get_lvalue();
 	std::string object_assignment_rvalue = object_assignment->get_rvalue();
 	std::string pre_objectassignment_code = object_assignment->get_pre_code();
@@ -74,6 +113,10 @@ void BashppListener::exitObjectAssignment(std::shared_ptr<AST::ObjectAssignment>
 
 	std::string assignment_variable_name = "____assignment" + std::to_string(program->get_assignment_counter());
 	program->increment_assignment_counter();
+	if (!object_assignment->rvalue_is_array()) {
+		// Arrays are left out: an unset before a plain assignment to an array isn't dead, since the assignment only replaces the first element
+		program->add_temporary(assignment_variable_name);
+	}
 
 	pre_objectassignment_code += assignment_variable_name + "=" + object_assignment_rvalue + "\n";
 	post_objectassignment_code += "unset " + assignment_variable_name + "\n";
@@ -84,6 +127,9 @@ void BashppListener::exitObjectAssignment(std::shared_ptr<AST::ObjectAssignment>
 
 	if (object_assignment->rvalue_is_array()) {
 		object_assignment_code = "eval \"" + object_assignment_lvalue + assignment_operator + "(\\\"\\${" + assignment_variable_name + "[@]}\\\")\"\n";
+	} else if (program->get_associative_objects()) {
+		// The lvalue is an array element (e.g., ${__this}[member]), which mustn't be left open to pathname expansion
+		object_assignment_code = "eval \"" + object_assignment_lvalue + assignment_operator + "\\$" + assignment_variable_name + "\"\n";
 	} else {
 		object_assignment_code = "eval " + object_assignment_lvalue + assignment_operator + "\\$" + assignment_variable_name + "\n";
 	}
@@ -15,6 +15,7 @@
 #include <bpp_include/bpp_object_assignment.h>
 #include <bpp_include/bpp_value_assignment.h>
 #include <bpp_include/bpp_delete_statement.h>
+#include <bpp_include/bpp_program.h>
 
 void BashppListener::enterObjectReference(std::shared_ptr<AST::ObjectReference> node) {
 	/**
@@ -164,6 +165,24 @@ void BashppListener::exitObjectReference(std::shared_ptr<AST::ObjectReference> n
 		object = dereferenced_object;
 	}
 
+	// Whether the class of the object a method is called on is known exactly at compile time
+	// (i.e., the object is neither a pointer nor reached through one, so it can't be an object of a derived class)
+	bool exact_class_known = false;
+	if (method != nullptr && !pointer_dereference && ids.size() > 1) {
+		std::deque<std::string> object_ids;
+		for (size_t i = 0; i + 1 < ids.size(); i++) {
+			object_ids.push_back(ids[i].getValue());
+		}
+		auto called_on = std::dynamic_pointer_cast<bpp::bpp_object>(bpp::resolve_reference(
+			source_file,
+			current_code_entity,
+			&object_ids,
+			should_declare_local(),
+			program
+		).entity);
+		exact_class_known = called_on != nullptr && !called_on->is_pointer();
+	}
+
 	// Next, determine: Have we referenced a non-primitive object in a place where a primitive is expected?
 	// If so, we need to replace the referenced entity with the object's .toPrimitive method entity
 	if (reference_type == bpp::reference_type::ref_object
@@ -209,6 +228,7 @@ void BashppListener::exitObjectReference(std::shared_ptr<AST::ObjectReference> n
 		);
 
 		reference_type = bpp::reference_type::ref_method;
+		exact_class_known = !pointer_dereference;
 		object = nullptr;
 		method = std::dynamic_pointer_cast<bpp::bpp_method>(ref.entity);
 		if (method == nullptr) {
@@ -221,7 +241,33 @@ void BashppListener::exitObjectReference(std::shared_ptr<AST::ObjectReference> n
 	object_reference_entity->add_code_to_next_line(ref.reference_code.post_code);
 
 	// 1. Is it a method?
-	if (reference_type == bpp::reference_type::ref_method) {
+	// If it's an rvalue call to a method we can pin down at compile time, try to inline it rather than running it in a supershell
+	// Virtual methods can be pinned down if we know the object's exact class, so long as that class is complete (i.e., it isn't the class we're in)
+	// Loop conditions are never inlined: the inlined body would be placed before the loop, and only run once
+	std::optional<bpp::code_segment> inlined_call;
+	if (reference_type == bpp::reference_type::ref_method && !lvalue && !object_address && loop_condition_stack.empty()
+		&& program->get_optimization_level() >= 1
+	) {
+		bool statically_resolved = !method->is_virtual()
+			|| force_static_resolution
+			|| (exact_class_known && ref.class_containing_the_method != current_class);
+		if (statically_resolved) {
+			if (ref.reference_code.code == "__this") ref.reference_code.code = "${__this}";
+			inlined_call = bpp::generate_inline_method_call_code(
+				ref.reference_code.code,
+				method,
+				ref.class_containing_the_method,
+				program
+			);
+		}
+	}
+
+	if (inlined_call.has_value()) {
+		object_reference_entity->add_code_to_previous_line(inlined_call->pre_code);
+		object_reference_entity->add_code_to_next_line(inlined_call->post_code);
+		object_reference_entity->add_code(inlined_call->code);
+		report_optimization(node, "Call to @" + ref.class_containing_the_method->get_name() + "." + method->get_name() + " inlined");
+	} else if (reference_type == bpp::reference_type::ref_method) {
 		if (ref.reference_code.code == "__this") ref.reference_code.code = "${__this}"; // Kind of a hack to ensure that "this" references work correctly
 		auto method_call = bpp::generate_method_call_code(
 			ref.reference_code.code,
@@ -284,6 +330,7 @@ void BashppListener::exitObjectReference(std::shared_ptr<AST::ObjectReference> n
 		if (object_assignment_entity != nullptr && !object->is_pointer()) {
 			object_assignment_entity->set_lvalue_object(object);
 			object_assignment_entity->set_lvalue_nonprimitive(true);
+			object_assignment_entity->set_lvalue_dereferenced(pointer_dereference);
 			object_assignment_entity->set_lvalue(ref.reference_code.code);
 			object_reference_entity->add_code(ref.reference_code.code);
 		}
@@ -318,6 +365,12 @@ void BashppListener::exitObjectReference(std::shared_ptr<AST::ObjectReference> n
 		// It is a disgusting hack to handle array indices in object references
 		std::string counting = node->hasHashkey() ? "#" : "";		
 		if (object_reference_entity->has_array_index()) {
+			// In the associative array layout, only data members declared as arrays are stored as arrays
+			auto indexed_datamember = std::dynamic_pointer_cast<bpp::bpp_datamember>(ref.entity);
+			if (program->get_associative_objects() && indexed_datamember != nullptr && !indexed_datamember->is_array()) {
+				throw bpp::ErrorHandling::SyntaxError(this, node, indexed_datamember->get_name() + " was not declared as an array\n"
+					"With the associative array object layout (-A), array data members must be declared with an array value (e.g., '@public " + indexed_datamember->get_name() + "=()')");
+			}
 			// Special procedure needed to handle array indices
 			std::string local_decl = should_declare_local() ? "local " : "";
 			std::string indirection = ref.created_second_temporary_variable ? "!" : "";
@@ -352,6 +405,7 @@ void BashppListener::exitObjectReference(std::shared_ptr<AST::ObjectReference> n
 
 			object_reference_entity->add_code_to_previous_line(local_decl + temporary_variable_lvalue + "=" + temporary_variable_rvalue + "\n");
 			object_reference_entity->add_code_to_next_line("unset " + temporary_variable_lvalue + "\n");
+			program->add_temporary(temporary_variable_lvalue);
 
 			temporary_variable_rvalue = "${" + ref.reference_code.code + "____arrayIndexString}";
 
@@ -364,6 +418,7 @@ void BashppListener::exitObjectReference(std::shared_ptr<AST::ObjectReference> n
 				temporary_variable_lvalue = ref.reference_code.code + "____arrayIndex";
 				object_reference_entity->add_code_to_previous_line("eval " + local_decl + temporary_variable_lvalue + "=\"" + temporary_variable_rvalue + "\"\n");
 				object_reference_entity->add_code_to_next_line("unset " + temporary_variable_lvalue + "\n");
+				program->add_temporary(temporary_variable_lvalue);
 			}
 
 			ref.reference_code.code = temporary_variable_lvalue;
@@ -381,12 +436,28 @@ void BashppListener::exitObjectReference(std::shared_ptr<AST::ObjectReference> n
 			indirection_level--; // Lvalue assignments reduce indirection level by 1
 			encased_reference_code = bpp::get_encased_ref(ref.reference_code.code, indirection_level);
 			object_assignment_entity->set_lvalue(encased_reference_code);
+			object_assignment_entity->set_lvalue_object(ref.entity);
 			object_assignment_entity->set_lvalue_nonprimitive(false);
 		}
 
 		object_reference_entity->add_code(encased_reference_code);
 	}
 
+	// If this is the operand of a @dynamic_cast or @typeof, tell it what we know about the type of the object
+	auto type_inspection_entity = std::dynamic_pointer_cast<bpp::bpp_type_inspection>(current_code_entity);
+	if (type_inspection_entity != nullptr
+		&& reference_type == bpp::reference_type::ref_object
+		&& object != nullptr
+		&& !object_reference_entity->has_array_index()
+		&& !node->hasHashkey()
+	) {
+		if (object_address && !object->is_pointer()) {
+			type_inspection_entity->set_operand(object->get_class(), object_reference_entity->get_code(), true);
+		} else if (!object_address && object->is_pointer()) {
+			type_inspection_entity->set_operand(object->get_class(), object_reference_entity->get_code(), false);
+		}
+	}
+
 	current_code_entity->add_code_to_previous_line(object_reference_entity->get_pre_code());
 	current_code_entity->add_code_to_next_line(object_reference_entity->get_post_code());
 	current_code_entity->add_code(object_reference_entity->get_code());
@@ -16,6 +16,12 @@ void BashppListener::enterProgram(std::shared_ptr<AST::Program> node) {
 	program->set_output_stream(code_buffer);
 	program->set_include_paths(include_paths);
 	program->set_target_bash_version(target_bash_version);
+	program->set_release_mode(release_mode);
+	program->set_optimization_level(optimization_level);
+	program->set_lazy_class_loading(lazy_class_loading);
+	program->set_remove_unused_code(remove_unused_code);
+	program->set_associative_objects(associative_objects);
+	program->set_inline_threshold(inline_threshold);
 
 	if (!included) {
 		program->set_main_source_file(source_file);
@@ -46,7 +52,7 @@ void BashppListener::enterProgram(std::shared_ptr<AST::Program> node) {
 	);
 }
 
-void BashppListener::exitProgram(std::shared_ptr<AST::Program> /*node*/) {
+void BashppListener::exitProgram(std::shared_ptr<AST::Program> node) {
 	program->flush_code_buffers();
 
 	entity_stack.pop();
@@ -68,7 +74,21 @@ void BashppListener::exitProgram(std::shared_ptr<AST::Program> /*node*/) {
 	// Copy the contents of the code stream to the output stream
 	std::shared_ptr<std::ostringstream> cd = std::dynamic_pointer_cast<std::ostringstream>(code_buffer);
 	if (cd != nullptr) {
-		*output_stream << cd->str() << std::flush;
+		bpp::bpp_program::dead_code_statistics statistics;
+		*output_stream << program->link_deferred_classes(program->optimize_code(cd->str()), &statistics) << std::flush;
+		const auto& peephole_statistics = program->get_optimization_statistics();
+		if (!peephole_statistics.empty()) {
+			report_optimization(node,
+				"Removed " + std::to_string(peephole_statistics.removed_assignments) + " redundant assignment(s) and "
+				+ std::to_string(peephole_statistics.removed_unsets) + " redundant unset(s); merged "
+				+ std::to_string(peephole_statistics.merged_commands) + " command(s) into others; hoisted "
+				+ std::to_string(peephole_statistics.hoisted_assignments) + " loop-invariant assignment(s) out of loops");
+		}
+		if (program->get_remove_unused_code()) {
+			report_optimization(node,
+				"Removed " + std::to_string(statistics.removed_classes) + " unused class(es) and "
+				+ std::to_string(statistics.removed_functions) + " unused method(s)");
+		}
 		cd->clear();
 	}
 	
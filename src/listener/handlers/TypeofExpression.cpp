@@ -6,7 +6,8 @@
 
 #include <listener/BashppListener.h>
 
-#include <bpp_include/bpp_string.h>
+#include <bpp_include/bpp_dynamic_cast_statement.h>
+#include <bpp_include/bpp_class.h>
 
 void BashppListener::enterTypeofExpression(std::shared_ptr<AST::TypeofExpression> node) {
 	/**
@@ -20,7 +21,7 @@ void BashppListener::enterTypeofExpression(std::shared_ptr<AST::TypeofExpression
 		throw bpp::ErrorHandling::SyntaxError(this, node, "Typeof expression outside of code entity");
 	}
 
-	std::shared_ptr<bpp::bpp_string> typeof_entity = std::make_shared<bpp::bpp_string>();
+	std::shared_ptr<bpp::bpp_typeof_expression> typeof_entity = std::make_shared<bpp::bpp_typeof_expression>();
 	typeof_entity->set_containing_class(current_code_entity->get_containing_class());
 	typeof_entity->inherit(current_code_entity);
 
@@ -28,9 +29,9 @@ void BashppListener::enterTypeofExpression(std::shared_ptr<AST::TypeofExpression
 	typeof_stack.push({});
 }
 
-void BashppListener::exitTypeofExpression(std::shared_ptr<AST::TypeofExpression> /*node*/) {
-	bpp_assert(topmost_entity_is<bpp::bpp_string>(), "Typeof context was not found in the entity stack");
-	auto typeof_entity = std::static_pointer_cast<bpp::bpp_string>(entity_stack.top());
+void BashppListener::exitTypeofExpression(std::shared_ptr<AST::TypeofExpression> node) {
+	bpp_assert(topmost_entity_is<bpp::bpp_typeof_expression>(), "Typeof context was not found in the entity stack");
+	auto typeof_entity = std::static_pointer_cast<bpp::bpp_typeof_expression>(entity_stack.top());
 
 	entity_stack.pop();
 	typeof_stack.pop();
@@ -38,7 +39,16 @@ void BashppListener::exitTypeofExpression(std::shared_ptr<AST::TypeofExpression>
 	bpp_assert(topmost_entity_is<bpp::bpp_code_entity>(), "Current code entity was not found in the entity stack");
 	auto current_code_entity = std::static_pointer_cast<bpp::bpp_code_entity>(entity_stack.top());
 
-	bpp::code_segment typeof_code = bpp::generate_typeof_code(typeof_entity->get_code(), program);
+	bpp::code_segment typeof_code;
+
+	// If the operand is an object (not a pointer) whose class is known at compile time, we already know the answer
+	std::shared_ptr<bpp::bpp_class> operand_class = typeof_entity->get_operand_class();
+	if (operand_class != nullptr && typeof_entity->operand_type_is_exact()) {
+		typeof_code.code = operand_class->get_name();
+		report_optimization(node, "@typeof of an object of class " + operand_class->get_name() + " resolved at compile time");
+	} else {
+		typeof_code = bpp::generate_typeof_code(typeof_entity->get_code(), program);
+	}
 
 	current_code_entity->add_code_to_previous_line(typeof_entity->get_pre_code());
 	current_code_entity->add_code_to_previous_line(typeof_code.pre_code);
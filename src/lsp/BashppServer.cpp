@@ -6,19 +6,30 @@
 
 #include "BashppServer.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include "FrameReader.h"
+#include "MessagePeek.h"
+#include "include/validateUri.h"
+
 #include "generated/PublishDiagnosticsNotification.h"
 #include "generated/ErrorCodes.h"
 
+#include <AST/ParseCache.h>
 #include <bpp_include/bpp_program.h>
 
 std::mutex bpp::BashppServer::output_mutex;
-std::mutex bpp::BashppServer::log_mutex;
 
 void bpp::BashppServer::setLogFile(const std::string& path) {
-	log_file.open(path, std::ios::app);
-	if (!log_file.is_open()) throw std::runtime_error("Failed to open log file: " + path);
+	logger.open(path);
+}
+
+void bpp::BashppServer::setLogLevel(Logger::Level level) {
+	logger.set_level(level);
 }
 
 void bpp::BashppServer::setTargetBashVersion(const BashVersion& version) {
@@ -31,85 +42,95 @@ void bpp::BashppServer::setThreadCount(size_t num_threads) {
 	log("Set number of threads to: ", num_threads);
 }
 
+void bpp::BashppServer::setMemoryBudget(size_t bytes) {
+	program_pool.set_memory_budget(bytes);
+	log("Set memory budget for the program pool to: ", bytes / (1024 * 1024), " MiB");
+}
+
+void bpp::BashppServer::logMemoryUsage() {
+	log("Program pool holds ", program_pool.get_program_count(), " programs, using an estimated ",
+		program_pool.get_memory_usage() / 1024, " KiB of its ",
+		program_pool.get_memory_budget() / 1024, " KiB budget.");
+}
+
 void bpp::BashppServer::cleanup() {
 	if (exiting.exchange(true)) return; // Already exiting
 
-	if (output_stream) output_stream->flush();
-
+	debounce_scheduler.cleanup();
 	thread_pool->cleanup();
-	log("Bash++ Language Server cleaned up and exiting.");
-	log_file.close();
-}
-
-std::string bpp::BashppServer::readHeaderLine(std::streambuf* buffer) {
-	std::string header;
-	char c;
-	while (true) {
-		const std::streamsize n = buffer->sgetn(&c, 1);
-		if (n != 1) {
-			throw std::runtime_error("End of input stream reached while reading header.");
-		}
-		if (c == '\n') break;
-		if (c == '\r') continue;
-		header += c;
+	if (!workspace_index_cache_path.empty() && workspace_index.is_modified()) {
+		workspace_index.save(workspace_index_cache_path);
 	}
-	return header;
+	log("Bash++ Language Server cleaned up and exiting.");
+	logger.close();
 }
 
 void bpp::BashppServer::mainLoop() {
-	if (!input_stream || !output_stream) {
+	if (input_fd < 0 || output_fd < 0) {
 		throw std::runtime_error("Input or output stream not set.");
 	}
 
 	log("Bash++ Language Server initialized.");
 	log("Using ", thread_pool->getThreadCount(), " threads for processing requests.");
 
-	std::streambuf* buffer = input_stream->rdbuf();
+	FrameReader reader(input_fd);
+	uint64_t sequence_number = 0;
 	while (!exiting) {
-		std::string header;
-		try {
-			header = readHeaderLine(buffer);
-		} catch (...) {
+		std::optional<std::string> message = reader.next_message();
+		if (!message.has_value()) {
 			log("End of input stream or error encountered.");
 			break;
 		}
-		
-		if (header.empty()) continue;
 
-		log("Received header: ", header);
+		log(Logger::Level::Debug, "Received message (", message->size(), " bytes)");
 
-		size_t content_length = 0;
-		if (header.starts_with("Content-Length: ")) {
-			content_length = std::stoul(header.substr(16));
+		// Peek at the message to see whether it's a didChange notification
+		// If it replaces the whole document, any earlier changes to the same document which are still queued are now moot
+		MessagePeek peek = MessagePeek::peek(*message);
+		if (peek.replaces_whole_document) {
+			std::lock_guard<std::mutex> lock(pending_document_replacements_mutex);
+			pending_document_replacements[peek.uri] = sequence_number;
 		}
 
-		if (content_length == 0) continue;
-
-		content_length += 2; // Account for the trailing "\r\n"
-
-		// Read content
-		std::vector<char> content(content_length);
-		std::streamsize read_count = buffer->sgetn(content.data(), static_cast<std::streamsize>(content_length));
-		if (read_count != static_cast<std::streamsize>(content_length)) {
-			log("Error reading content, expected ", content_length, " bytes but got less.");
-			break;
+		// Any request which arrives after this point and needs up-to-date analysis of the document
+		// should wait for this version
+		if (!peek.uri.empty() && peek.version.has_value()) {
+			try {
+				document_versions.expect(validateUri(peek.uri), peek.version.value());
+			} catch (const std::exception&) {
+				// Invalid URI, reported when the notification is handled
+			}
 		}
 
-		std::string message(content.begin(), content.end());
-		log("Received message (", content_length, " bytes): ", message);
-
 		// Grab a thread from the pool to process the message
-		thread_pool->enqueue([this, message]() {
+		thread_pool->enqueue([this, message = std::move(*message), uri = std::move(peek.uri), version = peek.version, sequence_number]() {
+			if (!uri.empty() && isSupersededChange(uri, sequence_number)) {
+				log("Skipping superseded DidChange notification for URI: ", uri, " (version ", version.value_or(-1), ")");
+				message_sequencer.finish(sequence_number);
+				return;
+			}
+
 			try {
-				this->processMessage(message);
+				this->processMessage(message, sequence_number);
 			} catch (const std::exception& e) {
-				log("Error processing message: ", e.what());
+				log(Logger::Level::Error, "Error processing message: ", e.what());
 			}
+			message_sequencer.finish(sequence_number); // No-op if processMessage already let later messages through
 		});
+		sequence_number++;
 	}
 	log("Main loop exiting.");
 }
 
+bool bpp::BashppServer::isSupersededChange(const std::string& uri, uint64_t sequence_number) {
+	std::lock_guard<std::mutex> lock(pending_document_replacements_mutex);
+	auto it = pending_document_replacements.find(uri);
+	if (it == pending_document_replacements.end()) return false;
+	if (it->second > sequence_number) return true;
+	if (it->second == sequence_number) pending_document_replacements.erase(it);
+	return false;
+}
+
 GenericResponseMessage bpp::BashppServer::invalidRequestHandler(const GenericRequestMessage& request) {
 	throw std::runtime_error("Request not understood: " + request.method);
 }
@@ -119,21 +140,60 @@ void bpp::BashppServer::invalidNotificationHandler(const GenericNotificationMess
 }
 
 void bpp::BashppServer::_sendMessage(const std::string& message) {
+	const std::string header = "Content-Length: " + std::to_string(message.size()) + "\r\n\r\n";
+
+	// Header and body go out in a single writev, picking up where we left off after any partial write
+	std::array<iovec, 2> iov = {{
+		{const_cast<char*>(header.data()), header.size()},
+		{const_cast<char*>(message.data()), message.size()}
+	}};
+	iovec* pending = iov.data();
+	int pending_count = static_cast<int>(iov.size());
+
 	std::lock_guard<std::mutex> lock(output_mutex);
-	std::string header = "Content-Length: " + std::to_string(message.size()) + "\r\n\r\n";
-	*output_stream << header << message << std::flush;
+	if (output_closed) return;
+	while (pending_count > 0) {
+		ssize_t written = writev(output_fd, pending, pending_count);
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			log(Logger::Level::Error, "Failed to write message: ", std::strerror(errno), ". No more messages will be sent.");
+			output_closed = true;
+			return;
+		}
+
+		while (pending_count > 0 && static_cast<size_t>(written) >= pending->iov_len) {
+			written -= static_cast<ssize_t>(pending->iov_len);
+			pending++;
+			pending_count--;
+		}
+		if (pending_count > 0) {
+			pending->iov_base = static_cast<char*>(pending->iov_base) + written;
+			pending->iov_len -= static_cast<size_t>(written);
+		}
+	}
 }
 
 void bpp::BashppServer::sendResponse(const GenericResponseMessage& response) {
-	std::string response_str = nlohmann::json(response).dump();
+	std::string response_str = response.dump();
 	_sendMessage(response_str);
-	log("Sent response for request ID: ", response.id, ":", response_str);
+	log(Logger::Level::Debug, "Sent response for request ID: ", response.id, ": ", response_str);
 }
 
 void bpp::BashppServer::sendNotification(const GenericNotificationMessage& notification) {
-	std::string notification_str = nlohmann::json(notification).dump();
+	std::string notification_str = notification.dump();
 	_sendMessage(notification_str);
-	log("Sent notification for method: ", notification.method, ":", notification_str);
+	log(Logger::Level::Debug, "Sent notification for method: ", notification.method, ": ", notification_str);
+}
+
+void bpp::BashppServer::sendRequest(const std::string& method) {
+	nlohmann::json request = {
+		{"jsonrpc", "2.0"},
+		{"id", "bpp-lsp-" + std::to_string(next_request_id.fetch_add(1))},
+		{"method", method}
+	};
+	std::string request_str = request.dump();
+	_sendMessage(request_str);
+	log(Logger::Level::Debug, "Sent request: ", request_str);
 }
 
 void bpp::BashppServer::processRequest(const GenericRequestMessage& request) {
@@ -156,7 +216,7 @@ void bpp::BashppServer::processRequest(const GenericRequestMessage& request) {
 	try {
 		response = (this->*(it->handler))(request);
 	} catch (const std::exception& e) {
-		log("Error handling request: ", e.what());
+		log(Logger::Level::Error, "Error handling request: ", e.what());
 		ResponseError err;
 		err.code = static_cast<int>(ErrorCodes::InternalError);
 		err.message = "Internal error";
@@ -183,11 +243,11 @@ void bpp::BashppServer::processNotification(const GenericNotificationMessage& no
 	try {
 		(this->*(it->handler))(notification);
 	} catch (const std::exception& e) {
-		log("Error handling notification: ", e.what());
+		log(Logger::Level::Error, "Error handling notification: ", e.what());
 	}
 }
 
-void bpp::BashppServer::processMessage(const std::string& message) {
+void bpp::BashppServer::processMessage(const std::string& message, uint64_t sequence_number) {
 	GenericRequestMessage request;
 	GenericNotificationMessage notification;
 
@@ -195,15 +255,22 @@ void bpp::BashppServer::processMessage(const std::string& message) {
 	try {
 		json_message = nlohmann::json::parse(message);
 	} catch (const nlohmann::json::parse_error& e) {
-		log("Error parsing JSON message: ", e.what());
+		log(Logger::Level::Error, "Error parsing JSON message: ", e.what());
 		return;
 	}
 
-	// Request or notification?
+	// Request, notification, or response?
 	// Check if 'id' field is present
 	// Requests are required to have IDs, notifications are required to not have IDs
-	if (json_message.contains("id")) {
-		request = json_message.get<GenericRequestMessage>();
+	// Responses (to requests we've sent to the client) have IDs, but no method
+	if (json_message.contains("id") && !json_message.contains("method")) {
+		message_sequencer.finish(sequence_number);
+		log(Logger::Level::Debug, "Ignoring response from the client to request ID: ", json_message["id"].dump());
+		return;
+	} else if (json_message.contains("id")) {
+		// Requests don't have to wait for earlier messages
+		message_sequencer.finish(sequence_number);
+		request = GenericRequestMessage::fromJson(std::move(json_message));
 		if (shutdown_requested) {
 			// LSP spec says we should send an InvalidRequest error for any request received after shutdown is requested
 			GenericResponseMessage response;
@@ -217,8 +284,10 @@ void bpp::BashppServer::processMessage(const std::string& message) {
 		}
 		processRequest(request);
 	} else {
-		notification = json_message.get<GenericNotificationMessage>();
+		notification = GenericNotificationMessage::fromJson(std::move(json_message));
+		message_sequencer.wait_for_turn(sequence_number);
 		processNotification(notification);
+		message_sequencer.finish(sequence_number);
 	}
 }
 
@@ -242,50 +311,135 @@ void bpp::BashppServer::exit(const GenericNotificationMessage& /*notification*/)
 	}
 }
 
+std::vector<Diagnostic> bpp::BashppServer::toLspDiagnostics(const std::vector<bpp::diagnostic>& diagnostics) {
+	std::vector<Diagnostic> lsp_diags;
+	lsp_diags.reserve(diagnostics.size());
+	for (const auto& diag : diagnostics) {
+		Diagnostic lsp_diag;
+		lsp_diag.range.start.line = diag.start_line;
+		lsp_diag.range.start.character = diag.start_column;
+		lsp_diag.range.end.line = diag.end_line;
+		lsp_diag.range.end.character = diag.end_column;
+		
+		switch (diag.type) {
+			case bpp::diagnostic_type::DIAGNOSTIC_ERROR:
+				lsp_diag.severity = DiagnosticSeverity::Error;
+				break;
+			case bpp::diagnostic_type::DIAGNOSTIC_WARNING:
+				lsp_diag.severity = DiagnosticSeverity::Warning;
+				break;
+			case bpp::diagnostic_type::DIAGNOSTIC_INFO:
+				lsp_diag.severity = DiagnosticSeverity::Information;
+				break;
+			case bpp::diagnostic_type::DIAGNOSTIC_HINT:
+				lsp_diag.severity = DiagnosticSeverity::Hint;
+				break;
+		}
+
+		lsp_diag.message = diag.message;
+
+		lsp_diags.push_back(lsp_diag);
+	}
+	return lsp_diags;
+}
+
 void bpp::BashppServer::publishDiagnostics(std::shared_ptr<bpp::bpp_program> program) {
-	log("Publishing diagnostics for program rooted at: ", program->get_main_source_file());
 	if (program == nullptr) {
 		log("Cannot publish diagnostics for a null program.");
 		return;
 	}
+	log("Publishing diagnostics for program rooted at: ", program->get_main_source_file());
 
 	const auto source_files = program->get_source_files();
+	size_t unchanged_files = 0;
 	for (const auto& file : source_files) {
-		PublishDiagnosticsNotification notification;
-		notification.params.uri = "file://" + file;
+		const std::string file_uri = "file://" + file;
 		std::vector<bpp::diagnostic> diags = program->get_diagnostics(file);
-		std::vector<Diagnostic> lsp_diags;
-		for (const auto& diag : diags) {
-			Diagnostic lsp_diag;
-			lsp_diag.range.start.line = diag.start_line;
-			lsp_diag.range.start.character = diag.start_column;
-			lsp_diag.range.end.line = diag.end_line;
-			lsp_diag.range.end.character = diag.end_column;
-			
-			switch (diag.type) {
-				case bpp::diagnostic_type::DIAGNOSTIC_ERROR:
-					lsp_diag.severity = DiagnosticSeverity::Error;
-					break;
-				case bpp::diagnostic_type::DIAGNOSTIC_WARNING:
-					lsp_diag.severity = DiagnosticSeverity::Warning;
-					break;
-				case bpp::diagnostic_type::DIAGNOSTIC_INFO:
-					lsp_diag.severity = DiagnosticSeverity::Information;
-					break;
-				case bpp::diagnostic_type::DIAGNOSTIC_HINT:
-					lsp_diag.severity = DiagnosticSeverity::Hint;
-					break;
-			}
+		const uint64_t diagnostics_hash = DiagnosticsTracker::hash(diags);
 
-			lsp_diag.message = diag.message;
+		if (pull_diagnostics) {
+			// The client asks for diagnostics itself, and we only have to tell it when to ask again
+			if (!diagnostics_tracker.is_outdated(file, diagnostics_hash)) {
+				unchanged_files++;
+				continue;
+			}
+			if (diagnostic_refresh_support) {
+				log("Diagnostics changed for file: ", file, ", asking the client to pull them again");
+				sendRequest("workspace/diagnostic/refresh");
+			}
+			return;
+		}
 
-			lsp_diags.push_back(lsp_diag);
+		if (!diagnostics_tracker.record(file, diagnostics_hash)) {
+			unchanged_files++;
+			continue; // The client already has exactly these diagnostics
 		}
 
-		notification.params.diagnostics = lsp_diags;
-		log("Publishing ", lsp_diags.size(), " diagnostics for file: ", file);
+		PublishDiagnosticsNotification notification;
+		notification.params.uri = file_uri;
+		notification.params.diagnostics = toLspDiagnostics(diags);
+		log("Publishing ", diags.size(), " diagnostics for file: ", file);
 		sendNotification(notification);
 	}
+	log("Diagnostics unchanged for ", unchanged_files, " of ", source_files.size(), " files.");
+}
+
+void bpp::BashppServer::indexWorkspace() {
+	if (workspace_roots.empty()) return;
+	workspace_index.set_utf16_mode(program_pool.get_utf16_mode());
+	workspace_index_cache_path = WorkspaceIndex::default_cache_path(workspace_roots);
+
+	thread_pool->enqueue([this]() {
+		if (!workspace_index_cache_path.empty() && workspace_index.load(workspace_index_cache_path)) {
+			log("Loaded cached workspace index with ", workspace_index.get_file_count(), " files.");
+		}
+
+		auto files = std::make_shared<const std::vector<std::string>>(WorkspaceIndex::discover_files(workspace_roots));
+		workspace_index.retain_files(*files); // Forget files which have been deleted since the cache was saved
+		log("Indexing ", files->size(), " files in the workspace.");
+		if (files->empty()) return;
+
+		// Split the files up into batches, and hand each batch to the thread pool
+		// Whichever batch finishes last saves the cache
+		const size_t batch_count = (files->size() + workspace_files_per_task - 1) / workspace_files_per_task;
+		auto remaining_batches = std::make_shared<std::atomic<size_t>>(batch_count);
+		auto parsed_files = std::make_shared<std::atomic<size_t>>(0);
+		for (size_t batch = 0; batch < batch_count; batch++) {
+			thread_pool->enqueue([this, files, batch, remaining_batches, parsed_files]() {
+				const size_t first = batch * workspace_files_per_task;
+				const size_t last = std::min(first + workspace_files_per_task, files->size());
+				for (size_t i = first; i < last; i++) {
+					if (workspace_index.update_file((*files)[i], AST::ParseCache::read_file((*files)[i]))) {
+						parsed_files->fetch_add(1, std::memory_order_relaxed);
+					}
+				}
+
+				if (remaining_batches->fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+				log("Indexed ", files->size(), " workspace files (", parsed_files->load(std::memory_order_relaxed), " had changed since they were last indexed).");
+				if (!workspace_index_cache_path.empty() && workspace_index.is_modified()) {
+					if (!workspace_index.save(workspace_index_cache_path)) {
+						log(Logger::Level::Warning, "Failed to save the workspace index to: ", workspace_index_cache_path);
+					}
+				}
+			}, ThreadPool::Priority::Background);
+		}
+	}, ThreadPool::Priority::Background);
+}
+
+void bpp::BashppServer::reindexWorkspaceFile(const std::string& file_path) {
+	const bool in_workspace = std::ranges::any_of(workspace_roots, [&file_path](const std::string& root) {
+		return file_path.starts_with(root) && (root.ends_with("/") || file_path.size() == root.size() || file_path[root.size()] == '/');
+	});
+	if (!in_workspace) return;
+
+	thread_pool->enqueue([this, file_path]() {
+		std::shared_ptr<const std::string> contents = AST::ParseCache::read_file(file_path);
+		if (contents == nullptr || !WorkspaceIndex::is_indexable_file(file_path, *contents)) {
+			workspace_index.remove_file(file_path);
+			return;
+		}
+		workspace_index.update_file(file_path, contents);
+	}, ThreadPool::Priority::Background);
 }
 
 void bpp::BashppServer::add_include_path(const std::string& path) {
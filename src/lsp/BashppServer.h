@@ -11,19 +11,28 @@
 #include <mutex>
 #include <chrono>
 #include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <set>
 #include <unordered_map>
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <unistd.h>
 
 #include "ThreadPool.h"
+#include "DebounceScheduler.h"
+#include "DiagnosticsTracker.h"
+#include "DocumentVersionBarrier.h"
+#include "Logger.h"
 #include "ProgramPool.h"
+#include "QueryCache.h"
+#include "WorkspaceIndex.h"
 
 #include "static/Message.h"
 
 #include "generated/CompletionList.h"
 #include "generated/CompletionParams.h"
+#include "generated/Diagnostic.h"
 
 #include <bpp_include/bpp_codegen.h>
 #include <include/BashVersion.h>
@@ -63,14 +72,16 @@ class BashppServer {
 		void mainLoop();
 
 		void setLogFile(const std::string& path);
+		void setLogLevel(Logger::Level level);
 		void setTargetBashVersion(const BashVersion& version);
 		void setThreadCount(size_t num_threads);
+		void setMemoryBudget(size_t bytes);
 
 		GenericResponseMessage shutdown(const GenericRequestMessage& request);
 		void exit(const GenericNotificationMessage& notification);
 		void cleanup();
 
-		void processMessage(const std::string& message);
+		void processMessage(const std::string& message, uint64_t sequence_number);
 
 		// Request-Response handlers
 		GenericResponseMessage handleInitialize(const GenericRequestMessage& request);
@@ -80,9 +91,11 @@ class BashppServer {
 		GenericResponseMessage handleRename(const GenericRequestMessage& request);
 		GenericResponseMessage handleReferences(const GenericRequestMessage& request);
 		GenericResponseMessage handleCompletion(const GenericRequestMessage& request);
+		GenericResponseMessage handleWorkspaceSymbol(const GenericRequestMessage& request);
+		GenericResponseMessage handleDocumentDiagnostic(const GenericRequestMessage& request);
 
-		CompletionList handleATCompletion(const CompletionParams& params);
-		CompletionList handleDOTCompletion(const CompletionParams& params);
+		nlohmann::json handleATCompletion(const CompletionParams& params);
+		nlohmann::json handleDOTCompletion(const CompletionParams& params);
 
 		// Notification handlers
 		void handleDidOpen(const GenericNotificationMessage& request);
@@ -94,84 +107,160 @@ class BashppServer {
 		void sendResponse(const GenericResponseMessage& response);
 		void sendNotification(const GenericNotificationMessage& notification);
 
+		/**
+		 * @brief Send a request (with no params) to the client
+		 *
+		 * The client's response is ignored.
+		 */
+		void sendRequest(const std::string& method);
+
+		/**
+		 * @brief Let the client know about a program's (re-)analysis
+		 *
+		 * If the client pulls diagnostics, it's asked to pull them again if any of the program's files' diagnostics have changed.
+		 * Otherwise, diagnostics are pushed for those of the program's files whose diagnostics have changed.
+		 */
 		void publishDiagnostics(std::shared_ptr<bpp::bpp_program> program);
 
+		/**
+		 * @brief Build the workspace index in the background
+		 *
+		 * Loads whatever was cached from the last session, then (re-)parses every Bash++ file under the workspace roots
+		 * whose contents have changed since, in parallel, as background tasks on the thread pool.
+		 * The cache is saved again once every file has been indexed.
+		 */
+		void indexWorkspace();
+
 		void add_include_path(const std::string& path);
 		void set_suppress_warnings(bool suppress);
 
 		template <typename... Args>
 		void log(Args&&... args) {
-			if (!log_file.is_open()) return; // Not logging
-
-			std::lock_guard<std::mutex> lock(log_mutex);
-			auto now = std::chrono::system_clock::now();
-			auto now_time_t = std::chrono::system_clock::to_time_t(now);
-			std::tm tm_buf{};
-			localtime_r(&now_time_t, &tm_buf);
-			log_file << "[" << std::put_time(&tm_buf, "%Y-%m-%d %H:%M:%S") << "] ";
-			log_file << "[" << std::to_string(pid) << "] ";
-			((printValue(log_file, std::forward<Args>(args))), ...);
-			log_file << std::endl;
+			log(Logger::Level::Info, std::forward<Args>(args)...);
+		}
+
+		/**
+		 * @brief Log a message at the given level
+		 *
+		 * Nothing is formatted unless the message would actually be written.
+		 * The message is cut off at the logger's maximum length as it's formatted,
+		 * so logging a large payload never copies more of it than will be kept.
+		 */
+		template <typename... Args>
+		void log(Logger::Level level, Args&&... args) {
+			if (!logger.enabled(level)) return;
+
+			Logger::MessageBuffer buffer(logger.get_max_message_length());
+			std::ostream stream(&buffer);
+			((printValue(stream, std::forward<Args>(args))), ...);
+			logger.write(level, buffer.take());
 		}
 
 	private:
-		pid_t pid = getpid();
 		std::atomic<bool> exiting = false;
 		std::atomic<bool> shutdown_requested = false;
+		std::atomic<bool> output_closed = false; // Set once a write to the client fails, after which nothing more is sent
 
 		// Resources
-		std::istream* input_stream = &std::cin;  // Held as std::stream* for future extensions beyond stdio
-		std::ostream* output_stream = &std::cout;
+		Logger logger; // Declared first so that it outlives everything which might log
+		int input_fd = STDIN_FILENO; // Held as fds for future extensions beyond stdio
+		int output_fd = STDOUT_FILENO;
 		std::unique_ptr<ThreadPool> thread_pool = std::make_unique<ThreadPool>(std::thread::hardware_concurrency());
-		ProgramPool program_pool = ProgramPool(10); // Maximum 10 programs in the pool
-		std::ofstream log_file;
+		ProgramPool program_pool = ProgramPool(); // Evicts least recently used programs when over its memory budget
 
-		// Debouncing didChange notifications
-		struct DebounceState {
-			std::atomic<uint64_t> change_generation{0};
-			std::atomic<uint64_t> average_reparse_time_in_microseconds{50'000}; // 50ms initial guess
-			std::atomic<uint32_t> debounce_time_in_milliseconds{100}; // Start with 100ms
-		};
+		// Classes, methods and data members defined anywhere under the workspace roots, for workspace/symbol
+		WorkspaceIndex workspace_index;
+		std::vector<std::string> workspace_roots; // Set once, on initialize
+		std::string workspace_index_cache_path;
+		static constexpr size_t workspace_symbol_limit = 256;
+		static constexpr size_t workspace_files_per_task = 16;
 
-		// Map: program main URI -> DebounceState
-		// Used for adaptive debouncing
-		class DebounceStateMap {
+		/**
+		 * @brief Re-index a file on disk, in the background, if it's part of the workspace
+		 */
+		void reindexWorkspaceFile(const std::string& file_path);
+
+		// Debouncing didChange notifications
+		// Keyed by document URI; expired reparses are handed over to the thread pool
+		DebounceScheduler debounce_scheduler = DebounceScheduler(
+			[this](std::function<void()> task) { thread_pool->enqueue(std::move(task)); }
+		);
+
+		// How far along each version of each open document is (received / applied / analyzed)
+		// Requests which need up-to-date analysis wait here for the newest version the client has sent
+		DocumentVersionBarrier document_versions;
+		static constexpr std::chrono::milliseconds document_version_timeout{2000};
+
+		// Which diagnostics the client already has, so that unchanged diagnostics aren't sent again
+		DiagnosticsTracker diagnostics_tracker;
+		std::atomic<bool> pull_diagnostics = false; // Whether the client pulls diagnostics (textDocument/diagnostic) rather than having them pushed
+		std::atomic<bool> diagnostic_refresh_support = false; // Whether the client accepts workspace/diagnostic/refresh
+		std::atomic<uint64_t> next_request_id = 0; // For requests sent from the server to the client
+
+		// Results of hover, document symbol and completion queries, for as long as the program they were computed from is current
+		QueryCache query_cache;
+
+		static std::vector<Diagnostic> toLspDiagnostics(const std::vector<bpp::diagnostic>& diagnostics);
+
+		// Notifications have to be handled in the order in which they were received
+		// (e.g., incremental edits to a document only make sense if applied in order),
+		// But messages are handed over to the thread pool, whose workers may overtake one another.
+		// The main loop gives every message a sequence number, and a notification waits until
+		// every earlier message has either turned out to be a request, or has been handled.
+		class MessageSequencer {
 			private:
-				std::unordered_map<std::string, std::shared_ptr<DebounceState>> states;
-				ProgramPool* pool;
-				std::mutex map_mutex;
-
-				void cleanup() {
-					for (auto it = states.begin(); it != states.end(); ) {
-						if (!pool->has_program(it->first)) {
-							it = states.erase(it);
-						} else {
-							it++;
+				uint64_t next_sequence_number = 0; // The next message allowed to proceed
+				std::set<uint64_t> finished_early; // Messages which finished before their turn came
+				std::mutex sequencer_mutex;
+				std::condition_variable condition;
+			public:
+				void wait_for_turn(uint64_t sequence_number) {
+					std::unique_lock<std::mutex> lock(sequencer_mutex);
+					condition.wait(lock, [this, sequence_number] { return next_sequence_number >= sequence_number; });
+				}
+
+				void finish(uint64_t sequence_number) {
+					{
+						std::lock_guard<std::mutex> lock(sequencer_mutex);
+						if (sequence_number < next_sequence_number) return; // Already finished
+						if (sequence_number != next_sequence_number) {
+							finished_early.insert(sequence_number);
+							return;
+						}
+						next_sequence_number++;
+						while (finished_early.erase(next_sequence_number) > 0) {
+							next_sequence_number++;
 						}
 					}
-				}
-			public:
-				DebounceStateMap() = delete;
-				explicit DebounceStateMap(ProgramPool* program_pool) : pool(program_pool) {}
-				std::shared_ptr<DebounceState> get(const std::string& uri) {
-					std::lock_guard<std::mutex> lock(map_mutex);
-					cleanup(); // Clean up stale entries on every access
-					auto it = states.find(uri);
-					if (it != states.end()) return it->second;
-					auto new_state = std::make_shared<DebounceState>();
-					states[uri] = new_state;
-					return new_state;
+					condition.notify_all();
 				}
 		};
-		DebounceStateMap debounce_states = DebounceStateMap(&program_pool);
-		std::atomic<bool> processing_didChange{false};
+		MessageSequencer message_sequencer;
 
-		static std::string readHeaderLine(std::streambuf* buffer);
+		// Whole-document didChange notifications which have been received but not yet handled
+		// Keyed by document URI, holding the sequence number of the newest such change
+		// Any didChange for the same URI with a lower sequence number is superseded by it, and is skipped without being parsed
+		std::unordered_map<std::string, uint64_t> pending_document_replacements;
+		std::mutex pending_document_replacements_mutex;
 
+		/**
+		 * @brief Whether a didChange notification has been superseded by a later whole-document change to the same URI
+		 *
+		 * Also forgets the pending replacement once the replacing change itself comes up.
+		 */
+		bool isSupersededChange(const std::string& uri, uint64_t sequence_number);
+
+		/**
+		 * @brief Write a message to the client
+		 *
+		 * Never throws, since it's called from thread pool and debounce tasks which have nowhere to send an exception.
+		 * If the write fails (e.g., because the client has closed the pipe), the error is logged,
+		 * the connection is marked as closed, and every later message is dropped.
+		 */
 		void _sendMessage(const std::string& message);
+		void logMemoryUsage();
 
 		static std::mutex output_mutex; // Mutex for thread-safe output
-		static std::mutex log_mutex; // Mutex for thread-safe logging
 		
 		static GenericResponseMessage invalidRequestHandler(const GenericRequestMessage& request);
 		static void invalidNotificationHandler(const GenericNotificationMessage& request);
@@ -286,7 +375,7 @@ class BashppServer {
 		 * @brief Maps request types to the functions that handle them.
 		 * 
 		 */
-		static constexpr std::array<RequestHandlerEntry, 8> request_handlers = {{
+		static constexpr std::array<RequestHandlerEntry, 10> request_handlers = {{
 			{"initialize",                  &BashppServer::handleInitialize},
 			{"textDocument/definition",     &BashppServer::handleDefinition},
 			{"textDocument/completion",     &BashppServer::handleCompletion},
@@ -294,6 +383,8 @@ class BashppServer {
 			{"textDocument/documentSymbol", &BashppServer::handleDocumentSymbol},
 			{"textDocument/rename",         &BashppServer::handleRename},
 			{"textDocument/references",     &BashppServer::handleReferences},
+			{"textDocument/diagnostic",     &BashppServer::handleDocumentDiagnostic},
+			{"workspace/symbol",            &BashppServer::handleWorkspaceSymbol},
 			{"shutdown",                    &BashppServer::shutdown}
 		}};
 
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "DebounceScheduler.h"
+
+#include <algorithm>
+
+DebounceScheduler::DebounceScheduler(Dispatcher dispatcher) : dispatcher(std::move(dispatcher)) {
+	timer_thread = std::thread([this] { this->run(); });
+}
+
+DebounceScheduler::~DebounceScheduler() {
+	cleanup();
+	if (timer_thread.joinable()) {
+		timer_thread.join();
+	}
+}
+
+void DebounceScheduler::run() {
+	std::unique_lock<std::mutex> lock(scheduler_mutex);
+	while (true) {
+		condition.wait(lock, [this] { return this->stop || !this->timers.empty(); });
+		if (stop) return;
+
+		const Clock::time_point next_deadline = timers.top().deadline;
+		if (Clock::now() < next_deadline) {
+			// Sleep until the earliest deadline, or until a new entry / stop request wakes us up
+			condition.wait_until(lock, next_deadline);
+			continue;
+		}
+
+		TimerEntry entry = timers.top();
+		timers.pop();
+
+		auto it = states.find(entry.key);
+		if (it == states.end()) continue; // Key was forgotten
+
+		std::shared_ptr<KeyState> state = it->second;
+		std::shared_ptr<ScheduledTask> scheduled_task = state->latest_task;
+		if (scheduled_task == nullptr || scheduled_task->generation != entry.generation || scheduled_task->dispatched) {
+			continue; // Superseded by a newer task (which has its own entry further down the heap), or already run by flush()
+		}
+		scheduled_task->dispatched = true;
+
+		lock.unlock();
+		dispatcher([this, state, scheduled_task]() {
+			execute(state, scheduled_task);
+		});
+		lock.lock();
+	}
+}
+
+void DebounceScheduler::record_run_time(KeyState* state, uint64_t run_time_in_microseconds) {
+	// Integer EWMA update: weight = 1/4 (no floats)
+	constexpr uint64_t weight_numerator = 1;
+	constexpr uint64_t weight_denominator = 4;
+
+	const uint64_t previous_average_in_microseconds =
+		state->average_run_time_in_microseconds.load(std::memory_order_acquire);
+
+	const uint64_t new_average_in_microseconds =
+		(previous_average_in_microseconds == 0)
+			? run_time_in_microseconds
+			: (
+				(previous_average_in_microseconds * (weight_denominator - weight_numerator)
+				+ run_time_in_microseconds * weight_numerator)
+				/ weight_denominator
+			  );
+
+	state->average_run_time_in_microseconds.store(new_average_in_microseconds, std::memory_order_release);
+
+	// Derive the delay from the average
+	constexpr uint32_t minimum_delay_in_milliseconds = 25;
+	constexpr uint32_t maximum_delay_in_milliseconds = 1000;
+	constexpr uint32_t baseline_delay_in_milliseconds = 100;
+
+	// Scale: 3/4
+	constexpr uint32_t scale_numerator = 3;
+	constexpr uint32_t scale_denominator = 4;
+
+	const uint64_t scaled_component_in_milliseconds =
+		(scale_numerator * (new_average_in_microseconds / 1000)) / scale_denominator;
+
+	const uint32_t new_delay_in_milliseconds = static_cast<uint32_t>(std::clamp<uint64_t>(
+		baseline_delay_in_milliseconds + scaled_component_in_milliseconds,
+		minimum_delay_in_milliseconds,
+		maximum_delay_in_milliseconds
+	));
+
+	state->delay_in_milliseconds.store(new_delay_in_milliseconds, std::memory_order_release);
+}
+
+void DebounceScheduler::schedule(const std::string& key, Task task) {
+	{
+		std::lock_guard<std::mutex> lock(scheduler_mutex);
+		if (stop) return;
+
+		std::shared_ptr<KeyState>& state = states[key];
+		if (state == nullptr) state = std::make_shared<KeyState>();
+
+		const uint64_t generation = state->generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+		state->latest_task = std::make_shared<ScheduledTask>();
+		state->latest_task->task = std::move(task);
+		state->latest_task->generation = generation;
+
+		const auto delay = std::chrono::milliseconds(state->delay_in_milliseconds.load(std::memory_order_acquire));
+		timers.push(TimerEntry{Clock::now() + delay, generation, key});
+	}
+	condition.notify_one();
+}
+
+void DebounceScheduler::flush(const std::string& key) {
+	std::shared_ptr<KeyState> state;
+	std::shared_ptr<ScheduledTask> scheduled_task;
+	{
+		std::lock_guard<std::mutex> lock(scheduler_mutex);
+		auto it = states.find(key);
+		if (it == states.end() || it->second->latest_task == nullptr) return;
+		state = it->second;
+		scheduled_task = state->latest_task;
+	}
+	// Its timer entry (and its dispatched copy, if any) will find it already claimed
+	execute(state, scheduled_task);
+}
+
+void DebounceScheduler::execute(const std::shared_ptr<KeyState>& state, const std::shared_ptr<ScheduledTask>& scheduled_task) {
+	// Skip if a newer task was scheduled in the meantime, or if somebody else got to this one first
+	if (state->generation.load(std::memory_order_acquire) != scheduled_task->generation) return;
+	if (scheduled_task->claimed.exchange(true, std::memory_order_acq_rel)) return;
+
+	const auto start_time = Clock::now();
+	const bool record = scheduled_task->task();
+	const auto end_time = Clock::now();
+
+	if (record) {
+		record_run_time(state.get(), static_cast<uint64_t>(
+			std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count()
+		));
+	}
+
+	std::lock_guard<std::mutex> lock(scheduler_mutex);
+	if (state->latest_task == scheduled_task) state->latest_task = nullptr;
+}
+
+void DebounceScheduler::forget(const std::string& key) {
+	std::lock_guard<std::mutex> lock(scheduler_mutex);
+	auto it = states.find(key);
+	if (it == states.end()) return;
+	// Bump the generation so that an already-dispatched task for this key is skipped
+	it->second->generation.fetch_add(1, std::memory_order_acq_rel);
+	states.erase(it);
+}
+
+void DebounceScheduler::cleanup() {
+	{
+		std::lock_guard<std::mutex> lock(scheduler_mutex);
+		stop = true;
+		while (!timers.empty()) {
+			timers.pop();
+		}
+		states.clear();
+	}
+	condition.notify_all();
+}
+
+uint32_t DebounceScheduler::get_delay_in_milliseconds(const std::string& key) {
+	std::lock_guard<std::mutex> lock(scheduler_mutex);
+	auto it = states.find(key);
+	if (it == states.end()) return 100;
+	return it->second->delay_in_milliseconds.load(std::memory_order_acquire);
+}
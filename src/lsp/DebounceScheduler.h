@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class DebounceScheduler
+ * @brief A single-threaded timer service which debounces keyed tasks.
+ *
+ * Tasks are scheduled against a key (e.g., a document URI).
+ * Scheduling a new task for a key which already has a pending task replaces the pending one,
+ * and pushes the deadline back by the key's current debounce delay.
+ *
+ * Deadlines are kept in a min-heap and serviced by one timer thread,
+ * which hands expired tasks over to a dispatcher (normally ThreadPool::enqueue).
+ * Superseded heap entries are discarded lazily when they reach the top of the heap.
+ *
+ * A task can also be run right away with flush(), on the thread which asks for it.
+ * Each task runs at most once: whichever of the dispatched copy and a flush claims it first runs it.
+ *
+ * The debounce delay for each key adapts to how long its tasks take to run:
+ * an integer EWMA (weight 1/4) of the task's run time is kept per key,
+ * and the delay is derived from it as 100ms + 3/4 of the average, clamped to [25ms, 1000ms].
+ *
+ */
+class DebounceScheduler {
+	public:
+		/**
+		 * @brief A debounced task.
+		 *
+		 * Returns true if its run time should count towards the key's adaptive delay,
+		 * or false otherwise (e.g., if the task failed early).
+		 * Tasks mustn't throw, since they run on thread pool workers.
+		 */
+		using Task = std::function<bool()>;
+		using Dispatcher = std::function<void(std::function<void()>)>;
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		struct ScheduledTask {
+			Task task;
+			uint64_t generation = 0;
+			bool dispatched = false; // Guarded by scheduler_mutex
+			std::atomic<bool> claimed{false}; // Set by whoever runs the task
+		};
+		struct KeyState {
+			std::atomic<uint64_t> generation{0};
+			std::atomic<uint64_t> average_run_time_in_microseconds{50'000}; // 50ms initial guess
+			std::atomic<uint32_t> delay_in_milliseconds{100}; // Start with 100ms
+			std::shared_ptr<ScheduledTask> latest_task; // Guarded by scheduler_mutex. Kept until it has run
+		};
+
+		struct TimerEntry {
+			Clock::time_point deadline;
+			uint64_t generation;
+			std::string key;
+
+			bool operator>(const TimerEntry& other) const {
+				return deadline > other.deadline;
+			}
+		};
+
+		std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>> timers;
+		std::unordered_map<std::string, std::shared_ptr<KeyState>> states;
+		Dispatcher dispatcher;
+		std::mutex scheduler_mutex;
+		std::condition_variable condition;
+		std::thread timer_thread;
+		bool stop = false;
+
+		void run();
+		void execute(const std::shared_ptr<KeyState>& state, const std::shared_ptr<ScheduledTask>& scheduled_task);
+		static void record_run_time(KeyState* state, uint64_t run_time_in_microseconds);
+
+	public:
+		explicit DebounceScheduler(Dispatcher dispatcher);
+		~DebounceScheduler();
+
+		DebounceScheduler(const DebounceScheduler& other) = delete; // Non-copyable
+		DebounceScheduler& operator=(const DebounceScheduler& other) = delete;
+		DebounceScheduler(DebounceScheduler&& other) noexcept = delete; // Non-movable
+		DebounceScheduler& operator=(DebounceScheduler&& other) noexcept = delete;
+
+		/**
+		 * @brief Schedule a task for the given key, replacing any task still pending for that key.
+		 *
+		 * The task is dispatched once the key's debounce delay has elapsed without a newer task being scheduled.
+		 * If a newer task is scheduled after this one has been dispatched but before it starts running,
+		 * this one is skipped.
+		 */
+		void schedule(const std::string& key, Task task);
+
+		/**
+		 * @brief Run the task pending for the given key right away, on the calling thread, without waiting out the debounce delay.
+		 *
+		 * Used when somebody is waiting on the result (e.g., a completion request waiting on a reparse).
+		 * The task runs here rather than being handed to the dispatcher, since the caller is usually a thread pool worker,
+		 * and the pool might not have another worker free to run it.
+		 * Does nothing if no task is pending for the key, or if its task is already running elsewhere.
+		 */
+		void flush(const std::string& key);
+
+		/**
+		 * @brief Drop any pending task and timing state for the given key.
+		 */
+		void forget(const std::string& key);
+
+		/**
+		 * @brief Stop the timer thread and discard all pending tasks.
+		 */
+		void cleanup();
+
+		uint32_t get_delay_in_milliseconds(const std::string& key);
+};
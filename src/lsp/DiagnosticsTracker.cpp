@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "DiagnosticsTracker.h"
+
+#include <cstdio>
+
+uint64_t DiagnosticsTracker::hash(const std::vector<bpp::diagnostic>& diagnostics) {
+	// 64-bit FNV-1a over every field of every diagnostic, in order
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	auto mix = [&hash](const void* data, size_t size) {
+		const auto* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 0x100000001b3ULL;
+		}
+	};
+
+	for (const auto& diagnostic : diagnostics) {
+		const uint32_t fields[] = {
+			static_cast<uint32_t>(diagnostic.type),
+			diagnostic.start_line, diagnostic.start_column,
+			diagnostic.end_line, diagnostic.end_column,
+			static_cast<uint32_t>(diagnostic.message.size())
+		};
+		mix(fields, sizeof(fields));
+		mix(diagnostic.message.data(), diagnostic.message.size());
+	}
+	return hash;
+}
+
+std::string DiagnosticsTracker::to_result_id(uint64_t hash) {
+	char result_id[17];
+	std::snprintf(result_id, sizeof(result_id), "%016llx", static_cast<unsigned long long>(hash));
+	return result_id;
+}
+
+bool DiagnosticsTracker::record(const std::string& path, uint64_t hash) {
+	std::lock_guard<std::mutex> lock(tracker_mutex);
+	auto [it, inserted] = reported_hashes.try_emplace(path, hash);
+	if (inserted) return true;
+	if (it->second == hash) return false;
+	it->second = hash;
+	return true;
+}
+
+bool DiagnosticsTracker::is_outdated(const std::string& path, uint64_t hash) const {
+	std::lock_guard<std::mutex> lock(tracker_mutex);
+	auto it = reported_hashes.find(path);
+	return it != reported_hashes.end() && it->second != hash;
+}
+
+void DiagnosticsTracker::forget(const std::string& path) {
+	std::lock_guard<std::mutex> lock(tracker_mutex);
+	reported_hashes.erase(path);
+}
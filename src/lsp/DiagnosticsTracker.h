@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <bpp_include/bpp.h>
+
+/**
+ * @class DiagnosticsTracker
+ * @brief Remembers which diagnostics the client has already been sent for each document.
+ *
+ * Every reparse of a program produces diagnostics for every one of its source files,
+ * including all the library files it includes, which almost never change.
+ * The tracker keeps a hash of the last diagnostics reported for each file,
+ * so that the server only has to build, serialize and send the ones which have actually changed.
+ *
+ * The same hash serves as the resultId for pull diagnostics (textDocument/diagnostic):
+ * if the client already holds the current result, it's told so without being sent the diagnostics again.
+ *
+ * Entries are keyed by file path, as returned by validateUri, rather than by the URI the client sent,
+ * so that every handler agrees on the key no matter how the client spelled the URI.
+ *
+ * The server only ever has one client, so one tracker covers everything that client has been sent.
+ *
+ * All methods are thread-safe.
+ *
+ */
+class DiagnosticsTracker {
+	private:
+		std::unordered_map<std::string, uint64_t> reported_hashes; // Keyed by file path
+		mutable std::mutex tracker_mutex;
+	public:
+		static uint64_t hash(const std::vector<bpp::diagnostic>& diagnostics);
+		static std::string to_result_id(uint64_t hash);
+
+		/**
+		 * @brief Record that the client has been sent diagnostics with the given hash for the given file
+		 *
+		 * @return true if these differ from the diagnostics the client was last sent for the file
+		 */
+		bool record(const std::string& path, uint64_t hash);
+
+		/**
+		 * @brief Whether the client has been sent diagnostics for the given file, and they differ from these
+		 *
+		 * Files the client has never been sent anything for don't count as differing
+		 * (a client which pulls diagnostics will ask for them when it needs them).
+		 */
+		bool is_outdated(const std::string& path, uint64_t hash) const;
+
+		void forget(const std::string& path);
+};
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "DocumentVersionBarrier.h"
+
+#include <algorithm>
+
+std::shared_ptr<DocumentVersionBarrier::DocumentVersions> DocumentVersionBarrier::get_or_create(const std::string& uri) {
+	std::shared_ptr<DocumentVersions>& document = documents[uri];
+	if (document == nullptr) document = std::make_shared<DocumentVersions>();
+	return document;
+}
+
+void DocumentVersionBarrier::expect(const std::string& uri, int64_t version) {
+	std::lock_guard<std::mutex> lock(barrier_mutex);
+	std::shared_ptr<DocumentVersions> document = get_or_create(uri);
+	document->expected = std::max(document->expected, version);
+}
+
+void DocumentVersionBarrier::mark_applied(const std::string& uri, int64_t version) {
+	std::shared_ptr<DocumentVersions> document;
+	{
+		std::lock_guard<std::mutex> lock(barrier_mutex);
+		document = get_or_create(uri);
+		document->applied = std::max(document->applied, version);
+		document->expected = std::max(document->expected, version);
+	}
+	document->condition.notify_all();
+}
+
+void DocumentVersionBarrier::mark_analyzed(const std::string& uri, int64_t version) {
+	std::shared_ptr<DocumentVersions> document;
+	{
+		std::lock_guard<std::mutex> lock(barrier_mutex);
+		auto it = documents.find(uri);
+		if (it == documents.end()) return; // Closed in the meantime
+		document = it->second;
+		document->analyzed = std::max(document->analyzed, version);
+	}
+	document->condition.notify_all();
+}
+
+void DocumentVersionBarrier::reset(const std::string& uri, int64_t version) {
+	std::shared_ptr<DocumentVersions> document;
+	{
+		std::lock_guard<std::mutex> lock(barrier_mutex);
+		document = get_or_create(uri);
+		document->expected = std::max(document->expected, version);
+		document->applied = std::max(document->applied, version);
+		document->analyzed = std::max(document->analyzed, version);
+	}
+	document->condition.notify_all();
+}
+
+void DocumentVersionBarrier::forget(const std::string& uri) {
+	std::shared_ptr<DocumentVersions> document;
+	{
+		std::lock_guard<std::mutex> lock(barrier_mutex);
+		auto it = documents.find(uri);
+		if (it == documents.end()) return;
+		document = it->second;
+		document->forgotten = true;
+		documents.erase(it);
+	}
+	document->condition.notify_all();
+}
+
+int64_t DocumentVersionBarrier::get_expected_version(const std::string& uri) {
+	std::lock_guard<std::mutex> lock(barrier_mutex);
+	auto it = documents.find(uri);
+	if (it == documents.end()) return -1;
+	return it->second->expected;
+}
+
+bool DocumentVersionBarrier::wait_until(
+	const std::string& uri,
+	int64_t version,
+	Clock::time_point deadline,
+	int64_t DocumentVersions::* stage
+) {
+	std::unique_lock<std::mutex> lock(barrier_mutex);
+	auto it = documents.find(uri);
+	if (it == documents.end()) return true;
+
+	// Hold on to the document, in case it's forgotten while we wait
+	std::shared_ptr<DocumentVersions> document = it->second;
+	return document->condition.wait_until(lock, deadline, [&document, version, stage] {
+		return document->forgotten || (*document).*stage >= version;
+	});
+}
+
+bool DocumentVersionBarrier::wait_until_applied(const std::string& uri, int64_t version, Clock::time_point deadline) {
+	return wait_until(uri, version, deadline, &DocumentVersions::applied);
+}
+
+bool DocumentVersionBarrier::wait_until_analyzed(const std::string& uri, int64_t version, Clock::time_point deadline) {
+	return wait_until(uri, version, deadline, &DocumentVersions::analyzed);
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @class DocumentVersionBarrier
+ * @brief Tracks, per document, how far along each version of the document is, and lets requests wait for a given version.
+ *
+ * A version of a document goes through three stages:
+ *   1. Expected: the main loop has received a didChange carrying this version
+ *   2. Applied: the didChange has been handled, and the edits are in the document store
+ *   3. Analyzed: a reparse which includes those edits has finished
+ *
+ * Requests which depend on up-to-date analysis (e.g., completion) look up the newest expected version
+ * and wait until it has been analyzed. Each document has its own condition variable,
+ * so waiting on one document is never held up by reparses of another.
+ *
+ * Versions are the LSP's document versions. A document which isn't being tracked has no expected version,
+ * and waiting on it returns immediately.
+ *
+ */
+class DocumentVersionBarrier {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+	private:
+		struct DocumentVersions {
+			int64_t expected = -1;
+			int64_t applied = -1;
+			int64_t analyzed = -1;
+			bool forgotten = false; // Set when the document is closed, releasing anybody still waiting on it
+			std::condition_variable condition;
+		};
+
+		std::unordered_map<std::string, std::shared_ptr<DocumentVersions>> documents;
+		std::mutex barrier_mutex;
+
+		std::shared_ptr<DocumentVersions> get_or_create(const std::string& uri);
+		bool wait_until(const std::string& uri, int64_t version, Clock::time_point deadline, int64_t DocumentVersions::* stage);
+	public:
+		/**
+		 * @class StageMarker
+		 * @brief Marks a version as applied or analyzed when it goes out of scope, however the scope is left
+		 *
+		 * If the work for a version throws, requests waiting on it are still released straight away,
+		 * instead of being left to time out.
+		 */
+		class StageMarker {
+			private:
+				DocumentVersionBarrier* barrier;
+				std::string uri;
+				int64_t version;
+				void (DocumentVersionBarrier::*mark)(const std::string&, int64_t);
+			public:
+				StageMarker(
+					DocumentVersionBarrier* barrier,
+					std::string uri,
+					int64_t version,
+					void (DocumentVersionBarrier::*mark)(const std::string&, int64_t)
+				) : barrier(barrier), uri(std::move(uri)), version(version), mark(mark) {}
+				~StageMarker() { (barrier->*mark)(uri, version); }
+
+				StageMarker(const StageMarker&) = delete;
+				StageMarker& operator=(const StageMarker&) = delete;
+				StageMarker(StageMarker&&) = delete;
+				StageMarker& operator=(StageMarker&&) = delete;
+		};
+
+		/**
+		 * @brief Record that the client has sent the given version of the document
+		 */
+		void expect(const std::string& uri, int64_t version);
+
+		/**
+		 * @brief Record that the edits up to the given version have been applied to the document store
+		 */
+		void mark_applied(const std::string& uri, int64_t version);
+
+		/**
+		 * @brief Record that a reparse including the edits up to the given version has finished
+		 *
+		 * This is also called when such a reparse fails, since no better analysis for that version is coming.
+		 */
+		void mark_analyzed(const std::string& uri, int64_t version);
+
+		[[nodiscard]] StageMarker mark_applied_on_exit(const std::string& uri, int64_t version) {
+			return StageMarker(this, uri, version, &DocumentVersionBarrier::mark_applied);
+		}
+		[[nodiscard]] StageMarker mark_analyzed_on_exit(const std::string& uri, int64_t version) {
+			return StageMarker(this, uri, version, &DocumentVersionBarrier::mark_analyzed);
+		}
+
+		/**
+		 * @brief Start tracking a document (e.g., on didOpen) with the given version already analyzed
+		 */
+		void reset(const std::string& uri, int64_t version);
+
+		/**
+		 * @brief Stop tracking a document, and release any requests still waiting on it
+		 */
+		void forget(const std::string& uri);
+
+		/**
+		 * @brief The newest version of the document the client has sent, or -1 if it isn't being tracked
+		 */
+		int64_t get_expected_version(const std::string& uri);
+
+		/**
+		 * @brief Wait until the given version has been applied, or until the deadline passes
+		 *
+		 * @return true if the version has been applied (or the document isn't being tracked), false on timeout
+		 */
+		bool wait_until_applied(const std::string& uri, int64_t version, Clock::time_point deadline);
+
+		/**
+		 * @brief Wait until the given version has been analyzed, or until the deadline passes
+		 *
+		 * @return true if the version has been analyzed (or the document isn't being tracked), false on timeout
+		 */
+		bool wait_until_analyzed(const std::string& uri, int64_t version, Clock::time_point deadline);
+};
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "FrameReader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <unistd.h>
+
+FrameReader::FrameReader(int fd) : fd(fd) {}
+
+bool FrameReader::fill() {
+	if (buffer_start > 0) {
+		// Move the unconsumed bytes to the front of the buffer
+		std::memmove(buffer.data(), buffer.data() + buffer_start, buffer_end - buffer_start);
+		buffer_end -= buffer_start;
+		buffer_start = 0;
+	}
+	if (buffer_end == buffer.size()) {
+		// Only happens if a header block is larger than the whole buffer
+		buffer.resize(buffer.size() * 2);
+	}
+
+	while (true) {
+		const ssize_t bytes_read = read(fd, buffer.data() + buffer_end, buffer.size() - buffer_end);
+		if (bytes_read > 0) {
+			buffer_end += static_cast<size_t>(bytes_read);
+			return true;
+		}
+		if (bytes_read < 0 && errno == EINTR) continue;
+		return false; // EOF or error
+	}
+}
+
+std::optional<std::string> FrameReader::next_message() {
+	constexpr std::string_view content_length_header = "Content-Length:";
+	constexpr std::string_view header_terminator = "\r\n\r\n";
+
+	while (true) {
+		// Find the end of the header block
+		std::string_view pending(buffer.data() + buffer_start, buffer_end - buffer_start);
+		const size_t header_end = pending.find(header_terminator);
+		if (header_end == std::string_view::npos) {
+			if (!fill()) return std::nullopt;
+			continue;
+		}
+
+		// Parse the header block in place
+		const std::string_view headers = pending.substr(0, header_end);
+		buffer_start += header_end + header_terminator.size();
+
+		size_t content_length = 0;
+		size_t line_start = 0;
+		while (line_start <= headers.size()) {
+			size_t line_end = headers.find("\r\n", line_start);
+			if (line_end == std::string_view::npos) line_end = headers.size();
+			const std::string_view line = headers.substr(line_start, line_end - line_start);
+
+			if (line.starts_with(content_length_header)) {
+				std::string_view value = line.substr(content_length_header.size());
+				while (!value.empty() && value.front() == ' ') value.remove_prefix(1);
+				std::from_chars(value.data(), value.data() + value.size(), content_length);
+			}
+			line_start = line_end + 2;
+		}
+
+		if (content_length == 0) continue; // Malformed or empty frame, skip it
+
+		// Assemble the body: first from what we've already buffered, then straight from the fd
+		std::string body(content_length, '\0');
+		const size_t buffered = std::min(content_length, buffer_end - buffer_start);
+		std::memcpy(body.data(), buffer.data() + buffer_start, buffered);
+		buffer_start += buffered;
+
+		size_t received = buffered;
+		while (received < content_length) {
+			const ssize_t bytes_read = read(fd, body.data() + received, content_length - received);
+			if (bytes_read > 0) {
+				received += static_cast<size_t>(bytes_read);
+				continue;
+			}
+			if (bytes_read < 0 && errno == EINTR) continue;
+			return std::nullopt; // EOF or error in the middle of a message
+		}
+
+		return body;
+	}
+}
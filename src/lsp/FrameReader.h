@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @class FrameReader
+ * @brief Reads LSP base protocol frames ("Content-Length: N\r\n...\r\n\r\n{body}") from a file descriptor.
+ *
+ * Input is read from the fd in large chunks into a single buffer, and headers are parsed in place.
+ * Each message body is assembled directly into the string which is returned to the caller:
+ * whatever part of it is already buffered is copied over once, and the remainder is read straight into it.
+ * The caller can then move that string wherever it needs to go without any further copies.
+ *
+ */
+class FrameReader {
+	private:
+		static constexpr size_t chunk_size = 64 * 1024;
+
+		int fd;
+		std::vector<char> buffer = std::vector<char>(chunk_size);
+		size_t buffer_start = 0; // First unconsumed byte in the buffer
+		size_t buffer_end = 0; // One past the last valid byte in the buffer
+
+		/**
+		 * @brief Read more input into the buffer, compacting or growing it as necessary
+		 *
+		 * @return false on EOF or error
+		 */
+		bool fill();
+	public:
+		explicit FrameReader(int fd);
+
+		/**
+		 * @brief Read the body of the next message
+		 *
+		 * Frames without a (valid, nonzero) Content-Length header are skipped.
+		 *
+		 * @return std::optional<std::string> The message body, or std::nullopt on EOF or error.
+		 */
+		std::optional<std::string> next_message();
+};
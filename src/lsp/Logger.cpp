@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "Logger.h"
+
+#include <algorithm>
+#include <ctime>
+#include <stdexcept>
+
+Logger::MessageBuffer::MessageBuffer(size_t max_length) : max_length(max_length) {}
+
+Logger::MessageBuffer::int_type Logger::MessageBuffer::overflow(int_type c) {
+	if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+	if (text.size() < max_length) {
+		text.push_back(traits_type::to_char_type(c));
+	} else {
+		discarded_bytes++;
+	}
+	return c;
+}
+
+std::streamsize Logger::MessageBuffer::xsputn(const char* s, std::streamsize n) {
+	const size_t length = static_cast<size_t>(n);
+	const size_t kept = std::min(length, max_length - std::min(max_length, text.size()));
+	text.append(s, kept);
+	discarded_bytes += length - kept;
+	return n;
+}
+
+std::string Logger::MessageBuffer::take() {
+	if (discarded_bytes > 0) {
+		text += "... (" + std::to_string(discarded_bytes) + " more bytes)";
+		discarded_bytes = 0;
+	}
+	return std::move(text);
+}
+
+Logger::Logger() : slots(std::make_unique<Slot[]>(ring_capacity)), pid(getpid()) {
+	for (size_t i = 0; i < ring_capacity; i++) {
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+Logger::~Logger() {
+	close();
+}
+
+void Logger::open(const std::string& path) {
+	close();
+	log_file.open(path, std::ios::app);
+	if (!log_file.is_open()) throw std::runtime_error("Failed to open log file: " + path);
+
+	stopping.store(false, std::memory_order_release);
+	writer_thread = std::thread([this] { this->run(); });
+	active.store(true, std::memory_order_release);
+}
+
+void Logger::close() {
+	if (!writer_thread.joinable()) return;
+
+	active.store(false, std::memory_order_release);
+	stopping.store(true, std::memory_order_release);
+	wakeups.fetch_add(1, std::memory_order_release);
+	wakeups.notify_one();
+	writer_thread.join();
+	log_file.close();
+}
+
+bool Logger::enabled(Level message_level) const {
+	return active.load(std::memory_order_acquire) && message_level <= level.load(std::memory_order_relaxed);
+}
+
+bool Logger::try_push(Entry&& entry) {
+	size_t position = enqueue_position.load(std::memory_order_relaxed);
+	while (true) {
+		Slot& slot = slots[position & (ring_capacity - 1)];
+		const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+		if (difference == 0) {
+			// The slot is free for this position; try to claim it
+			if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				slot.entry = std::move(entry);
+				slot.sequence.store(position + 1, std::memory_order_release); // Publish
+				return true;
+			}
+			// Another producer got there first; 'position' has been reloaded by the failed CAS
+		} else if (difference < 0) {
+			return false; // The ring is full: the consumer hasn't freed this slot from the previous lap
+		} else {
+			position = enqueue_position.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+bool Logger::try_pop(Entry* entry) {
+	Slot& slot = slots[dequeue_position & (ring_capacity - 1)];
+	if (slot.sequence.load(std::memory_order_acquire) != dequeue_position + 1) return false; // Not yet published
+
+	*entry = std::move(slot.entry);
+	slot.sequence.store(dequeue_position + ring_capacity, std::memory_order_release); // Free the slot for the next lap
+	dequeue_position++;
+	return true;
+}
+
+void Logger::write(Level message_level, std::string text) {
+	if (!enabled(message_level)) return;
+
+	if (!try_push(Entry{std::chrono::system_clock::now(), message_level, std::move(text)})) {
+		dropped_messages.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	wakeups.fetch_add(1, std::memory_order_release);
+	wakeups.notify_one();
+}
+
+void Logger::run() {
+	const std::string pid_string = "[" + std::to_string(pid) + "] ";
+	std::string batch;
+	Entry entry;
+
+	// The timestamp prefix only changes once per second, so it's only reformatted when it does
+	std::time_t last_time = -1;
+	char timestamp[32] = "";
+	uint64_t reported_dropped_messages = 0;
+
+	while (true) {
+		const uint32_t seen_wakeups = wakeups.load(std::memory_order_acquire);
+
+		batch.clear();
+		while (try_pop(&entry)) {
+			const std::time_t time = std::chrono::system_clock::to_time_t(entry.time);
+			if (time != last_time) {
+				std::tm tm_buf{};
+				localtime_r(&time, &tm_buf);
+				std::strftime(timestamp, sizeof(timestamp), "[%Y-%m-%d %H:%M:%S] ", &tm_buf);
+				last_time = time;
+			}
+			batch += timestamp;
+			batch += pid_string;
+			if (entry.level != Level::Info) {
+				batch += "[";
+				batch += level_to_string(entry.level);
+				batch += "] ";
+			}
+			batch += entry.text;
+			batch += '\n';
+		}
+
+		const uint64_t dropped = dropped_messages.load(std::memory_order_relaxed);
+		if (dropped != reported_dropped_messages) {
+			batch += pid_string + "Log buffer full: dropped "
+				+ std::to_string(dropped - reported_dropped_messages) + " messages\n";
+			reported_dropped_messages = dropped;
+		}
+
+		if (!batch.empty()) {
+			log_file.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+			log_file.flush();
+		}
+
+		if (stopping.load(std::memory_order_acquire)) {
+			// Producers may still have raced a message in after the last pop
+			if (slots[dequeue_position & (ring_capacity - 1)].sequence.load(std::memory_order_acquire) != dequeue_position + 1) {
+				return;
+			}
+			continue;
+		}
+
+		wakeups.wait(seen_wakeups, std::memory_order_acquire);
+	}
+}
+
+void Logger::set_level(Level new_level) {
+	level.store(new_level, std::memory_order_relaxed);
+}
+
+void Logger::set_max_message_length(size_t length) {
+	max_message_length.store(length, std::memory_order_relaxed);
+}
+
+size_t Logger::get_max_message_length() const {
+	return max_message_length.load(std::memory_order_relaxed);
+}
+
+std::optional<Logger::Level> Logger::level_from_string(std::string_view name) {
+	if (name == "error") return Level::Error;
+	if (name == "warning") return Level::Warning;
+	if (name == "info") return Level::Info;
+	if (name == "debug") return Level::Debug;
+	return std::nullopt;
+}
+
+const char* Logger::level_to_string(Level level) {
+	switch (level) {
+		case Level::Error:
+			return "ERROR";
+		case Level::Warning:
+			return "WARNING";
+		case Level::Info:
+			return "INFO";
+		case Level::Debug:
+			return "DEBUG";
+	}
+	return "";
+}
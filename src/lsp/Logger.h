@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+
+/**
+ * @class Logger
+ * @brief An asynchronous logger which keeps formatting and file I/O off of the threads doing the logging.
+ *
+ * Log calls hand their (already-formatted, possibly truncated) message to a bounded lock-free ring buffer
+ * and return immediately. A background thread drains the ring, adds timestamps,
+ * and writes out everything it finds in a single write per batch.
+ *
+ * The ring is a bounded multi-producer queue in which every slot carries a sequence number:
+ * producers claim a position with a CAS on the enqueue position, fill in the slot,
+ * and then publish it by advancing the slot's sequence number. The single consumer never takes a lock.
+ *
+ * If the ring is full, the message is dropped rather than blocking the caller.
+ * The number of dropped messages is reported in the log itself.
+ *
+ */
+class Logger {
+	public:
+		enum class Level : uint8_t {
+			Error,
+			Warning,
+			Info,
+			Debug
+		};
+
+		static constexpr size_t default_max_message_length = 4096;
+
+		/**
+		 * @class MessageBuffer
+		 * @brief A stream buffer which keeps at most a given number of bytes, and only counts the rest
+		 *
+		 * Used to format log messages without ever copying more of a large payload than will be kept.
+		 */
+		class MessageBuffer : public std::streambuf {
+			private:
+				std::string text;
+				size_t max_length;
+				size_t discarded_bytes = 0;
+			protected:
+				int_type overflow(int_type c) override;
+				std::streamsize xsputn(const char* s, std::streamsize n) override;
+			public:
+				explicit MessageBuffer(size_t max_length);
+
+				/**
+				 * @brief Take the formatted message, noting how many bytes were cut off (if any)
+				 */
+				std::string take();
+		};
+
+	private:
+		struct Entry {
+			std::chrono::system_clock::time_point time;
+			Level level = Level::Info;
+			std::string text;
+		};
+
+		struct Slot {
+			std::atomic<size_t> sequence;
+			Entry entry;
+		};
+
+		static constexpr size_t ring_capacity = 4096; // Must be a power of two
+
+		std::unique_ptr<Slot[]> slots;
+		alignas(64) std::atomic<size_t> enqueue_position = 0;
+		alignas(64) size_t dequeue_position = 0; // Only touched by the writer thread
+
+		std::atomic<uint32_t> wakeups = 0; // Bumped (and waited on) to wake the writer thread
+		std::atomic<uint64_t> dropped_messages = 0;
+		std::atomic<bool> stopping = false;
+		std::atomic<bool> active = false; // Whether a log file is open and the writer thread is running
+		std::atomic<Level> level = Level::Info;
+		std::atomic<size_t> max_message_length = default_max_message_length;
+
+		pid_t pid;
+		std::ofstream log_file;
+		std::thread writer_thread;
+
+		bool try_push(Entry&& entry);
+		bool try_pop(Entry* entry);
+		void run();
+	public:
+		Logger();
+		~Logger();
+
+		Logger(const Logger&) = delete;
+		Logger& operator=(const Logger&) = delete;
+		Logger(Logger&&) = delete;
+		Logger& operator=(Logger&&) = delete;
+
+		/**
+		 * @brief Open the log file (in append mode) and start the writer thread
+		 *
+		 * @throws std::runtime_error if the file can't be opened
+		 */
+		void open(const std::string& path);
+
+		/**
+		 * @brief Write out everything still in the ring, stop the writer thread and close the file
+		 */
+		void close();
+
+		/**
+		 * @brief Whether a message at the given level would be written at all
+		 *
+		 * Callers should check this before formatting anything.
+		 */
+		bool enabled(Level message_level) const;
+
+		/**
+		 * @brief Queue a message to be written
+		 *
+		 * Never blocks. If the ring is full, the message is dropped.
+		 */
+		void write(Level message_level, std::string text);
+
+		void set_level(Level new_level);
+		void set_max_message_length(size_t length);
+		size_t get_max_message_length() const;
+
+		static std::optional<Level> level_from_string(std::string_view name);
+		static const char* level_to_string(Level level);
+};
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "MessagePeek.h"
+
+#include <vector>
+#include <nlohmann/json.hpp>
+
+static constexpr const char* did_change_method = "textDocument/didChange";
+
+/**
+ * @class MessagePeek::Handler
+ * @brief SAX handler which records the fields of interest and ignores everything else
+ *
+ * Tracks the path to the current value as a stack of containers,
+ * each holding the key most recently seen in it (objects) or nothing (arrays)
+ */
+class MessagePeek::Handler : public nlohmann::json_sax<nlohmann::json> {
+	private:
+		struct Container {
+			bool is_object;
+			std::string key;
+			bool has_range = false; // Only meaningful for elements of params.contentChanges
+		};
+		std::vector<Container> path;
+		MessagePeek& result;
+
+		bool at_key(size_t depth, const char* key) const {
+			return path.size() > depth && path[depth].is_object && path[depth].key == key;
+		}
+
+		// Values directly inside the root object
+		bool at_root(const char* key) const {
+			return path.size() == 1 && at_key(0, key);
+		}
+
+		// Values directly inside params.textDocument
+		bool at_text_document(const char* key) const {
+			return path.size() == 3 && at_key(0, "params") && at_key(1, "textDocument") && at_key(2, key);
+		}
+
+		// The elements of params.contentChanges
+		bool at_content_change() const {
+			return path.size() == 4 && at_key(0, "params") && at_key(1, "contentChanges") && !path[2].is_object;
+		}
+
+		template <typename Number>
+		bool number(Number value) {
+			if (at_text_document("version")) result.version = static_cast<int64_t>(value);
+			return true;
+		}
+	public:
+		explicit Handler(MessagePeek& result) : result(result) {}
+
+		bool null() override { return true; }
+		bool boolean(bool) override { return true; }
+		bool number_integer(number_integer_t value) override { return number(value); }
+		bool number_unsigned(number_unsigned_t value) override { return number(value); }
+		bool number_float(number_float_t, const string_t&) override { return true; }
+		bool binary(binary_t&) override { return true; }
+
+		bool string(string_t& value) override {
+			if (at_root("method")) {
+				result.method = value;
+				// Nothing else to learn from messages other than didChange notifications
+				return result.method == did_change_method;
+			}
+			if (at_text_document("uri")) result.uri = value;
+			return true;
+		}
+
+		bool key(string_t& value) override {
+			path.back().key = value;
+			if (at_root("id")) result.is_request = true;
+			if (at_content_change() && value == "range") path.back().has_range = true;
+			return true;
+		}
+
+		bool start_object(std::size_t) override {
+			path.push_back({true, ""});
+			return true;
+		}
+
+		bool end_object() override {
+			if (at_content_change() && !path.back().has_range) result.replaces_whole_document = true;
+			path.pop_back();
+			return true;
+		}
+
+		bool start_array(std::size_t) override {
+			path.push_back({false, ""});
+			return true;
+		}
+
+		bool end_array() override {
+			path.pop_back();
+			return true;
+		}
+
+		bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+			return false;
+		}
+};
+
+MessagePeek MessagePeek::peek(const std::string& message) {
+	MessagePeek result;
+	Handler handler(result);
+	const bool completed = nlohmann::json::sax_parse(message, &handler);
+
+	// The scan only stops early by design once the method has turned out to be uninteresting
+	result.valid = completed || (!result.method.empty() && result.method != did_change_method);
+
+	if (!result.valid || result.method != did_change_method || result.is_request) {
+		result.uri.clear();
+		result.version.reset();
+		result.replaces_whole_document = false;
+	}
+	return result;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/**
+ * @struct MessagePeek
+ * @brief The few fields of a raw message which the transport layer needs before the message is fully parsed.
+ *
+ * The body is scanned with a SAX parser, which builds no DOM and doesn't convert anything to LSP types.
+ * Scanning stops as soon as the method turns out to be something other than textDocument/didChange,
+ * so for most messages only the first few bytes are looked at.
+ *
+ * This is what lets the main loop work out that a queued didChange has been superseded
+ * by a later one, without ever parsing the superseded one.
+ *
+ */
+struct MessagePeek {
+	bool valid = false; // False if the message couldn't be scanned (it will be reported when fully parsed)
+	bool is_request = false; // Whether the message has an 'id'
+	std::string method;
+
+	// Only filled in for textDocument/didChange notifications:
+	std::string uri; // params.textDocument.uri
+	std::optional<int64_t> version; // params.textDocument.version
+	bool replaces_whole_document = false; // Whether any of params.contentChanges has no range (i.e., is a full-document change)
+
+	static MessagePeek peek(const std::string& message);
+
+	private:
+		class Handler; // The SAX handler which fills in these fields
+};
@@ -4,7 +4,9 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 
+#include <filesystem>
 #include <fstream>
+#include <unordered_set>
 
 #include "ProgramPool.h"
 
@@ -15,10 +17,7 @@
 
 #include <bpp_include/bpp_program.h>
 
-ProgramPool::ProgramPool(size_t max_programs) : max_programs(max_programs) {
-	// Initialize the program pool with a maximum number of programs
-	programs.reserve(max_programs);
-}
+ProgramPool::ProgramPool(size_t memory_budget_in_bytes) : memory_budget_in_bytes(memory_budget_in_bytes) {}
 
 void ProgramPool::add_include_path(const std::string& path) {
 	include_paths->push_back(path);
@@ -40,17 +39,97 @@ void ProgramPool::set_target_bash_version(const BashVersion& version) {
 	target_bash_version = version;
 }
 
+void ProgramPool::set_memory_budget(size_t bytes) {
+	memory_budget_in_bytes = bytes;
+}
+
+size_t ProgramPool::get_memory_budget() const {
+	return memory_budget_in_bytes;
+}
+
+size_t ProgramPool::get_memory_usage() {
+	std::lock_guard<std::mutex> lock(usage_mutex);
+	size_t total = 0;
+	std::unordered_set<const AST::Program*> counted_asts;
+	for (const auto& [main_source_file, usage] : program_usage) {
+		total += usage.estimated_size_in_bytes;
+		for (const auto& [ast, size] : usage.ast_sizes) {
+			if (counted_asts.insert(ast).second) total += size;
+		}
+	}
+	return total;
+}
+
+size_t ProgramPool::get_program_count() {
+	std::lock_guard<std::recursive_mutex> lock(pool_mutex);
+	return programs.size();
+}
+
+size_t ProgramPool::warm_parse_cache(const std::string& directory) {
+	size_t parsed_files = 0;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		if (!entry.is_regular_file(error)) continue;
+
+		std::shared_ptr<const std::string> contents = AST::ParseCache::read_file(entry.path().string());
+		if (contents == nullptr) continue;
+		if (parse_cache->lookup(contents, utf16_mode) != nullptr) continue; // Already parsed
+
+		try {
+			AST::BashppParser parser;
+			parser.setUTF16Mode(utf16_mode);
+			parser.setInputFromStringContents(contents);
+			auto program = parser.program();
+			if (program == nullptr || !parser.get_errors().empty()) continue;
+
+			parse_cache->store(contents, utf16_mode, program, true);
+			parsed_files++;
+		} catch (...) {
+			continue; // Not our problem until somebody includes it
+		}
+	}
+	return parsed_files;
+}
+
 void ProgramPool::set_unsaved_file_contents(const std::string& file_path, const std::string& contents) {
 	{
-		std::lock_guard<std::recursive_mutex> lock(pool_mutex);
-		unsaved_changes[file_path] = contents;
+		std::lock_guard<std::mutex> lock(unsaved_changes_mutex);
+		auto it = unsaved_changes.find(file_path);
+		if (it != unsaved_changes.end()) {
+			it->second->replace_contents(contents);
+			return; // The set of documents hasn't changed, no need to update the snapshot
+		}
+		unsaved_changes[file_path] = std::make_shared<TextDocument>(contents);
 	}
 	update_snapshot();
 }
 
+void ProgramPool::apply_unsaved_file_change(
+	const std::string& file_path,
+	uint32_t start_line, uint32_t start_character,
+	uint32_t end_line, uint32_t end_character,
+	const std::string& text
+) {
+	std::shared_ptr<TextDocument> document;
+	{
+		std::lock_guard<std::mutex> lock(unsaved_changes_mutex);
+		auto it = unsaved_changes.find(file_path);
+		if (it != unsaved_changes.end()) document = it->second;
+	}
+
+	if (document == nullptr) {
+		// No in-editor changes yet: the edit applies to the contents on disk
+		set_unsaved_file_contents(file_path, get_file_contents(file_path));
+		std::lock_guard<std::mutex> lock(unsaved_changes_mutex);
+		document = unsaved_changes[file_path];
+	}
+
+	document->apply_edit(start_line, start_character, end_line, end_character, text, utf16_mode);
+}
+
 void ProgramPool::remove_unsaved_file_contents(const std::string& file_path) {
 	{
-		std::lock_guard<std::recursive_mutex> lock(pool_mutex);
+		std::lock_guard<std::mutex> lock(unsaved_changes_mutex);
 		auto it = unsaved_changes.find(file_path);
 		if (it != unsaved_changes.end()) {
 			unsaved_changes.erase(it);
@@ -63,10 +142,10 @@ std::string ProgramPool::get_file_contents(const std::string& file_path) {
 	// If a copy exists in unsaved_changes, return that
 	// Otherwise, read from the file on disk
 	{
-		std::lock_guard<std::recursive_mutex> lock(pool_mutex);
+		std::lock_guard<std::mutex> lock(unsaved_changes_mutex);
 		auto it = unsaved_changes.find(file_path);
 		if (it != unsaved_changes.end()) {
-			return it->second;
+			return *it->second->get_contents();
 		}
 	}
 
@@ -79,8 +158,45 @@ std::string ProgramPool::get_file_contents(const std::string& file_path) {
 	return contents;
 }
 
-void ProgramPool::_remove_oldest_program() {
-	_remove_program(0);
+void ProgramPool::_touch_program(const std::shared_ptr<bpp::bpp_program>& program) {
+	if (program == nullptr) return;
+	const uint64_t now = access_clock.fetch_add(1, std::memory_order_relaxed) + 1;
+	std::lock_guard<std::mutex> lock(usage_mutex);
+	auto it = program_usage.find(program->get_main_source_file());
+	if (it != program_usage.end()) it->second.last_access = now;
+}
+
+void ProgramPool::_record_program_size(const std::shared_ptr<bpp::bpp_program>& program) {
+	if (program == nullptr) return;
+	ProgramUsage usage;
+	usage.estimated_size_in_bytes = program->estimate_memory_usage();
+	for (const auto& ast : program->get_source_file_asts()) {
+		usage.ast_sizes.emplace_back(ast.get(), ast->memory_usage());
+	}
+	usage.last_access = access_clock.fetch_add(1, std::memory_order_relaxed) + 1;
+	std::lock_guard<std::mutex> lock(usage_mutex);
+	program_usage[program->get_main_source_file()] = std::move(usage);
+}
+
+void ProgramPool::_evict_to_budget() {
+	std::lock_guard<std::recursive_mutex> lock(pool_mutex);
+	// Always keep at least one program, however large
+	while (programs.size() > 1 && get_memory_usage() > memory_budget_in_bytes) {
+		size_t least_recently_used_index = 0;
+		uint64_t least_recent_access = UINT64_MAX;
+		{
+			std::lock_guard<std::mutex> usage_lock(usage_mutex);
+			for (size_t i = 0; i < programs.size(); i++) {
+				auto it = program_usage.find(programs[i]->get_main_source_file());
+				const uint64_t last_access = (it != program_usage.end()) ? it->second.last_access : 0;
+				if (last_access < least_recent_access) {
+					least_recent_access = last_access;
+					least_recently_used_index = i;
+				}
+			}
+		}
+		_remove_program(least_recently_used_index);
+	}
 }
 
 void ProgramPool::update_snapshot() {
@@ -90,6 +206,9 @@ void ProgramPool::update_snapshot() {
 		new_snapshot->programs_snapshot = programs;
 		new_snapshot->program_indices_snapshot = program_indices;
 		new_snapshot->open_files_snapshot = open_files;
+	}
+	{
+		std::lock_guard<std::mutex> lock(unsaved_changes_mutex);
 		new_snapshot->unsaved_changes_snapshot = unsaved_changes;
 	}
 	{
@@ -114,6 +233,9 @@ void ProgramPool::_remove_program(size_t index) {
 		for (const auto& file_path : program->get_source_files()) {
 			open_files.erase(file_path); // Remove the file from the open files map
 		}
+
+		std::lock_guard<std::mutex> usage_lock(usage_mutex);
+		program_usage.erase(program->get_main_source_file());
 	}
 
 	// Remove the program at the specified index
@@ -128,6 +250,10 @@ void ProgramPool::_remove_program(size_t index) {
 		});
 	}
 	std::erase_if(program_indices, [](const auto& pair) { return pair.second.empty(); }); // Clean up any file paths with no associated programs
+
+	// Drop any cached ASTs that were only being used by the removed program
+	program.reset();
+	parse_cache->prune();
 }
 
 std::shared_ptr<bpp::bpp_program> ProgramPool::_parse_program(const std::string& file_path) {
@@ -145,30 +271,54 @@ std::shared_ptr<bpp::bpp_program> ProgramPool::_parse_program(const std::string&
 		listener.set_suppress_warnings(suppress_warnings);
 		listener.set_include_paths(include_paths);
 		listener.set_target_bash_version(target_bash_version);
+		listener.set_optimization_level(0); // The compiled code is discarded anyway
 		listener.set_lsp_mode(true);
 		listener.set_utf16_mode(utf16_mode);
-		for (const auto& pair : unsaved_changes) {
-			listener.set_replacement_file_contents(pair.first, pair.second);
+
+		// Only now do we need contiguous copies of the in-editor documents
+		std::shared_ptr<const std::string> main_file_contents;
+		{
+			std::lock_guard<std::mutex> lock(unsaved_changes_mutex);
+			for (const auto& [path, document] : unsaved_changes) {
+				std::shared_ptr<const std::string> contents = document->get_contents();
+				if (path == file_path) main_file_contents = contents;
+				listener.set_replacement_file_contents(path, std::move(contents));
+			}
 		}
 
-		AST::BashppParser parser;
-		parser.setUTF16Mode(utf16_mode);
+		listener.set_parse_cache(parse_cache);
 
-		if (unsaved_changes.contains(file_path)) {
-			parser.setInputFromStringContents(unsaved_changes[file_path]);
-		} else {
-			parser.setInputFromFilePath(file_path);
-		}
+		// Only re-parse the main file if it's changed since the last time we parsed it
+		// (E.g., if the edit which triggered this re-parse was made to one of its included files)
+		if (main_file_contents == nullptr) main_file_contents = AST::ParseCache::read_file(file_path);
+		auto program = parse_cache->lookup(main_file_contents, utf16_mode);
 
-		auto program = parser.program();
-		listener.set_parser_errors(parser.get_errors());
 		if (program == nullptr) {
-			program = std::make_shared<AST::Program>(); // Parsing failed
+			AST::BashppParser parser;
+			parser.setUTF16Mode(utf16_mode);
+
+			if (main_file_contents != nullptr) {
+				parser.setInputFromStringContents(main_file_contents);
+			} else {
+				parser.setInputFromFilePath(file_path);
+			}
+
+			program = parser.program();
+			listener.set_parser_errors(parser.get_errors());
+			if (program == nullptr) {
+				program = std::make_shared<AST::Program>(); // Parsing failed
+			} else if (parser.get_errors().empty()) {
+				parse_cache->store(main_file_contents, utf16_mode, program);
+			}
 		}
 
 		// Walk the tree
 		listener.walk(program);
-		return listener.get_program();
+
+		// Index the finished program for position lookups
+		std::shared_ptr<bpp::bpp_program> result = listener.get_program();
+		if (result != nullptr) result->build_position_indices();
+		return result;
 	} catch (const std::exception& e) {
 		std::cerr << "Error while parsing program: " << e.what() << std::endl;
 		return nullptr; // Return nullptr if parsing fails
@@ -192,6 +342,7 @@ std::shared_ptr<bpp::bpp_program> ProgramPool::get_program(const std::string& fi
 		// TODO(@rail5): Review this decision in the future
 		const std::vector<size_t>& indices = snapshot_copy.program_indices_snapshot[file_path];
 		if (indices.empty()) return nullptr; // No programs associated with this file path, shouldn't happen since we checked contains() but just in case
+		_touch_program(snapshot_copy.programs_snapshot[indices[0]]);
 		return snapshot_copy.programs_snapshot[indices[0]];
 	}
 
@@ -202,17 +353,18 @@ std::shared_ptr<bpp::bpp_program> ProgramPool::get_program(const std::string& fi
 		// Check if the program is already in the pool
 		if (program_indices.contains(file_path)) {
 			const std::vector<size_t>& indices = program_indices[file_path];
-			if (!indices.empty()) return programs[indices[0]]; // Return the first program associated with this file path
+			if (!indices.empty()) {
+				_touch_program(programs[indices[0]]);
+				return programs[indices[0]]; // Return the first program associated with this file path
+			}
 		}
 
-		// If the pool is full, remove the oldest program
-		if (programs.size() >= max_programs) _remove_oldest_program();
-
 		// Create a new program and add it to the pool
 		new_program = _parse_program(file_path);
 		if (new_program == nullptr) return nullptr; // Return nullptr if parsing fails
 
 		programs.push_back(new_program);
+		_record_program_size(new_program);
 		size_t index = programs.size() - 1;
 		for (const auto& path : new_program->get_source_files()) {
 			auto& indices_for_path = program_indices[path];
@@ -236,6 +388,9 @@ std::shared_ptr<bpp::bpp_program> ProgramPool::get_program(const std::string& fi
 				i--; // Decrement i to account for the removed program
 			}
 		}
+
+		// Make room for the new program by evicting the least recently used ones
+		_evict_to_budget();
 	}
 
 	update_snapshot();
@@ -257,6 +412,7 @@ std::vector<std::shared_ptr<bpp::bpp_program>> ProgramPool::get_programs_for_fil
 		programs_for_file.reserve(indices.size());
 		for (size_t index : indices) {
 			programs_for_file.push_back(snapshot_copy.programs_snapshot[index]);
+			_touch_program(programs_for_file.back());
 		}
 		return programs_for_file;
 	}
@@ -270,6 +426,7 @@ std::vector<std::shared_ptr<bpp::bpp_program>> ProgramPool::get_programs_for_fil
 			programs_for_file.reserve(indices.size());
 			for (size_t index : indices) {
 				programs_for_file.push_back(programs[index]);
+				_touch_program(programs_for_file.back());
 			}
 			return programs_for_file; // Return all programs associated with this file path
 		}
@@ -305,6 +462,7 @@ std::vector<std::shared_ptr<bpp::bpp_program>> ProgramPool::re_parse_programs(co
 			if (new_program != nullptr) {
 				successful_reparses.push_back(new_program);
 				programs[index] = new_program;
+				_record_program_size(new_program);
 
 				// The new AST may reference a different set of source files than the old AST,
 				// so we need to update the program_indices map accordingly
@@ -323,6 +481,9 @@ std::vector<std::shared_ptr<bpp::bpp_program>> ProgramPool::re_parse_programs(co
 				std::erase_if(program_indices, [](const auto& pair) { return pair.second.empty(); });
 			}
 		}
+
+		// The re-parsed programs may have grown
+		_evict_to_budget();
 	}
 	update_snapshot();
 
@@ -382,6 +543,8 @@ void ProgramPool::clean() {
 		programs.clear();
 		program_indices.clear();
 		open_files.clear();
+		std::lock_guard<std::mutex> usage_lock(usage_mutex);
+		program_usage.clear();
 	}
 	update_snapshot(); // Update the snapshot after cleaning
 }
@@ -6,15 +6,21 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <utility>
 #include <string>
 #include <vector>
 
+#include <AST/ParseCache.h>
 #include <bpp_include/bpp.h>
 #include <include/BashVersion.h>
 
+#include "TextDocument.h"
+
 /**
  * @class ProgramPool
  * @brief Manages a pool of bpp_program objects for efficient reuse and access.
@@ -23,8 +29,9 @@
  * The ProgramPool class allows for efficient management of these objects,
  * including adding, retrieving, and removing programs based on file paths.
  *
- * By default, it keeps a maximum of 10 programs in the pool.
- * When an 11th program is added, the oldest program is removed to make space.
+ * The pool is kept within a memory budget (512 MiB by default).
+ * The memory used by each program is estimated when it's parsed,
+ * and when the pool goes over budget, the least recently used programs are evicted to make space.
  *
  * Having a program in the pool means that it has been parsed and is ready for use.
  * I.e., we do not have to re-parse the program every time we want to request information from it,
@@ -35,27 +42,47 @@
  */
 class ProgramPool {
 	private:
-		size_t max_programs = 10; // Maximum number of programs to keep in the pool
+		size_t memory_budget_in_bytes = default_memory_budget_in_bytes; // Evict programs when their estimated total size exceeds this
 		std::vector<std::shared_ptr<bpp::bpp_program>> programs;
 		std::unordered_map<std::string, std::vector<size_t>> program_indices; // Maps file paths to program indices in the pool
 		std::unordered_map<std::string, bool> open_files; // Maps file paths to whether they are currently open
-		std::unordered_map<std::string, std::string> unsaved_changes; // Maps file paths to their unsaved contents
+		std::unordered_map<std::string, std::shared_ptr<TextDocument>> unsaved_changes; // Maps file paths to their unsaved contents
 		BashVersion target_bash_version = {5, 2};
 		std::recursive_mutex pool_mutex; // Mutex to protect access to the pool
+		std::mutex unsaved_changes_mutex; // Separate from pool_mutex so that edits don't have to wait for a reparse to finish
 
 		// Pool snapshots:
 		struct Snapshot {
 			std::vector<std::shared_ptr<bpp::bpp_program>> programs_snapshot; // Snapshot of the current programs in the pool
 			std::unordered_map<std::string, std::vector<size_t>> program_indices_snapshot; // Snapshot of the current program indices
 			std::unordered_map<std::string, bool> open_files_snapshot; // Snapshot of the current open files
-			std::unordered_map<std::string, std::string> unsaved_changes_snapshot; // Snapshot of the current unsaved changes
+			std::unordered_map<std::string, std::shared_ptr<TextDocument>> unsaved_changes_snapshot; // Snapshot of the current unsaved changes
 		};
 		std::unique_ptr<Snapshot> snapshot = std::make_unique<Snapshot>();
 		mutable std::recursive_mutex snapshot_mutex; // Mutex to protect access to the snapshot
 
 		bool utf16_mode = false; // Whether to use UTF-16 mode for character counting
 
-		void _remove_oldest_program();
+		// ASTs of files which haven't changed since they were last parsed,
+		// shared by every re-parse of every program in the pool
+		// (The files are still walked again by the listener on every re-parse)
+		std::shared_ptr<AST::ParseCache> parse_cache = std::make_shared<AST::ParseCache>();
+
+		// Memory accounting & LRU eviction
+		// Keyed by the program's main source file
+		// ASTs are shared between programs (through the parse cache), so they're recorded separately, to be counted once
+		struct ProgramUsage {
+			size_t estimated_size_in_bytes = 0; // Not including the ASTs
+			std::vector<std::pair<const AST::Program*, size_t>> ast_sizes;
+			uint64_t last_access = 0;
+		};
+		std::unordered_map<std::string, ProgramUsage> program_usage;
+		std::mutex usage_mutex; // Separate from pool_mutex, so that queue-jumping reads can still record their access
+		std::atomic<uint64_t> access_clock{0};
+
+		void _touch_program(const std::shared_ptr<bpp::bpp_program>& program);
+		void _record_program_size(const std::shared_ptr<bpp::bpp_program>& program);
+		void _evict_to_budget();
 		void _remove_program(size_t index);
 		std::shared_ptr<bpp::bpp_program> _parse_program(const std::string& file_path);
 
@@ -66,7 +93,9 @@ class ProgramPool {
 		void update_snapshot();
 		Snapshot load_snapshot() const;
 	public:
-		explicit ProgramPool(size_t max_programs = 10);
+		static constexpr size_t default_memory_budget_in_bytes = 512 * 1024 * 1024;
+
+		explicit ProgramPool(size_t memory_budget_in_bytes = default_memory_budget_in_bytes);
 
 		/**
 		 * @brief Add an include path for use by all future programs to be added to the pool.
@@ -80,6 +109,26 @@ class ProgramPool {
 		void set_utf16_mode(bool mode);
 		bool get_utf16_mode() const;
 		void set_target_bash_version(const BashVersion& version);
+		void set_memory_budget(size_t bytes);
+		size_t get_memory_budget() const;
+
+		/**
+		 * @brief Get the estimated total memory used by the programs in the pool, in bytes
+		 */
+		size_t get_memory_usage();
+		size_t get_program_count();
+
+		/**
+		 * @brief Parse every file in the given directory ahead of time
+		 *
+		 * The resulting ASTs are pinned in the pool's parse cache,
+		 * so that the first programs to include these files don't have to wait for them to be parsed.
+		 * This is meant to be run in the background (e.g., on the standard library directory at startup).
+		 *
+		 * @param directory The directory whose files should be parsed.
+		 * @return size_t The number of files successfully parsed.
+		 */
+		size_t warm_parse_cache(const std::string& directory);
 
 		/**
 		 * @brief Set the unsaved contents for a file to reflect in-editor changes.
@@ -90,6 +139,26 @@ class ProgramPool {
 		 * @param contents The unsaved contents of the file.
 		 */
 		void set_unsaved_file_contents(const std::string& file_path, const std::string& contents);
+
+		/**
+		 * @brief Apply an incremental edit to the unsaved contents of a file.
+		 *
+		 * If we have no unsaved contents for the file yet, its contents are first read from disk.
+		 * Positions are interpreted according to the pool's UTF-16 mode.
+		 * 
+		 * @param file_path The file path to edit.
+		 * @param start_line The line at which the replaced range starts.
+		 * @param start_character The character at which the replaced range starts.
+		 * @param end_line The line at which the replaced range ends.
+		 * @param end_character The character at which the replaced range ends.
+		 * @param text The text to replace the range with.
+		 */
+		void apply_unsaved_file_change(
+			const std::string& file_path,
+			uint32_t start_line, uint32_t start_character,
+			uint32_t end_line, uint32_t end_character,
+			const std::string& text
+		);
 		void remove_unsaved_file_contents(const std::string& file_path);
 
 		/**
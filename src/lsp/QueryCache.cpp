@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "QueryCache.h"
+
+#include <functional>
+
+size_t QueryCache::KeyHash::operator()(const Key& key) const {
+	size_t hash = std::hash<std::string>{}(key.file);
+	hash ^= std::hash<const void*>{}(key.subject) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+	hash ^= static_cast<size_t>(key.kind) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+	return hash;
+}
+
+void QueryCache::prune_expired_programs() {
+	std::erase_if(programs, [](const auto& entry) { return entry.second.program.expired(); });
+}
+
+std::optional<nlohmann::json> QueryCache::get(
+	const std::shared_ptr<const bpp::bpp_program>& program,
+	Kind kind,
+	const std::shared_ptr<const void>& subject,
+	const std::string& file
+) {
+	if (program == nullptr) return std::nullopt;
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	auto entry = programs.find(program.get());
+	if (entry == programs.end() || entry->second.program.lock() != program) {
+		misses++;
+		return std::nullopt;
+	}
+
+	auto result = entry->second.results.find(Key{kind, subject.get(), file});
+	if (result == entry->second.results.end()) {
+		misses++;
+		return std::nullopt;
+	}
+
+	hits++;
+	return result->second.value;
+}
+
+void QueryCache::put(
+	const std::shared_ptr<const bpp::bpp_program>& program,
+	Kind kind,
+	const std::shared_ptr<const void>& subject,
+	const std::string& file,
+	nlohmann::json value
+) {
+	if (program == nullptr) return;
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	auto entry = programs.find(program.get());
+	if (entry == programs.end()) {
+		// A new program has come in, so older ones have likely been replaced
+		prune_expired_programs();
+		entry = programs.emplace(program.get(), ProgramEntry{program, {}}).first;
+	} else if (entry->second.program.lock() != program) {
+		// A stale entry for a program which used to live at the same address
+		entry->second.program = program;
+		entry->second.results.clear();
+	}
+
+	auto& results = entry->second.results;
+	if (results.size() >= max_results_per_program) {
+		results.clear(); // Start over rather than track which results are least recently used
+	}
+	results.insert_or_assign(Key{kind, subject.get(), file}, Result{subject, std::move(value)});
+}
+
+void QueryCache::clear() {
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	programs.clear();
+}
+
+uint64_t QueryCache::get_hit_count() const {
+	return hits.load();
+}
+
+uint64_t QueryCache::get_miss_count() const {
+	return misses.load();
+}
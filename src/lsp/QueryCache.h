@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+#include <bpp_include/bpp_program.h>
+
+/**
+ * @class QueryCache
+ * @brief Remembers the results of read-only LSP queries against each program.
+ *
+ * A program is never modified after it's been analyzed: every edit produces a brand new program.
+ * So the answer to a query like "what's the hover text for this entity?" can't change for as long as the program it was computed from is current.
+ * The cache keys every result on the program it was computed from (which doubles as the document version),
+ * so there's nothing to invalidate: once a program is replaced, its results are simply never looked up again,
+ * and they're dropped once the program itself is gone.
+ *
+ * Within a program, results are keyed by the kind of query, the object the result depends on
+ * (e.g., the entity being hovered, or the entity whose members are being completed),
+ * and a file path where the result also depends on the file.
+ * Keying on the entity rather than the cursor position means that hovering anywhere on any reference to an entity hits the same entry.
+ * The cache holds a reference to that object for as long as the entry exists, so its address can't be reused for something else.
+ *
+ * Results are stored as the nlohmann::json values which go into the responses' 'result' fields.
+ * A hit skips building that value, but the response is still serialized when it's sent.
+ *
+ * All methods are thread-safe.
+ *
+ */
+class QueryCache {
+	public:
+		enum class Kind : uint8_t {
+			DocumentSymbol,
+			Hover,
+			AtCompletion,
+			DotCompletion
+		};
+
+		static constexpr size_t max_results_per_program = 1024;
+
+	private:
+		struct Key {
+			Kind kind;
+			const void* subject;
+			std::string file;
+
+			bool operator==(const Key& other) const = default;
+		};
+
+		struct KeyHash {
+			size_t operator()(const Key& key) const;
+		};
+
+		struct Result {
+			std::shared_ptr<const void> subject; // Keeps the subject (and therefore its address) alive
+			nlohmann::json value;
+		};
+
+		struct ProgramEntry {
+			std::weak_ptr<const bpp::bpp_program> program;
+			std::unordered_map<Key, Result, KeyHash> results;
+		};
+
+		std::unordered_map<const bpp::bpp_program*, ProgramEntry> programs;
+		std::atomic<uint64_t> hits = 0;
+		std::atomic<uint64_t> misses = 0;
+		mutable std::mutex cache_mutex;
+
+		void prune_expired_programs();
+	public:
+		QueryCache() = default;
+
+		QueryCache(const QueryCache&) = delete;
+		QueryCache& operator=(const QueryCache&) = delete;
+		QueryCache(QueryCache&&) = delete;
+		QueryCache& operator=(QueryCache&&) = delete;
+
+		std::optional<nlohmann::json> get(
+			const std::shared_ptr<const bpp::bpp_program>& program,
+			Kind kind,
+			const std::shared_ptr<const void>& subject,
+			const std::string& file
+		);
+
+		void put(
+			const std::shared_ptr<const bpp::bpp_program>& program,
+			Kind kind,
+			const std::shared_ptr<const void>& subject,
+			const std::string& file,
+			nlohmann::json value
+		);
+
+		/**
+		 * @brief Drop every cached result
+		 */
+		void clear();
+
+		uint64_t get_hit_count() const;
+		uint64_t get_miss_count() const;
+};
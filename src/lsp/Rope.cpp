@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "Rope.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+Rope::Rope(std::string_view text) {
+	assign(text);
+}
+
+void Rope::assign(std::string_view text) {
+	chunks.clear();
+	total_size = text.size();
+	for (size_t i = 0; i < text.size(); i += max_chunk_size) {
+		chunks.emplace_back(text.substr(i, max_chunk_size));
+	}
+}
+
+std::pair<size_t, size_t> Rope::locate(size_t offset) const {
+	if (offset > total_size) throw std::out_of_range("Rope offset out of range");
+
+	for (size_t i = 0; i < chunks.size(); i++) {
+		if (offset < chunks[i].size()) return {i, offset};
+		offset -= chunks[i].size();
+	}
+
+	// The offset is the end of the rope
+	if (chunks.empty()) return {0, 0};
+	return {chunks.size() - 1, chunks.back().size()};
+}
+
+void Rope::split_chunk(size_t index) {
+	if (chunks[index].size() <= max_chunk_size * 2) return;
+
+	std::string oversized = std::move(chunks[index]);
+	std::vector<std::string> pieces;
+	for (size_t i = 0; i < oversized.size(); i += max_chunk_size) {
+		pieces.emplace_back(oversized.substr(i, max_chunk_size));
+	}
+
+	chunks.erase(chunks.begin() + static_cast<std::ptrdiff_t>(index));
+	chunks.insert(chunks.begin() + static_cast<std::ptrdiff_t>(index),
+		std::make_move_iterator(pieces.begin()),
+		std::make_move_iterator(pieces.end()));
+}
+
+void Rope::erase(size_t offset, size_t length) {
+	if (length == 0) return;
+	if (offset + length > total_size) throw std::out_of_range("Rope erase out of range");
+
+	auto [index, chunk_offset] = locate(offset);
+	total_size -= length;
+
+	while (length > 0) {
+		std::string& chunk = chunks[index];
+		const size_t erase_count = std::min(length, chunk.size() - chunk_offset);
+		chunk.erase(chunk_offset, erase_count);
+		length -= erase_count;
+
+		if (chunk.empty()) {
+			chunks.erase(chunks.begin() + static_cast<std::ptrdiff_t>(index));
+		} else {
+			index++;
+		}
+		chunk_offset = 0;
+	}
+
+	// Merge the chunks on either side of the erased range if they've become small
+	if (index > 0 && index < chunks.size()
+		&& chunks[index - 1].size() + chunks[index].size() <= max_chunk_size) {
+		chunks[index - 1] += chunks[index];
+		chunks.erase(chunks.begin() + static_cast<std::ptrdiff_t>(index));
+	}
+}
+
+void Rope::insert(size_t offset, std::string_view text) {
+	if (text.empty()) return;
+
+	if (chunks.empty()) {
+		assign(text);
+		return;
+	}
+
+	auto [index, chunk_offset] = locate(offset);
+	chunks[index].insert(chunk_offset, text);
+	total_size += text.size();
+	split_chunk(index);
+}
+
+void Rope::replace(size_t offset, size_t length, std::string_view text) {
+	erase(offset, length);
+	insert(offset, text);
+}
+
+std::string Rope::substr(size_t offset, size_t length) const {
+	std::string result;
+	if (offset >= total_size) return result;
+	length = std::min(length, total_size - offset);
+	result.reserve(length);
+
+	auto [index, chunk_offset] = locate(offset);
+	while (length > 0 && index < chunks.size()) {
+		const size_t count = std::min(length, chunks[index].size() - chunk_offset);
+		result.append(chunks[index], chunk_offset, count);
+		length -= count;
+		index++;
+		chunk_offset = 0;
+	}
+	return result;
+}
+
+std::string Rope::to_string() const {
+	std::string result;
+	result.reserve(total_size);
+	for (const auto& chunk : chunks) {
+		result += chunk;
+	}
+	return result;
+}
+
+size_t Rope::size() const {
+	return total_size;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @class Rope
+ * @brief A chunked rope for storing the text of documents which are edited in small pieces.
+ *
+ * The text is kept as a sequence of chunks of (at most, roughly) max_chunk_size bytes.
+ * An edit only touches the chunks it overlaps, so inserting a character in a large file
+ * costs one small memmove rather than a copy of the whole file.
+ *
+ * Offsets are byte offsets into the UTF-8 text.
+ *
+ */
+class Rope {
+	private:
+		static constexpr size_t max_chunk_size = 4096;
+
+		std::vector<std::string> chunks;
+		size_t total_size = 0;
+
+		/**
+		 * @brief Find the chunk containing the given offset
+		 *
+		 * @return std::pair<size_t, size_t> The index of the chunk, and the offset within that chunk.
+		 * An offset equal to the size of the rope resolves to the end of the last chunk.
+		 */
+		std::pair<size_t, size_t> locate(size_t offset) const;
+		void split_chunk(size_t index);
+		void erase(size_t offset, size_t length);
+		void insert(size_t offset, std::string_view text);
+	public:
+		Rope() = default;
+		explicit Rope(std::string_view text);
+
+		void assign(std::string_view text);
+
+		/**
+		 * @brief Replace length bytes starting at offset with the given text
+		 */
+		void replace(size_t offset, size_t length, std::string_view text);
+
+		std::string substr(size_t offset, size_t length) const;
+		std::string to_string() const;
+		size_t size() const;
+};
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "TextDocument.h"
+
+#include <algorithm>
+
+TextDocument::TextDocument(std::string_view contents) : rope(contents) {
+	rebuild_line_index(contents);
+}
+
+void TextDocument::rebuild_line_index(std::string_view text) {
+	line_starts.assign(1, 0);
+	for (size_t i = 0; i < text.size(); i++) {
+		if (text[i] == '\n') line_starts.push_back(i + 1);
+	}
+}
+
+size_t TextDocument::offset_at(uint32_t line, uint32_t character, bool utf16) const {
+	if (line >= line_starts.size()) return rope.size();
+
+	const size_t line_start = line_starts[line];
+	const size_t next_line_start = (line + 1 < line_starts.size()) ? line_starts[line + 1] : rope.size();
+
+	std::string line_text = rope.substr(line_start, next_line_start - line_start);
+	size_t line_length = line_text.size();
+	if (line_length > 0 && line_text[line_length - 1] == '\n') line_length--;
+	if (line_length > 0 && line_text[line_length - 1] == '\r') line_length--;
+
+	if (!utf16) return line_start + std::min<size_t>(character, line_length);
+
+	// Walk the UTF-8 sequences, counting UTF-16 code units as we go
+	// Code points outside the BMP (4-byte sequences) take up two UTF-16 code units
+	size_t byte_index = 0;
+	uint32_t code_units = 0;
+	while (byte_index < line_length && code_units < character) {
+		const auto lead = static_cast<unsigned char>(line_text[byte_index]);
+		size_t sequence_length = 1;
+		if ((lead & 0xE0) == 0xC0) sequence_length = 2;
+		else if ((lead & 0xF0) == 0xE0) sequence_length = 3;
+		else if ((lead & 0xF8) == 0xF0) sequence_length = 4;
+
+		code_units += (sequence_length == 4) ? 2 : 1;
+		byte_index += sequence_length;
+	}
+
+	return line_start + std::min(byte_index, line_length);
+}
+
+void TextDocument::replace_contents(std::string_view contents) {
+	std::lock_guard<std::mutex> lock(document_mutex);
+	rope.assign(contents);
+	rebuild_line_index(contents);
+	contiguous_contents.reset();
+}
+
+void TextDocument::apply_edit(
+	uint32_t start_line, uint32_t start_character,
+	uint32_t end_line, uint32_t end_character,
+	std::string_view text,
+	bool utf16
+) {
+	std::lock_guard<std::mutex> lock(document_mutex);
+
+	const size_t start = offset_at(start_line, start_character, utf16);
+	const size_t end = std::max(start, offset_at(end_line, end_character, utf16));
+
+	rope.replace(start, end - start, text);
+	contiguous_contents.reset();
+
+	// Update the line index:
+	// 1. Drop the lines which started inside the replaced range
+	auto first_removed = std::upper_bound(line_starts.begin(), line_starts.end(), start);
+	auto last_removed = std::upper_bound(first_removed, line_starts.end(), end);
+	auto insertion_point = line_starts.erase(first_removed, last_removed);
+
+	// 2. Shift every line after the replaced range by the change in length
+	const auto delta = static_cast<std::ptrdiff_t>(text.size()) - static_cast<std::ptrdiff_t>(end - start);
+	for (auto it = insertion_point; it != line_starts.end(); it++) {
+		*it = static_cast<size_t>(static_cast<std::ptrdiff_t>(*it) + delta);
+	}
+
+	// 3. Add the lines which start inside the new text
+	std::vector<size_t> new_line_starts;
+	for (size_t i = 0; i < text.size(); i++) {
+		if (text[i] == '\n') new_line_starts.push_back(start + i + 1);
+	}
+	line_starts.insert(insertion_point, new_line_starts.begin(), new_line_starts.end());
+}
+
+std::shared_ptr<const std::string> TextDocument::get_contents() const {
+	std::lock_guard<std::mutex> lock(document_mutex);
+	if (contiguous_contents == nullptr) {
+		contiguous_contents = std::make_shared<const std::string>(rope.to_string());
+	}
+	return contiguous_contents;
+}
+
+size_t TextDocument::get_line_count() const {
+	std::lock_guard<std::mutex> lock(document_mutex);
+	return line_starts.size();
+}
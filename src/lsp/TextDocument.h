@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Rope.h"
+
+/**
+ * @class TextDocument
+ * @brief The in-editor contents of a document, kept up-to-date by incremental edits.
+ *
+ * The text is stored in a Rope, alongside an index of the byte offset at which each line starts.
+ * LSP positions (line + character) are converted to byte offsets through that index,
+ * counting characters either in UTF-16 code units or in bytes, depending on the negotiated position encoding.
+ *
+ * A contiguous copy of the text is only built when somebody asks for it (i.e., when reparsing),
+ * and is cached until the next edit.
+ *
+ * All methods are thread-safe.
+ *
+ */
+class TextDocument {
+	private:
+		Rope rope;
+		std::vector<size_t> line_starts = {0}; // Byte offset of the start of each line
+		mutable std::shared_ptr<const std::string> contiguous_contents; // Cached by get_contents(), reset on every edit
+		mutable std::mutex document_mutex;
+
+		void rebuild_line_index(std::string_view text);
+		size_t offset_at(uint32_t line, uint32_t character, bool utf16) const;
+	public:
+		explicit TextDocument(std::string_view contents);
+
+		/**
+		 * @brief Replace the entire contents of the document
+		 */
+		void replace_contents(std::string_view contents);
+
+		/**
+		 * @brief Replace the given range of the document with new text
+		 *
+		 * Positions past the end of a line resolve to the end of that line,
+		 * and lines past the end of the document resolve to the end of the document,
+		 * as required by the LSP spec.
+		 *
+		 * @param utf16 Whether characters are counted in UTF-16 code units (true) or in bytes (false)
+		 */
+		void apply_edit(
+			uint32_t start_line, uint32_t start_character,
+			uint32_t end_line, uint32_t end_character,
+			std::string_view text,
+			bool utf16
+		);
+
+		/**
+		 * @brief Get a contiguous copy of the document's contents
+		 *
+		 * The returned string is immutable and is shared between callers until the next edit.
+		 */
+		std::shared_ptr<const std::string> get_contents() const;
+
+		size_t get_line_count() const;
+};
@@ -7,28 +7,57 @@
 #include "ThreadPool.h"
 
 ThreadPool::ThreadPool(size_t threads)  {
+	max_background_tasks = threads > 1 ? threads - 1 : 0;
 	for (size_t i = 0; i < threads; i++) {
 		workers.emplace_back([this] {
 			while (true) {
 				std::function<void()> task;
+				bool background = false;
 				{
 					std::unique_lock<std::mutex> lock(this->queue_mutex);
-					this->condition.wait(lock, [this] { return this->stop || !this->tasks.empty(); });
+					this->condition.wait(lock, [this] {
+						return this->stop
+							|| !this->tasks.empty()
+							|| (!this->background_tasks.empty() && this->can_start_background_task());
+					});
 
 					if (this->stop && this->tasks.empty()) {
 						return; // Exit thread if stop is true and no tasks are left
 					}
 
-					// Get the next task
-					task = std::move(this->tasks.front());
-					this->tasks.pop();
+					// Get the next task, preferring normal tasks over background tasks
+					if (!this->tasks.empty()) {
+						task = std::move(this->tasks.front());
+						this->tasks.pop();
+						this->running_normal_tasks++;
+					} else {
+						task = std::move(this->background_tasks.front());
+						this->background_tasks.pop();
+						this->running_background_tasks++;
+						background = true;
+					}
 				}
 				task(); // Execute the task
+
+				{
+					std::lock_guard<std::mutex> lock(this->queue_mutex);
+					if (background) {
+						this->running_background_tasks--;
+					} else {
+						this->running_normal_tasks--;
+					}
+				}
+				this->condition.notify_one(); // A background task may now be allowed to run
 			}
 		});
 	}
 }
 
+bool ThreadPool::can_start_background_task() const {
+	if (max_background_tasks == 0) return running_normal_tasks == 0 && running_background_tasks == 0;
+	return running_background_tasks < max_background_tasks;
+}
+
 ThreadPool::~ThreadPool() {
 	{
 		std::unique_lock<std::mutex> lock(queue_mutex);
@@ -44,11 +73,16 @@ ThreadPool::~ThreadPool() {
 	}
 }
 
-void ThreadPool::enqueue(std::function<void()> task)  {
+void ThreadPool::enqueue(std::function<void()> task, Priority priority)  {
 	this->active = true; // Now that we've accepted a task
 	{
 		std::unique_lock<std::mutex> lock(queue_mutex);
-		tasks.push(std::move(task)); // Add the task to the queue
+		// Add the task to the queue
+		if (priority == Priority::Background) {
+			background_tasks.push(std::move(task));
+		} else {
+			tasks.push(std::move(task));
+		}
 	}
 	condition.notify_one(); // Notify one thread that a new task is available
 }
@@ -58,6 +92,9 @@ void ThreadPool::cleanup() {
 	while (!tasks.empty()) {
 		tasks.pop(); // Clear the task queue
 	}
+	while (!background_tasks.empty()) {
+		background_tasks.pop();
+	}
 	stop = true; // Set stop to true to signal all threads to exit
 	lock.unlock();
 	condition.notify_all(); // Notify all threads to wake up and check the stop condition
@@ -6,6 +6,7 @@
 
 #pragma once
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <mutex>
 #include <queue>
@@ -19,16 +20,34 @@
  * By default, the pool is initialized with a number of available worker threads
  * equal to the number of hardware threads available on the system. Tasks can be enqueued
  * to be executed by the worker threads, which will run them concurrently.
+ *
+ * Tasks are either normal or background tasks.
+ * Workers always take a waiting normal task first, and at most max_background_tasks
+ * background tasks run at once (one less than the number of workers),
+ * so that long-running background work (e.g., indexing the workspace) never keeps requests waiting.
+ * A pool with a single worker has no worker to spare: it only starts background tasks while it's idle,
+ * so background work should be split into short tasks.
  * 
  */
 class ThreadPool {
+	public:
+		enum class Priority : uint8_t {
+			Normal,
+			Background
+		};
 	private:
 		std::vector<std::thread> workers;
 		std::queue<std::function<void()>> tasks;
+		std::queue<std::function<void()>> background_tasks;
+		size_t running_background_tasks = 0;
+		size_t running_normal_tasks = 0;
+		size_t max_background_tasks = 0; // If 0, background tasks only run while the pool is otherwise idle
 		std::mutex queue_mutex;
 		std::condition_variable condition;
 		bool stop = false;
 		bool active = false; // Whether the thread pool has accepted any tasks yet
+
+		bool can_start_background_task() const; // Must be called with queue_mutex held
 	public:
 		explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
 		~ThreadPool();
@@ -42,8 +61,9 @@ class ThreadPool {
 		 * @brief Enqueue a new task to be executed by the thread pool.
 		 * 
 		 * @param task A function pointer to be excecuted by a worker thread.
+		 * @param priority Whether the task should yield to normal tasks.
 		 */
-		void enqueue(std::function<void()> task);
+		void enqueue(std::function<void()> task, Priority priority = Priority::Normal);
 		void cleanup();
 		size_t getThreadCount() const;
 		bool isActive() const;
@@ -0,0 +1,446 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "WorkspaceIndex.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <unordered_set>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include <AST/BashppParser.h>
+#include <AST/Nodes/ClassDefinition.h>
+#include <AST/Nodes/MethodDefinition.h>
+#include <AST/Nodes/DatamemberDeclaration.h>
+
+void WorkspaceIndex::set_utf16_mode(bool mode) {
+	std::unique_lock<std::shared_mutex> lock(index_mutex);
+	if (utf16_mode == mode) return;
+	utf16_mode = mode;
+
+	// Every column we've recorded is in the wrong encoding now
+	files.clear();
+	flat_index.clear();
+	flat_index_stale = true;
+	modified_since_save = true;
+}
+
+uint64_t WorkspaceIndex::hash_contents(std::string_view contents) {
+	// 64-bit FNV-1a
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (char c : contents) {
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+void WorkspaceIndex::collect_symbols(const std::shared_ptr<AST::Program>& program, std::vector<Symbol>* symbols) {
+	if (program == nullptr) return;
+
+	// Walk the AST, remembering which class (if any) each node is inside of
+	struct Visit {
+		const AST::ASTNode* node;
+		std::string class_name;
+	};
+	std::vector<Visit> stack;
+	stack.push_back({program.get(), ""});
+
+	while (!stack.empty()) {
+		Visit visit = std::move(stack.back());
+		stack.pop_back();
+
+		std::string class_name = std::move(visit.class_name);
+		switch (visit.node->getType()) {
+			case AST::NodeType::ClassDefinition:
+				{
+					const auto* class_definition = static_cast<const AST::ClassDefinition*>(visit.node);
+					const auto& name = class_definition->CLASSNAME();
+					symbols->push_back({name.getValue(), "", SymbolKind::Class, name.getLine(), name.getCharPositionInLine()});
+					class_name = name.getValue();
+				}
+				break;
+			case AST::NodeType::MethodDefinition:
+				{
+					const auto* method_definition = static_cast<const AST::MethodDefinition*>(visit.node);
+					const auto& name = method_definition->NAME();
+					symbols->push_back({name.getValue(), class_name, SymbolKind::Method, name.getLine(), name.getCharPositionInLine()});
+				}
+				continue; // Nothing inside a method body is a workspace symbol
+			case AST::NodeType::DatamemberDeclaration:
+				{
+					const auto* datamember_declaration = static_cast<const AST::DatamemberDeclaration*>(visit.node);
+					if (!datamember_declaration->IDENTIFIER().has_value()) continue;
+					const auto& name = datamember_declaration->IDENTIFIER().value();
+					symbols->push_back({name.getValue(), class_name, SymbolKind::Datamember, name.getLine(), name.getCharPositionInLine()});
+				}
+				continue;
+			default:
+				break;
+		}
+
+		const auto& children = visit.node->getChildren();
+		for (auto it = children.rbegin(); it != children.rend(); it++) {
+			if (*it != nullptr) stack.push_back({it->get(), class_name});
+		}
+	}
+}
+
+bool WorkspaceIndex::update_file(const std::string& file_path, const std::shared_ptr<const std::string>& contents) {
+	if (contents == nullptr) return false;
+
+	const uint64_t content_hash = hash_contents(*contents);
+	bool parse_in_utf16_mode;
+	{
+		std::shared_lock<std::shared_mutex> lock(index_mutex);
+		auto it = files.find(file_path);
+		if (it != files.end() && it->second.content_hash == content_hash) return false;
+		parse_in_utf16_mode = utf16_mode;
+	}
+
+	// Parse without holding the lock, so that queries aren't held up by indexing
+	// A file which doesn't parse cleanly still contributes whatever definitions could be made out
+	FileEntry entry;
+	entry.content_hash = content_hash;
+	try {
+		AST::BashppParser parser;
+		parser.setUTF16Mode(parse_in_utf16_mode);
+		parser.setInputFromStringContents(contents);
+		collect_symbols(parser.program(), &entry.symbols);
+	} catch (...) {
+		entry.symbols.clear();
+	}
+
+	std::unique_lock<std::shared_mutex> lock(index_mutex);
+	if (utf16_mode != parse_in_utf16_mode) return true; // The encoding changed while we were parsing, the entry is useless
+	files[file_path] = std::move(entry);
+	flat_index_stale = true;
+	modified_since_save = true;
+	return true;
+}
+
+void WorkspaceIndex::remove_file(const std::string& file_path) {
+	std::unique_lock<std::shared_mutex> lock(index_mutex);
+	if (files.erase(file_path) == 0) return;
+	flat_index_stale = true;
+	modified_since_save = true;
+}
+
+void WorkspaceIndex::retain_files(const std::vector<std::string>& file_paths) {
+	std::unordered_set<std::string_view> keep(file_paths.begin(), file_paths.end());
+
+	std::unique_lock<std::shared_mutex> lock(index_mutex);
+	const size_t removed = std::erase_if(files, [&keep](const auto& file) {
+		return !keep.contains(file.first);
+	});
+	if (removed == 0) return;
+	flat_index_stale = true;
+	modified_since_save = true;
+}
+
+size_t WorkspaceIndex::get_file_count() const {
+	std::shared_lock<std::shared_mutex> lock(index_mutex);
+	return files.size();
+}
+
+std::string WorkspaceIndex::to_lowercase(std::string_view text) {
+	std::string result(text);
+	for (char& c : result) {
+		c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	}
+	return result;
+}
+
+uint64_t WorkspaceIndex::character_mask(std::string_view text) {
+	uint64_t mask = 0;
+	for (char c : text) {
+		const auto ch = static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(c)));
+		if (ch >= 'a' && ch <= 'z') mask |= 1ULL << (ch - 'a');
+		else if (ch >= '0' && ch <= '9') mask |= 1ULL << (26 + ch - '0');
+		else if (ch == '_') mask |= 1ULL << 36;
+		else mask |= 1ULL << 37; // Anything else
+	}
+	return mask;
+}
+
+void WorkspaceIndex::rebuild_flat_index() {
+	flat_index.clear();
+	for (const auto& [file_path, entry] : files) {
+		const bpp::FileId file = bpp::intern_file_path(file_path);
+		for (const auto& symbol : entry.symbols) {
+			flat_index.push_back({file, &symbol, to_lowercase(symbol.name), character_mask(symbol.name)});
+		}
+	}
+	flat_index_stale = false;
+}
+
+int WorkspaceIndex::fuzzy_score(std::string_view lowercase_query, std::string_view name, std::string_view lowercase_name) {
+	if (lowercase_query.empty()) return 0;
+	if (lowercase_query.size() > lowercase_name.size()) return -1;
+
+	int score = 0;
+	size_t name_index = 0;
+	size_t previous_match = 0;
+	for (size_t query_index = 0; query_index < lowercase_query.size(); query_index++) {
+		const size_t match = lowercase_name.find(lowercase_query[query_index], name_index);
+		if (match == std::string_view::npos) return -1;
+
+		score += 1;
+		if (match == 0) {
+			score += 8;
+		} else if (name[match - 1] == '_'
+			|| (std::islower(static_cast<unsigned char>(name[match - 1])) && std::isupper(static_cast<unsigned char>(name[match])))
+		) {
+			score += 6; // Start of a word
+		}
+
+		if (query_index > 0) {
+			if (match == previous_match + 1) {
+				score += 4; // Continues a run of matching characters
+			} else {
+				score -= static_cast<int>(std::min<size_t>(match - previous_match - 1, 3)); // Skipped over part of the name
+			}
+		}
+
+		previous_match = match;
+		name_index = match + 1;
+	}
+
+	if (lowercase_name == lowercase_query) {
+		score += 20;
+	} else if (lowercase_name.starts_with(lowercase_query)) {
+		score += 10;
+	}
+
+	// Among otherwise equal matches, prefer the shorter names
+	score -= static_cast<int>((lowercase_name.size() - lowercase_query.size()) / 4);
+	return std::max(score, 0); // Every match scores at least 0, however poor
+}
+
+std::vector<WorkspaceIndex::Match> WorkspaceIndex::query(std::string_view query, size_t limit) {
+	const std::string lowercase_query = to_lowercase(query);
+	const uint64_t query_mask = character_mask(query);
+
+	std::shared_lock<std::shared_mutex> shared_lock(index_mutex, std::defer_lock);
+	std::unique_lock<std::shared_mutex> unique_lock(index_mutex, std::defer_lock);
+	shared_lock.lock();
+	if (flat_index_stale) {
+		shared_lock.unlock();
+		unique_lock.lock();
+		if (flat_index_stale) rebuild_flat_index(); // Unless someone else got here first
+	}
+
+	struct Candidate {
+		const IndexedSymbol* indexed_symbol;
+		int score;
+	};
+	std::vector<Candidate> candidates;
+	for (const auto& indexed_symbol : flat_index) {
+		if ((indexed_symbol.character_mask & query_mask) != query_mask) continue;
+		const int score = fuzzy_score(lowercase_query, indexed_symbol.symbol->name, indexed_symbol.lowercase_name);
+		if (score < 0) continue;
+		candidates.push_back({&indexed_symbol, score});
+	}
+
+	auto better = [](const Candidate& a, const Candidate& b) {
+		if (a.score != b.score) return a.score > b.score;
+		if (a.indexed_symbol->symbol->name != b.indexed_symbol->symbol->name) {
+			return a.indexed_symbol->symbol->name < b.indexed_symbol->symbol->name;
+		}
+		return a.indexed_symbol->file < b.indexed_symbol->file;
+	};
+	if (candidates.size() > limit) {
+		std::partial_sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(limit), candidates.end(), better);
+		candidates.resize(limit);
+	} else {
+		std::sort(candidates.begin(), candidates.end(), better);
+	}
+
+	std::vector<Match> matches;
+	matches.reserve(candidates.size());
+	for (const auto& candidate : candidates) {
+		matches.push_back({
+			bpp::get_interned_file_path(candidate.indexed_symbol->file),
+			*candidate.indexed_symbol->symbol,
+			candidate.score
+		});
+	}
+	return matches;
+}
+
+bool WorkspaceIndex::save(const std::string& cache_path) {
+	nlohmann::json cache;
+	{
+		std::shared_lock<std::shared_mutex> lock(index_mutex);
+		cache["version"] = cache_format_version;
+		cache["utf16"] = utf16_mode;
+		nlohmann::json& cached_files = cache["files"] = nlohmann::json::array();
+		for (const auto& [file_path, entry] : files) {
+			nlohmann::json symbols = nlohmann::json::array();
+			for (const auto& symbol : entry.symbols) {
+				symbols.push_back({symbol.name, symbol.container_name, static_cast<uint8_t>(symbol.kind), symbol.line, symbol.column});
+			}
+			cached_files.push_back({{"path", file_path}, {"hash", entry.content_hash}, {"symbols", std::move(symbols)}});
+		}
+	}
+
+	std::error_code error;
+	const std::filesystem::path path(cache_path);
+	std::filesystem::create_directories(path.parent_path(), error);
+	if (error) return false;
+
+	const std::string temporary_path = cache_path + ".tmp." + std::to_string(getpid());
+	{
+		std::ofstream cache_file(temporary_path, std::ios::binary | std::ios::trunc);
+		if (!cache_file.is_open()) return false;
+		const std::vector<uint8_t> encoded = nlohmann::json::to_cbor(cache);
+		cache_file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+		if (!cache_file.good()) {
+			cache_file.close();
+			std::filesystem::remove(temporary_path, error);
+			return false;
+		}
+	}
+
+	std::filesystem::rename(temporary_path, path, error);
+	if (error) {
+		std::filesystem::remove(temporary_path, error);
+		return false;
+	}
+
+	std::unique_lock<std::shared_mutex> lock(index_mutex);
+	modified_since_save = false;
+	return true;
+}
+
+bool WorkspaceIndex::load(const std::string& cache_path) {
+	std::ifstream cache_file(cache_path, std::ios::binary);
+	if (!cache_file.is_open()) return false;
+
+	std::unordered_map<std::string, FileEntry> loaded_files;
+	try {
+		const nlohmann::json cache = nlohmann::json::from_cbor(cache_file);
+		if (cache.at("version").get<uint32_t>() != cache_format_version) return false;
+
+		{
+			std::shared_lock<std::shared_mutex> lock(index_mutex);
+			if (cache.at("utf16").get<bool>() != utf16_mode) return false;
+		}
+
+		for (const auto& cached_file : cache.at("files")) {
+			FileEntry entry;
+			entry.content_hash = cached_file.at("hash").get<uint64_t>();
+			for (const auto& cached_symbol : cached_file.at("symbols")) {
+				const auto kind = cached_symbol.at(2).get<uint8_t>();
+				if (kind > static_cast<uint8_t>(SymbolKind::Datamember)) return false;
+				entry.symbols.push_back({
+					cached_symbol.at(0).get<std::string>(),
+					cached_symbol.at(1).get<std::string>(),
+					static_cast<SymbolKind>(kind),
+					cached_symbol.at(3).get<uint32_t>(),
+					cached_symbol.at(4).get<uint32_t>()
+				});
+			}
+			loaded_files.emplace(cached_file.at("path").get<std::string>(), std::move(entry));
+		}
+	} catch (const std::exception&) {
+		return false; // A corrupt cache is as good as no cache
+	}
+
+	std::unique_lock<std::shared_mutex> lock(index_mutex);
+	files = std::move(loaded_files);
+	flat_index.clear();
+	flat_index_stale = true;
+	modified_since_save = false;
+	return true;
+}
+
+bool WorkspaceIndex::is_modified() const {
+	std::shared_lock<std::shared_mutex> lock(index_mutex);
+	return modified_since_save;
+}
+
+bool WorkspaceIndex::is_indexable_file(const std::string& file_path, std::string_view contents) {
+	const std::filesystem::path path(file_path);
+	if (path.extension() == ".bpp") return true;
+	if (path.has_extension() || path.filename().string().starts_with(".")) return false;
+
+	// Extension-less files are only indexed if they look like Bash++ libraries
+	return contents.contains("@class");
+}
+
+std::vector<std::string> WorkspaceIndex::discover_files(const std::vector<std::string>& roots) {
+	constexpr uintmax_t max_file_size = 8 * 1024 * 1024; // Anything bigger is very unlikely to be source code
+	constexpr size_t sniffed_bytes = 64 * 1024;
+
+	std::set<std::string> discovered;
+	for (const auto& root : roots) {
+		std::error_code error;
+		std::filesystem::recursive_directory_iterator it(root, std::filesystem::directory_options::skip_permission_denied, error);
+		if (error) continue;
+
+		for (; it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+			if (error) break;
+			const auto& entry = *it;
+			const std::string file_name = entry.path().filename().string();
+
+			if (entry.is_directory(error)) {
+				if (file_name.starts_with(".")) it.disable_recursion_pending();
+				continue;
+			}
+			if (!entry.is_regular_file(error) || entry.is_symlink(error)) continue;
+			if (entry.file_size(error) > max_file_size || error) continue;
+
+			const std::string extension = entry.path().extension().string();
+			if (extension != ".bpp") {
+				if (!extension.empty() || file_name.starts_with(".")) continue;
+
+				std::ifstream file_stream(entry.path(), std::ios::binary);
+				std::string head(sniffed_bytes, '\0');
+				file_stream.read(head.data(), static_cast<std::streamsize>(head.size()));
+				head.resize(static_cast<size_t>(file_stream.gcount()));
+				if (!is_indexable_file(entry.path().string(), head)) continue;
+			}
+
+			const std::string file_path = std::filesystem::canonical(entry.path(), error).string();
+			if (error) continue;
+			discovered.insert(file_path);
+		}
+	}
+	return {discovered.begin(), discovered.end()};
+}
+
+std::string WorkspaceIndex::default_cache_path(const std::vector<std::string>& roots) {
+	std::filesystem::path cache_directory;
+	if (const char* xdg_cache_home = std::getenv("XDG_CACHE_HOME"); xdg_cache_home != nullptr && *xdg_cache_home != '\0') {
+		cache_directory = xdg_cache_home;
+	} else if (const char* home = std::getenv("HOME"); home != nullptr && *home != '\0') {
+		cache_directory = std::filesystem::path(home) / ".cache";
+	} else {
+		return "";
+	}
+
+	// One cache per set of workspace roots, named after a hash of the roots
+	std::vector<std::string> sorted_roots(roots);
+	std::sort(sorted_roots.begin(), sorted_roots.end());
+	std::string key;
+	for (const auto& root : sorted_roots) {
+		key += root;
+		key += '\n';
+	}
+
+	char file_name[64];
+	std::snprintf(file_name, sizeof(file_name), "workspace-%016llx.cbor", static_cast<unsigned long long>(hash_contents(key)));
+	return (cache_directory / "bpp-lsp" / file_name).string();
+}
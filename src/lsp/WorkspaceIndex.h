@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <AST/Nodes/Program.h>
+#include <bpp_include/interned_files.h>
+
+/**
+ * @class WorkspaceIndex
+ * @brief An index of the classes, methods and data members defined anywhere in the workspace.
+ *
+ * Programs in the ProgramPool only exist for files which have been opened,
+ * so they can't answer questions about the workspace as a whole (e.g., workspace/symbol).
+ * The workspace index is built in the background by parsing every Bash++ file under the workspace roots.
+ * It only keeps the top-level definitions found in each file's AST, not the files' programs,
+ * so it stays small even for workspaces with thousands of files.
+ *
+ * The index can be saved to and loaded from an on-disk cache.
+ * Every file's entry records a hash of the contents it was built from,
+ * so after a restart, only the files whose contents have changed have to be parsed again.
+ *
+ * Symbols are looked up by fuzzy matching (see query()).
+ *
+ * All methods are thread-safe.
+ *
+ */
+class WorkspaceIndex {
+	public:
+		enum class SymbolKind : uint8_t {
+			Class,
+			Method,
+			Datamember
+		};
+
+		struct Symbol {
+			std::string name;
+			std::string container_name; // The class in which a method or data member is defined
+			SymbolKind kind = SymbolKind::Class;
+			uint32_t line = 0;
+			uint32_t column = 0;
+		};
+
+		struct Match {
+			std::string file;
+			Symbol symbol;
+			int score = 0;
+		};
+
+		static constexpr uint32_t cache_format_version = 1;
+
+	private:
+		struct FileEntry {
+			uint64_t content_hash = 0;
+			std::vector<Symbol> symbols;
+		};
+
+		// One entry per symbol, kept flat so that a query is a single pass over contiguous memory
+		// The character mask holds one bit per letter, digit or underscore which appears in the name,
+		// So that names which can't possibly match a query are skipped without being scored
+		struct IndexedSymbol {
+			bpp::FileId file = 0;
+			const Symbol* symbol = nullptr;
+			std::string lowercase_name;
+			uint64_t character_mask = 0;
+		};
+
+		std::unordered_map<std::string, FileEntry> files; // Keyed by file path
+		std::vector<IndexedSymbol> flat_index; // Rebuilt on the first query after any change
+		bool flat_index_stale = true;
+		bool utf16_mode = false;
+		bool modified_since_save = false;
+		mutable std::shared_mutex index_mutex;
+
+		void rebuild_flat_index();
+
+		static void collect_symbols(const std::shared_ptr<AST::Program>& program, std::vector<Symbol>* symbols);
+		static uint64_t character_mask(std::string_view text);
+		static std::string to_lowercase(std::string_view text);
+	public:
+		WorkspaceIndex() = default;
+
+		WorkspaceIndex(const WorkspaceIndex&) = delete;
+		WorkspaceIndex& operator=(const WorkspaceIndex&) = delete;
+		WorkspaceIndex(WorkspaceIndex&&) = delete;
+		WorkspaceIndex& operator=(WorkspaceIndex&&) = delete;
+
+		/**
+		 * @brief Set whether symbol columns are counted in UTF-16 code units
+		 *
+		 * If this changes the mode, everything indexed so far is dropped.
+		 */
+		void set_utf16_mode(bool mode);
+
+		/**
+		 * @brief Index a file, unless it's already indexed from exactly these contents
+		 *
+		 * @return true if the file had to be parsed, false if its entry was already up-to-date
+		 */
+		bool update_file(const std::string& file_path, const std::shared_ptr<const std::string>& contents);
+
+		/**
+		 * @brief Drop a file from the index
+		 */
+		void remove_file(const std::string& file_path);
+
+		/**
+		 * @brief Drop every file which isn't in the given list (e.g., files deleted while the server wasn't running)
+		 */
+		void retain_files(const std::vector<std::string>& file_paths);
+
+		size_t get_file_count() const;
+
+		/**
+		 * @brief Find the symbols whose names fuzzily match the query
+		 *
+		 * A name matches if it contains every character of the query, in order (ignoring case).
+		 * Matches are ranked higher the more of the query matches at the start of the name,
+		 * at word boundaries (after an underscore, or at a lowercase-to-uppercase change),
+		 * and in consecutive runs.
+		 * An empty query matches everything.
+		 *
+		 * @param query The text the user typed
+		 * @param limit The maximum number of matches to return
+		 * @return std::vector<Match> The best matches, best first
+		 */
+		std::vector<Match> query(std::string_view query, size_t limit);
+
+		/**
+		 * @brief Score how well a name matches a query
+		 *
+		 * @param lowercase_query The query, already lowercased
+		 * @param name The name to score
+		 * @param lowercase_name The name, already lowercased
+		 * @return int The score (at least 0), or -1 if the name doesn't match at all
+		 */
+		static int fuzzy_score(std::string_view lowercase_query, std::string_view name, std::string_view lowercase_name);
+
+		/**
+		 * @brief Save the index to the given file
+		 *
+		 * The file is written in full to a temporary file first, and then moved into place,
+		 * so that a crash never leaves a half-written cache behind.
+		 *
+		 * @return true if the cache was written successfully
+		 */
+		bool save(const std::string& cache_path);
+
+		/**
+		 * @brief Load the index from the given file, replacing whatever is in the index now
+		 *
+		 * Entries are only trusted as far as their content hashes:
+		 * every loaded file still has to go through update_file(), which only reparses it if its contents have changed.
+		 * A cache written in a different format version or position encoding is ignored.
+		 *
+		 * @return true if the cache was read successfully
+		 */
+		bool load(const std::string& cache_path);
+
+		/**
+		 * @brief Whether anything has changed since the index was last saved or loaded
+		 */
+		bool is_modified() const;
+
+		/**
+		 * @brief Find the files under the given directories which should be indexed
+		 *
+		 * These are the files with a .bpp extension, plus extension-less files which define classes
+		 * (such as those of the standard library).
+		 * Hidden directories (e.g., .git) are skipped, and symbolic links aren't followed.
+		 *
+		 * @return std::vector<std::string> The canonical paths of the files found
+		 */
+		static std::vector<std::string> discover_files(const std::vector<std::string>& roots);
+
+		/**
+		 * @brief Whether a file with the given path and contents belongs in the index
+		 *
+		 * For extension-less files, it's enough for the contents to be the first part of the file.
+		 */
+		static bool is_indexable_file(const std::string& file_path, std::string_view contents);
+
+		/**
+		 * @brief Get the default location of the cache for the given workspace roots
+		 *
+		 * Caches live under $XDG_CACHE_HOME/bpp-lsp (or ~/.cache/bpp-lsp), one per set of workspace roots.
+		 *
+		 * @return std::string The path of the cache file, or an empty string if there's nowhere to put it
+		 */
+		static std::string default_cache_path(const std::vector<std::string>& roots);
+
+		static uint64_t hash_contents(std::string_view contents);
+};
@@ -206,13 +206,13 @@ void TypeRegistry::generate_inheritance(std::ofstream& file, const std::vector<s
 std::string TypeRegistry::get_variant_deserialization_code(
 	const std::string& prop_name, 
 	const std::string& variant_type,
-	bool is_optional
+	const std::string& indent
 ) {
 	// Extract types between < and >
 	size_t start = variant_type.find('<');
 	size_t end = variant_type.rfind('>');
 	if (start == std::string::npos || end == std::string::npos) {
-		return "// Error: malformed variant type\n";
+		return indent + "// Error: malformed variant type\n";
 	}
 
 	std::string inner = variant_type.substr(start + 1, end - start - 1);
@@ -237,6 +237,7 @@ std::string TypeRegistry::get_variant_deserialization_code(
 	if (!current.empty()) types.push_back(current);
 
 	// Generate deserialization code
+	// The generated code reads from the iterator 'it', which the caller has already pointed at the property
 	std::string code;
 	std::set<std::string> conditions_used;
 
@@ -280,43 +281,40 @@ std::string TypeRegistry::get_variant_deserialization_code(
 			if (clean_type == "std::nullptr_t") {
 				getter = "obj." + prop_name + " = nullptr;";
 			} else {
-				getter = "obj." + prop_name + " = j[\"" + prop_name + "\"].get<" + clean_type + ">();";
+				getter = "obj." + prop_name + " = it->get<" + clean_type + ">();";
 			}
 			
 			if (code.empty()) {
-				code = "if (j[\"" + prop_name + "\"]." + condition + ") {\n";
+				code = indent + "if (it->" + condition + ") {\n";
 			} else {
-				code += "} else if (j[\"" + prop_name + "\"]." + condition + ") {\n";
+				code += indent + "} else if (it->" + condition + ") {\n";
 			}
-			code += "    " + getter + "\n";
+			code += indent + "	" + getter + "\n";
 		}
 	}
 
 	if (!code.empty()) {
-		code += "} else {\n";
-		code += "    throw std::runtime_error(\"Unexpected type for property " + prop_name + "\");\n";
-		code += "}";
-		
-		if (is_optional) {
-			return "if (j.contains(\"" + prop_name + "\")) {\n" + code + "\n}\n";
-		}
-		return code + "\n";
+		code += indent + "} else {\n";
+		code += indent + "	throw std::runtime_error(\"Unexpected type for property " + prop_name + "\");\n";
+		code += indent + "}\n";
+		return code;
 	}
 
-	return "// Could not generate variant deserialization\n";
+	return indent + "// Could not generate variant deserialization\n";
 }
 
 void TypeRegistry::generate_serialization(std::ofstream& file, 
 		const std::string& name,
 		const std::vector<std::string>& base_classes,
 		const nlohmann::json& properties) const {
-	file << "	friend void to_json(nlohmann::json& j, const " << name << "& obj) {\n";
-	file << "		j = nlohmann::json::object();\n";
+	// to_json_fields writes this struct's properties (and those of its bases) into an existing object
+	// This way, derived types write straight into the one object they're building,
+	// instead of serializing each base into a temporary and merging it in
+	file << "	friend void to_json_fields(nlohmann::json& j, const " << name << "& obj) {\n";
 
 	// Serialize base classes
 	for (const auto& base : base_classes) {
-		file << "		nlohmann::json " << base << "_json = static_cast<const " << base << "&>(obj);\n";
-		file << "		j.update(" << base << "_json);\n";
+		file << "		to_json_fields(j, static_cast<const " << base << "&>(obj));\n";
 	}
 
 	// Serialize direct properties
@@ -364,50 +362,56 @@ void TypeRegistry::generate_serialization(std::ofstream& file,
 
 	file << "	}\n\n";
 
+	file << "	friend void to_json(nlohmann::json& j, const " << name << "& obj) {\n";
+	file << "		j = nlohmann::json::object();\n";
+	file << "		to_json_fields(j, obj);\n";
+	file << "	}\n\n";
+
 	file << "	friend void from_json(const nlohmann::json& j, " << name << "& obj) {\n";
 
 	// Deserialize base classes
+	// Straight into the base subobject, no temporary copy
 	for (const auto& base : base_classes) {
-		file << "		{\n";
-		file << "			" << base << " base_obj;\n";
-		file << "			j.get_to(base_obj);\n";
-		file << "			static_cast<" << base << "&>(obj) = base_obj;\n";
-		file << "		}\n";
+		file << "		j.get_to(static_cast<" << base << "&>(obj));\n";
 	}
 
 	// Deserialize direct properties
+	// Each property is looked up once, and read through the resulting iterator
 	for (const auto& prop : properties) {
 		const std::string prop_name = get_sanitized_name(prop["name"].get<std::string>());
 		const bool is_optional = prop.value("optional", false);
 
+		file << "		if (auto it = j.find(\"" << prop_name << "\"); it != j.end()) {\n";
+
 		// Is it a std::variant?
 		std::string type_str = resolve_type(prop["type"]);
 		if (type_str.starts_with("std::variant")) {
-			file << get_variant_deserialization_code(prop_name, type_str, is_optional);
+			file << get_variant_deserialization_code(prop_name, type_str, "			");
+		} else if (is_optional) {
+			file << "			if (it->is_null()) {\n";
+			file << "				obj." << prop_name << " = std::nullopt;\n";
+			file << "			} else {\n";
+			if (type_str == name) {
+				file << "				obj." << prop_name << " = std::make_shared<" << name << ">(it->get<" << type_str << ">());\n";
+			} else {
+				file << "				obj." << prop_name << " = it->get<" << type_str << ">();\n";
+			}
+			file << "			}\n";
 		} else {
-			// Normal property handling
-			if (is_optional) {
-				file << "		if (j.contains(\"" << prop_name << "\")) {\n";
-				file << "			if (j[\"" << prop_name << "\"].is_null()) {\n";
-				file << "				obj." << prop_name << " = std::nullopt;\n";
-				file << "			} else {\n";
-				if (type_str == name) {
-					file << "				obj." << prop_name << " = std::make_shared<" << name << ">(j[\"" << prop_name << "\"].get<" << type_str << ">());\n";
-				} else {
-					file << "				obj." << prop_name << " = j[\"" << prop_name << "\"].get<" << type_str << ">();\n";
-				}
-				file << "			}\n";
+			file << "			it->get_to(obj." << prop_name << ");\n";
+		}
+
+		if (is_optional) {
+			if (!type_str.starts_with("std::variant")) {
 				file << "		} else {\n";
 				file << "			obj." << prop_name << " = std::nullopt;\n";
-				file << "		}\n";
-			} else {
-				// Verify the property is present, and throw an exception if not
-				file << "		if (!j.contains(\"" << prop_name << "\")) {\n";
-				file << "			throw std::runtime_error(\"Property '" << prop_name << "' is required but not present.\");\n";
-				file << "		}\n";
-				file << "		j[\"" << prop_name << "\"].get_to(obj." << prop_name << ");\n";
 			}
+		} else {
+			// Verify the property is present, and throw an exception if not
+			file << "		} else {\n";
+			file << "			throw std::runtime_error(\"Property '" << prop_name << "' is required but not present.\");\n";
 		}
+		file << "		}\n";
 	}
 
 	file << "	}\n";
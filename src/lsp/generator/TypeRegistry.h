@@ -38,7 +38,7 @@ class TypeRegistry {
 		static std::string get_variant_deserialization_code(
 			const std::string& prop_name, 
 			const std::string& variant_type,
-			bool is_optional);
+			const std::string& indent);
 
 		void generate_serialization(std::ofstream& file, 
 			const std::string& name,
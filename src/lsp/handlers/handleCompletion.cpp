@@ -17,7 +17,7 @@
 #include <bpp_include/bpp_datamember.h>
 
 GenericResponseMessage bpp::BashppServer::handleCompletion(const GenericRequestMessage& request) {
-	CompletionRequestResponse response;
+	GenericResponseMessage response;
 	response.id = request.id;
 	CompletionRequest completion_request = request.toSpecific<CompletionParams>();
 
@@ -26,28 +26,35 @@ GenericResponseMessage bpp::BashppServer::handleCompletion(const GenericRequestM
 	try {
 		uri = validateUri(uri);
 	} catch (const std::exception& e) {
-		log("Invalid URI in completion request: ", e.what());
+		log(Logger::Level::Warning, "Invalid URI in completion request: ", e.what());
 		response.result = nullptr;
 		return response;
 	}
 
-	// Wait for processing_didChange to be false before proceeding
-	// Just to make sure we're suggesting completions based on the latest content
+	// Make sure we're suggesting completions based on the latest content
 	// When the user types '.', the client will send a didChange notification,
 	// and then immediately after, it'll send a completion request.
 	// We need to ensure that our internally-stored version of the file content
 	// is up-to-date before we resolve the reference and provide completions.
-	do {
-		std::this_thread::sleep_for(std::chrono::milliseconds(50));
-	} while (processing_didChange.load(std::memory_order_acquire));
-	
+	// So: wait until the newest version of this document the client has sent us has been analyzed,
+	// without waiting out the debounce delay on its reparse.
+	// If the analysis is already current, this returns immediately.
+	const int64_t version = document_versions.get_expected_version(uri);
+	const auto deadline = DocumentVersionBarrier::Clock::now() + document_version_timeout;
+	if (document_versions.wait_until_applied(uri, version, deadline)) {
+		debounce_scheduler.flush(uri);
+	}
+	if (!document_versions.wait_until_analyzed(uri, version, deadline)) {
+		log(Logger::Level::Warning, "Timed out waiting for version ", version, " of ", uri, " to be analyzed, completing on older analysis");
+	}
+
 	// Which character triggered the request?
 	char trigger_character = '.';
 	if (completion_request.params.context.has_value() && completion_request.params.context->triggerCharacter.has_value()) {
 		trigger_character = completion_request.params.context->triggerCharacter.value()[0];
 	}
 
-	CompletionList completion_list;
+	nlohmann::json completion_list;
 	
 	// If it was '@', suggest class names, object names, and standard operators like include or dynamic_cast
 	// If it was '.', suggest method names and data members of the current object
@@ -80,11 +87,9 @@ GenericResponseMessage bpp::BashppServer::handleCompletion(const GenericRequestM
 	return response;
 }
 
-CompletionList bpp::BashppServer::handleATCompletion(const CompletionParams& params) {
+nlohmann::json bpp::BashppServer::handleATCompletion(const CompletionParams& params) {
 	// Handle '@' completions
 	// Suggest class names, object names, and standard operators like include or dynamic_cast
-	CompletionList completion_list = default_completion_list; // Start with the default completion list
-
 	std::string uri = validateUri(params.textDocument.uri);
 
 	std::shared_ptr<bpp::bpp_program> program = program_pool.get_program(uri, true); // Jump the queue and get the program immediately
@@ -98,39 +103,48 @@ CompletionList bpp::BashppServer::handleATCompletion(const CompletionParams& par
 	std::shared_ptr<bpp::bpp_entity> active_entity = program->get_active_entity(uri, position.line, position.character);
 	if (active_entity == nullptr) {
 		log("BUG: No active entity found at position: (", position.line, ", ", position.character, ") in URI: ", uri, " - returning default completions.");
-	} else {
-		const auto& classes = active_entity->get_all_known_classes();
-
-		// Collect objects both foreign to & owned by the active entity into a single 'objects' map
-		const auto& objects = active_entity->get_all_known_objects();
-
-		for (const auto& obj : objects) {
-			if (obj == nullptr) continue;
-			CompletionItem item;
-			item.label = obj->get_name();
-			item.kind = CompletionItemKind::Variable;
-			item.detail = "@" + obj->get_class()->get_name() + " " + obj->get_name(); // As in: @ClassName objectName
-			completion_list.items.push_back(item);
-		}
+		return default_completion_list;
+	}
 
-		for (const auto& cls : classes) {
-			if (cls == nullptr) continue;
-			CompletionItem item;
-			item.label = cls->get_name();
-			item.kind = CompletionItemKind::Class;
-			item.detail = "@class " + cls->get_name(); // As in: @class ClassName
-			completion_list.items.push_back(item);
-		}
+	// The suggestions depend only on the active entity, so they're the same everywhere inside it
+	std::optional<nlohmann::json> cached_result = query_cache.get(program, QueryCache::Kind::AtCompletion, active_entity, "");
+	if (cached_result.has_value()) {
+		return std::move(cached_result.value());
 	}
 
-	return completion_list;
+	CompletionList completion_list = default_completion_list; // Start with the default completion list
+
+	const auto& classes = active_entity->get_all_known_classes();
+
+	// Collect objects both foreign to & owned by the active entity into a single 'objects' map
+	const auto& objects = active_entity->get_all_known_objects();
+
+	for (const auto& obj : objects) {
+		if (obj == nullptr) continue;
+		CompletionItem item;
+		item.label = obj->get_name();
+		item.kind = CompletionItemKind::Variable;
+		item.detail = "@" + obj->get_class()->get_name() + " " + obj->get_name(); // As in: @ClassName objectName
+		completion_list.items.push_back(item);
+	}
+
+	for (const auto& cls : classes) {
+		if (cls == nullptr) continue;
+		CompletionItem item;
+		item.label = cls->get_name();
+		item.kind = CompletionItemKind::Class;
+		item.detail = "@class " + cls->get_name(); // As in: @class ClassName
+		completion_list.items.push_back(item);
+	}
+
+	nlohmann::json result = completion_list;
+	query_cache.put(program, QueryCache::Kind::AtCompletion, active_entity, "", result);
+	return result;
 }
 
-CompletionList bpp::BashppServer::handleDOTCompletion(const CompletionParams& params) {
+nlohmann::json bpp::BashppServer::handleDOTCompletion(const CompletionParams& params) {
 	// Handle '.' completions
 	// Suggest method names and data members of the current object
-	CompletionList completion_list;
-
 	std::string uri = validateUri(params.textDocument.uri);
 
 	std::shared_ptr<bpp::bpp_program> program = program_pool.get_program(uri, true); // Jump the queue and get the program immediately
@@ -169,6 +183,14 @@ CompletionList bpp::BashppServer::handleDOTCompletion(const CompletionParams& pa
 		throw std::runtime_error("Referenced entity is not a valid object or class at position: (" + std::to_string(position.line) + ", " + std::to_string(position.character) + ") in URI: " + uri);
 	}
 
+	// The suggestions depend only on the referenced entity, so every '.' after any reference to it can share the same result
+	std::optional<nlohmann::json> cached_result = query_cache.get(program, QueryCache::Kind::DotCompletion, referenced_entity, "");
+	if (cached_result.has_value()) {
+		return std::move(cached_result.value());
+	}
+
+	CompletionList completion_list;
+
 	for (const auto& method : entity_class->get_methods()) {
 		if (method->get_name().contains("__")) {
 			continue; // Skip system methods
@@ -180,6 +202,10 @@ CompletionList bpp::BashppServer::handleDOTCompletion(const CompletionParams& pa
 
 		std::string detail;
 
+		if (method->has_inline_hint()) {
+			detail += "@inline ";
+		}
+
 		if (method->is_virtual()) {
 			detail += "@virtual ";
 		}
@@ -208,7 +234,7 @@ CompletionList bpp::BashppServer::handleDOTCompletion(const CompletionParams& pa
 		}
 
 		item.detail = detail;
-		// Full example: @virtual @public @method methodName @ClassName* param1 $primitive_param2
+		// Full example: @inline @virtual @public @method methodName @ClassName* param1 $primitive_param2
 
 		completion_list.items.push_back(item);
 	}
@@ -221,6 +247,10 @@ CompletionList bpp::BashppServer::handleDOTCompletion(const CompletionParams& pa
 		std::string detail = "@" + entity_name + "." + data_member->get_name();
 		detail += " (";
 
+		if (data_member->is_const()) {
+			detail += "@const ";
+		}
+
 		if (data_member->get_class() == nullptr) {
 			detail += "primitive";
 			if (data_member->is_array()) {
@@ -240,9 +270,12 @@ CompletionList bpp::BashppServer::handleDOTCompletion(const CompletionParams& pa
 		// Or: @objectName.dataMemberName (primitive array)
 		// Or: @objectName.dataMemberName (@ClassName)
 		// Or: @objectName.dataMemberName (@ClassName*)
+		// Or: @objectName.dataMemberName (@const @ClassName*)
 
 		completion_list.items.push_back(item);
 	}
 
-	return completion_list;
+	nlohmann::json result = completion_list;
+	query_cache.put(program, QueryCache::Kind::DotCompletion, referenced_entity, "", result);
+	return result;
 }
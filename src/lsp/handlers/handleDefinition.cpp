@@ -22,7 +22,7 @@ GenericResponseMessage bpp::BashppServer::handleDefinition(const GenericRequestM
 	try {
 		uri = validateUri(definition_request.params.textDocument.uri);
 	} catch (const std::exception& e) {
-		log("Invalid URI in definition request: ", e.what());
+		log(Logger::Level::Warning, "Invalid URI in definition request: ", e.what());
 		response.error = ResponseError{
 			static_cast<int>(ErrorCodes::InvalidParams),
 			"Invalid URI: " + definition_request.params.textDocument.uri, nullptr};
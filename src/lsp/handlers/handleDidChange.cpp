@@ -19,138 +19,68 @@ void bpp::BashppServer::handleDidChange(const GenericNotificationMessage& reques
 	try {
 		uri = validateUri(did_change_notification.params.textDocument.uri);
 	} catch (const std::exception& e) {
-		log("Invalid URI in DidChange notification: ", e.what());
+		log(Logger::Level::Warning, "Invalid URI in DidChange notification: ", e.what());
 		return;
 	}
 
-	if (did_change_notification.params.contentChanges.size() != 1) {
-		// For now, we only support single content changes
-		log("Ignoring DidChange notification for URI: ", uri, " as it has multiple content changes.");
-		return;
-	}
-
-	if (!std::holds_alternative<TextDocumentContentChangeWholeDocument>(did_change_notification.params.contentChanges.at(0))) {
-		// For now, we only support whole document changes
-		log("Ignoring DidChange notification for URI: ", uri, " as its content change is not a whole document change.");
-		return;
+	const int64_t version = did_change_notification.params.textDocument.version;
+
+	// Once the edits are in and the reparse is scheduled (or if applying them fails),
+	// release requests waiting on this version: a request woken up by this can then flush the reparse
+	auto applied = document_versions.mark_applied_on_exit(uri, version);
+
+	// Per the LSP spec, contentChanges is an array of either:
+	// 1. TextDocumentContentChangeWholeDocument
+	// 2. TextDocumentContentChangePartial
+	// Which must be applied in the order in which they appear.
+	// Edits are applied to the document store right away (they're cheap);
+	// only the reparse is debounced
+	for (const auto& change : did_change_notification.params.contentChanges) {
+		if (std::holds_alternative<TextDocumentContentChangeWholeDocument>(change)) {
+			program_pool.set_unsaved_file_contents(uri, std::get<TextDocumentContentChangeWholeDocument>(change).text);
+		} else {
+			const auto& partial_change = std::get<TextDocumentContentChangePartial>(change);
+			program_pool.apply_unsaved_file_change(
+				uri,
+				partial_change.range.start.line,
+				partial_change.range.start.character,
+				partial_change.range.end.line,
+				partial_change.range.end.character,
+				partial_change.text
+			);
+		}
 	}
 
-	processing_didChange.store(true, std::memory_order_release);
-
-	const std::string new_content = std::get<TextDocumentContentChangeWholeDocument>(did_change_notification.params.contentChanges.at(0)).text;
-	std::shared_ptr<DebounceState> debounce_state;
-	uint64_t change_generation_for_this_thread = 0;
-	uint32_t debounce_time_in_milliseconds = 100;
-
-	debounce_state = debounce_states.get(uri);
-	change_generation_for_this_thread =
-		debounce_state->change_generation.fetch_add(1, std::memory_order_acq_rel) + 1;
-	
-	debounce_time_in_milliseconds =
-		debounce_state->debounce_time_in_milliseconds.load(std::memory_order_acquire);
-
-	std::thread([this,
-		uri,
-		debounce_state,
-		change_generation_for_this_thread,
-		debounce_time_in_milliseconds,
-		new_content]() {
-			std::this_thread::sleep_for(std::chrono::milliseconds(debounce_time_in_milliseconds));
-			// Only proceed if no newer change generation has been recorded
-			if (debounce_state->change_generation.load(std::memory_order_acquire) != change_generation_for_this_thread) {
-				return; // A newer change has been recorded, slet the newer thread handle it
-			}
-		
-			program_pool.set_unsaved_file_contents(uri, new_content);
-
-			log("Re-parsing all programs associated with URI: ", uri);
-
-			// Per the LSP spec, contentChanges is an array of either:
-			// 1. TextDocumentContentChangeWholeDocument
-			// 2. TextDocumentContentChangePartial
-
-			// At the moment, we only support whole document changes
-			// The logic to support partial changes probably won't be too complicated altogether,
-			// But regardless, that's for later.
-
-			// We'll also only handle the case where there is exactly one change
-			// If there are multiple changes, we will ignore them for now
-
-			// TODO(@rail5): Handling partial changes and handling multiple changes (possibly of different types) **must** be implemented in the future
-			const auto reparse_start_time = std::chrono::steady_clock::now();
-			std::vector<std::shared_ptr<bpp::bpp_program>> programs = program_pool.re_parse_programs(uri);
-			const auto reparse_end_time = std::chrono::steady_clock::now();
-
-			if (programs.empty()) {
-				log("Failed to re-parse any programs for URI: ", uri);
-				return; // Don't allow failed parses to affect debounce timing
-			}
-
-			for (const auto& program : programs) {
-				if (program != nullptr) {
-					publishDiagnostics(program);
-				} else {
-					log("Failed to re-parse a program for URI: ", uri);
-				}
+	// Coalesce rapid edits: a newer change for the same URI replaces this one if it arrives before the debounce delay expires
+	debounce_scheduler.schedule(uri, [this, uri, version]() -> bool {
+		log("Re-parsing all programs associated with URI: ", uri);
+
+		std::vector<std::shared_ptr<bpp::bpp_program>> programs;
+		try {
+			// Release requests waiting on this version once the reparse is over, even if it failed
+			// The reparse reads the document's contents after this version's edits were applied,
+			// So it covers this version (and possibly later ones)
+			auto analyzed = document_versions.mark_analyzed_on_exit(uri, version);
+			programs = program_pool.re_parse_programs(uri);
+		} catch (const std::exception& e) {
+			log(Logger::Level::Error, "Error re-parsing programs for URI: ", uri, ": ", e.what());
+			return false;
+		}
+
+		if (programs.empty()) {
+			log(Logger::Level::Warning, "Failed to re-parse any programs for URI: ", uri);
+			return false; // Don't allow failed parses to affect debounce timing
+		}
+
+		for (const auto& program : programs) {
+			if (program != nullptr) {
+				publishDiagnostics(program);
+			} else {
+				log(Logger::Level::Warning, "Failed to re-parse a program for URI: ", uri);
 			}
+		}
 
-			const uint64_t reparse_duration_in_microseconds =
-				static_cast<uint64_t>(
-					std::chrono::duration_cast<std::chrono::microseconds>(reparse_end_time - reparse_start_time).count()
-				);
-
-			// Integer EWMA update: weight = 1/4 (no floats)
-			constexpr uint64_t weight_numerator = 1;
-			constexpr uint64_t weight_denominator = 4;
-
-			const uint64_t previous_average_reparse_time_in_microseconds =
-				debounce_state->average_reparse_time_in_microseconds.load(std::memory_order_acquire);		
-		
-			const uint64_t new_average_reparse_time_in_microseconds =
-				(previous_average_reparse_time_in_microseconds == 0)
-					? reparse_duration_in_microseconds
-					: (
-						(previous_average_reparse_time_in_microseconds * (weight_denominator - weight_numerator)
-						+ reparse_duration_in_microseconds * weight_numerator)
-						/ weight_denominator
-					  );
-		
-			debounce_state->average_reparse_time_in_microseconds.store(
-				new_average_reparse_time_in_microseconds,
-				std::memory_order_release
-			);
-
-			// Derive debounce from average
-			constexpr uint32_t minimum_debounce_time_in_milliseconds = 25;
-			constexpr uint32_t maximum_debounce_time_in_milliseconds = 1000;
-			constexpr uint32_t baseline_debounce_time_in_milliseconds = 100;
-
-			// Scale: 3/4
-			constexpr uint32_t scale_numerator = 3;
-			constexpr uint32_t scale_denominator = 4;
-
-			const uint64_t new_average_reparse_time_in_milliseconds =
-				new_average_reparse_time_in_microseconds / 1000;
-			
-			const uint64_t scaled_component_in_milliseconds =
-				(scale_numerator * new_average_reparse_time_in_milliseconds) / scale_denominator;
-			
-			auto new_debounce_time_in_milliseconds =
-				static_cast<uint32_t>(
-					baseline_debounce_time_in_milliseconds + scaled_component_in_milliseconds
-				);
-			
-			// Clamp
-			new_debounce_time_in_milliseconds = std::clamp(
-				new_debounce_time_in_milliseconds,
-				minimum_debounce_time_in_milliseconds,
-				maximum_debounce_time_in_milliseconds
-			);
-			debounce_state->debounce_time_in_milliseconds.store(
-				new_debounce_time_in_milliseconds,
-				std::memory_order_release
-			);
-
-			processing_didChange.store(false, std::memory_order_release);
-		}).detach();
+		logMemoryUsage();
+		return true;
+	});
 }
@@ -25,17 +25,18 @@ void bpp::BashppServer::handleDidChangeWatchedFiles(const GenericNotificationMes
 		try {
 			uri = validateUri(change.uri);
 		} catch (const std::exception& e) {
-			log("Invalid URI in DidChangeWatchedFiles notification: ", e.what());
+			log(Logger::Level::Warning, "Invalid URI in DidChangeWatchedFiles notification: ", e.what());
 			return;
 		}
 
 		program_pool.remove_unsaved_file_contents(uri); // Remove unsaved changes for this URI
+		reindexWorkspaceFile(uri); // Drops the file from the workspace index if it's been deleted
 
 		log("Re-parsing program for URI: ", uri);
 		std::vector<std::shared_ptr<bpp::bpp_program>> programs = program_pool.re_parse_programs(uri);
 
 		if (programs.empty()) {
-			log("Failed to re-parse any programs for URI: ", uri);
+			log(Logger::Level::Warning, "Failed to re-parse any programs for URI: ", uri);
 			return; // Don't allow failed parses to affect debounce timing
 		}
 
@@ -43,7 +44,7 @@ void bpp::BashppServer::handleDidChangeWatchedFiles(const GenericNotificationMes
 			if (program != nullptr) {
 				publishDiagnostics(program);
 			} else {
-				log("Failed to re-parse a program for URI: ", uri);
+				log(Logger::Level::Warning, "Failed to re-parse a program for URI: ", uri);
 			}
 		}
 	}
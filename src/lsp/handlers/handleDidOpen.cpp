@@ -20,16 +20,18 @@ void bpp::BashppServer::handleDidOpen(const GenericNotificationMessage& request)
 	try {
 		uri = validateUri(did_open_notification.params.textDocument.uri);
 	} catch (const std::exception& e) {
-		log("Invalid URI in DidOpen notification: ", e.what());
+		log(Logger::Level::Warning, "Invalid URI in DidOpen notification: ", e.what());
 		return;
 	}
 
 	std::shared_ptr<bpp::bpp_program> program = program_pool.get_program(uri);
 	log("Finished parsing: ", uri);
 	if (program == nullptr) {
-		log("Failed to parse program: ", uri);
+		log(Logger::Level::Warning, "Failed to parse program: ", uri);
 		return;
 	}
 	publishDiagnostics(program);
 	program_pool.open_file(uri); // Mark the file as open
+	document_versions.reset(uri, did_open_notification.params.textDocument.version);
+	logMemoryUsage();
 }
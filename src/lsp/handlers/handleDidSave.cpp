@@ -20,9 +20,10 @@ void bpp::BashppServer::handleDidSave(const GenericNotificationMessage& request)
 	try {
 		uri = validateUri(did_save_notification.params.textDocument.uri);
 	} catch (const std::exception& e) {
-		log("Invalid URI in DidSave notification: ", e.what());
+		log(Logger::Level::Warning, "Invalid URI in DidSave notification: ", e.what());
 		return;
 	}
 
 	program_pool.remove_unsaved_file_contents(uri); // Remove unsaved changes for this URI
+	reindexWorkspaceFile(uri);
 }
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <lsp/BashppServer.h>
+#include <lsp/generated/DocumentDiagnosticRequest.h>
+#include <lsp/generated/ErrorCodes.h>
+#include <lsp/include/validateUri.h>
+
+#include <bpp_include/bpp_program.h>
+
+GenericResponseMessage bpp::BashppServer::handleDocumentDiagnostic(const GenericRequestMessage& request) {
+	DocumentDiagnosticRequestResponse response;
+	response.id = request.id;
+	DocumentDiagnosticRequest diagnostic_request = request.toSpecific<DocumentDiagnosticParams>();
+	const std::string& file_uri = diagnostic_request.params.textDocument.uri;
+	std::string uri;
+
+	try {
+		uri = validateUri(file_uri);
+	} catch (const std::exception& e) {
+		log(Logger::Level::Warning, "Invalid URI in Document Diagnostic request: ", e.what());
+		response.error = ResponseError{
+			static_cast<int>(ErrorCodes::InvalidParams),
+			"Invalid URI: " + file_uri, nullptr};
+		return response;
+	}
+
+	// Report on the newest version of the document the client has sent us
+	const int64_t version = document_versions.get_expected_version(uri);
+	const auto deadline = DocumentVersionBarrier::Clock::now() + document_version_timeout;
+	if (document_versions.wait_until_applied(uri, version, deadline)) {
+		debounce_scheduler.flush(uri);
+	}
+	if (!document_versions.wait_until_analyzed(uri, version, deadline)) {
+		// If the newer analysis changes the diagnostics, the client will be asked to pull them again
+		log(Logger::Level::Warning, "Timed out waiting for version ", version, " of ", uri, " to be analyzed, reporting diagnostics from older analysis");
+	}
+
+	std::shared_ptr<bpp::bpp_program> program = program_pool.get_program(uri);
+	std::vector<bpp::diagnostic> diagnostics;
+	if (program != nullptr) diagnostics = program->get_diagnostics(uri);
+
+	const uint64_t diagnostics_hash = DiagnosticsTracker::hash(diagnostics);
+	const std::string result_id = DiagnosticsTracker::to_result_id(diagnostics_hash);
+	diagnostics_tracker.record(uri, diagnostics_hash);
+
+	if (diagnostic_request.params.previousResultId.has_value() && diagnostic_request.params.previousResultId.value() == result_id) {
+		// The client already has these exact diagnostics
+		RelatedUnchangedDocumentDiagnosticReport report;
+		report.resultId = result_id;
+		response.result = report;
+		return response;
+	}
+
+	RelatedFullDocumentDiagnosticReport report;
+	report.resultId = result_id;
+	report.items = toLspDiagnostics(diagnostics);
+	log("Reporting ", diagnostics.size(), " diagnostics for file: ", uri);
+	response.result = report;
+	return response;
+}
@@ -15,7 +15,7 @@
 #include <bpp_include/bpp_object.h>
 
 GenericResponseMessage bpp::BashppServer::handleDocumentSymbol(const GenericRequestMessage& request) {
-	DocumentSymbolRequestResponse response;
+	GenericResponseMessage response;
 	response.id = request.id;
 	DocumentSymbolRequest document_symbol_request = request.toSpecific<DocumentSymbolParams>();
 	std::string uri;
@@ -23,7 +23,7 @@ GenericResponseMessage bpp::BashppServer::handleDocumentSymbol(const GenericRequ
 	try {
 		uri = validateUri(document_symbol_request.params.textDocument.uri);
 	} catch (const std::exception& e) {
-		log("Invalid URI in Document Symbol request: ", e.what());
+		log(Logger::Level::Warning, "Invalid URI in Document Symbol request: ", e.what());
 		response.result = nullptr;
 		return response;
 	}
@@ -35,6 +35,12 @@ GenericResponseMessage bpp::BashppServer::handleDocumentSymbol(const GenericRequ
 		return response;
 	}
 
+	std::optional<nlohmann::json> cached_result = query_cache.get(program, QueryCache::Kind::DocumentSymbol, nullptr, uri);
+	if (cached_result.has_value()) {
+		response.result = std::move(cached_result.value());
+		return response;
+	}
+
 	std::vector<DocumentSymbol> result;
 
 	// First, populate with all the classes whose definition positions are within the requested document
@@ -113,5 +119,6 @@ GenericResponseMessage bpp::BashppServer::handleDocumentSymbol(const GenericRequ
 	}
 
 	response.result = result;
+	query_cache.put(program, QueryCache::Kind::DocumentSymbol, nullptr, uri, response.result);
 	return response;
 }
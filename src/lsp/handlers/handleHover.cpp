@@ -16,7 +16,7 @@
 #include <bpp_include/bpp_datamember.h>
 
 GenericResponseMessage bpp::BashppServer::handleHover(const GenericRequestMessage& request) {
-	HoverRequestResponse response;
+	GenericResponseMessage response;
 	response.id = request.id;
 	HoverRequest hover_request = request.toSpecific<HoverParams>();
 	std::string uri = hover_request.params.textDocument.uri;
@@ -27,7 +27,7 @@ GenericResponseMessage bpp::BashppServer::handleHover(const GenericRequestMessag
 	try {
 		uri = validateUri(hover_request.params.textDocument.uri);
 	} catch (const std::exception& e) {
-		log("Invalid URI in Hover request: ", e.what());
+		log(Logger::Level::Warning, "Invalid URI in Hover request: ", e.what());
 		response.result = nullptr;
 		return response;
 	}
@@ -58,6 +58,13 @@ GenericResponseMessage bpp::BashppServer::handleHover(const GenericRequestMessag
 		return response;
 	}
 
+	// The hover text depends only on the entity, so every hover over any reference to it can share the same result
+	std::optional<nlohmann::json> cached_result = query_cache.get(program, QueryCache::Kind::Hover, entity, "");
+	if (cached_result.has_value()) {
+		response.result = std::move(cached_result.value());
+		return response;
+	}
+
 	std::string hover_text = entity->get_name(); // Fallback in case we can't determine the type of entity
 
 	// First, determine what kind of entity it is
@@ -65,9 +72,12 @@ GenericResponseMessage bpp::BashppServer::handleHover(const GenericRequestMessag
 	std::shared_ptr<bpp::bpp_datamember> datamember = std::dynamic_pointer_cast<bpp::bpp_datamember>(entity);
 	if (datamember) {
 		hover_text = "";
-		// If it's a data member, display [@ClassName[*]] @ContainingClass.dataMemberName
+		// If it's a data member, display [@const] [@ClassName[*]] @ContainingClass.dataMemberName
+		if (datamember->is_const()) {
+			hover_text = "@const ";
+		}
 		if (datamember->get_class() != nullptr) {
-			hover_text = "@" + datamember->get_class()->get_name();
+			hover_text += "@" + datamember->get_class()->get_name();
 			if (datamember->is_pointer()) {
 				hover_text += "*";
 			}
@@ -80,7 +90,7 @@ GenericResponseMessage bpp::BashppServer::handleHover(const GenericRequestMessag
 		} else {
 			// Failsafe:
 			// If we fail to lock the containing class weak ptr:
-			log("Failed to lock containing class for data member: ", datamember->get_name(), " in URI: ", uri);
+			log(Logger::Level::Warning, "Failed to lock containing class for data member: ", datamember->get_name(), " in URI: ", uri);
 			hover_text += "@<error>." + datamember->get_name();
 		}
 	}
@@ -99,8 +109,11 @@ GenericResponseMessage bpp::BashppServer::handleHover(const GenericRequestMessag
 
 	std::shared_ptr<bpp::bpp_method> method = std::dynamic_pointer_cast<bpp::bpp_method>(entity);
 	if (method) {
-		// If it's a method, display [@virtual] {@public | @private | @protected} @method @ClassName.methodName [parameter list]
+		// If it's a method, display [@inline] [@virtual] {@public | @private | @protected} @method @ClassName.methodName [parameter list]
 		hover_text = "";
+		if (method->has_inline_hint()) {
+			hover_text += "@inline ";
+		}
 		if (method->is_virtual()) {
 			hover_text += "@virtual ";
 		}
@@ -149,11 +162,12 @@ GenericResponseMessage bpp::BashppServer::handleHover(const GenericRequestMessag
 
 	if (hover_text.empty()) {
 		response.result = nullptr;
+		query_cache.put(program, QueryCache::Kind::Hover, entity, "", response.result);
 		return response; // No hover text available
 	}
 
 	// Search for any relevant comments associated with the entity
-	std::string comments = find_comments_for_entity(entity, &program_pool);
+	std::string comments = find_comments_for_entity(entity, program, &program_pool);
 
 	if (!comments.empty()) {
 		hover_text += "\n\n" + comments; // Append comments if available
@@ -166,6 +180,7 @@ GenericResponseMessage bpp::BashppServer::handleHover(const GenericRequestMessag
 	hover.contents = hoverContent;
 
 	response.result = hover;
+	query_cache.put(program, QueryCache::Kind::Hover, entity, "", response.result);
 
 	return response;
 }
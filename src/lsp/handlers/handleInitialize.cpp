@@ -8,6 +8,10 @@
 
 #include <lsp/generated/InitializeRequest.h>
 #include <lsp/generated/InitializeResult.h>
+#include <lsp/include/validateUri.h>
+#include <listener/BashppListener.h>
+
+#include <filesystem>
 
 GenericResponseMessage bpp::BashppServer::handleInitialize(const GenericRequestMessage& request) {
 	InitializeRequest initialize_request = request.toSpecific<InitializeParams>();
@@ -15,7 +19,7 @@ GenericResponseMessage bpp::BashppServer::handleInitialize(const GenericRequestM
 	response.id = request.id;
 
 	InitializeResult result;
-	result.capabilities.textDocumentSync = TextDocumentSyncKind::Full; // Full sync mode
+	result.capabilities.textDocumentSync = TextDocumentSyncKind::Incremental; // Incremental sync mode
 
 	// Advertise that we support hover requests
 	result.capabilities.hoverProvider = true;
@@ -38,8 +42,26 @@ GenericResponseMessage bpp::BashppServer::handleInitialize(const GenericRequestM
 	// Advertise that we support DocumentSymbol requests
 	result.capabilities.documentSymbolProvider = true;
 
-	// Planned but not yet implemented:
-	//result.capabilities.workspaceSymbolProvider = true;
+	// Advertise that we support WorkspaceSymbol requests
+	result.capabilities.workspaceSymbolProvider = true;
+
+	// If the client supports pulling diagnostics, let it pull them rather than pushing them
+	// A file's diagnostics can depend on the files it includes, so an edit to one file can change another's diagnostics
+	if (initialize_request.params.capabilities.textDocument.has_value()
+		&& initialize_request.params.capabilities.textDocument->diagnostic.has_value()
+	) {
+		pull_diagnostics = true;
+		result.capabilities.diagnosticProvider = DiagnosticOptions{
+			.interFileDependencies = true,
+			.workspaceDiagnostics = false
+		};
+	}
+	if (initialize_request.params.capabilities.workspace.has_value()
+		&& initialize_request.params.capabilities.workspace->diagnostics.has_value()
+		&& initialize_request.params.capabilities.workspace->diagnostics->refreshSupport.value_or(false)
+	) {
+		diagnostic_refresh_support = true;
+	}
 
 	// If the client advertises that it supports UTF-8 position data, respond to let it know that's what we'll be sending
 	if (initialize_request.params.capabilities.general.has_value()
@@ -52,6 +74,38 @@ GenericResponseMessage bpp::BashppServer::handleInitialize(const GenericRequestM
 		result.capabilities.positionEncoding = PositionEncodingKind::UTF16;
 	}
 
+	// Parse the standard library in the background,
+	// so that programs which include it don't have to wait for it to be parsed on first use
+	// It's background work, so it mustn't hold up the first real requests
+	thread_pool->enqueue([this]() {
+		const size_t parsed_files = program_pool.warm_parse_cache(BashppListener::standard_library_path);
+		log("Pre-parsed ", parsed_files, " standard library files.");
+	}, ThreadPool::Priority::Background);
+
+	// Index every Bash++ file in the workspace in the background, for workspace/symbol
+	// Workspace folders take precedence over the (deprecated) root URI
+	std::vector<std::string> root_uris;
+	if (initialize_request.params.workspaceFolders.has_value()
+		&& std::holds_alternative<std::vector<WorkspaceFolder>>(*initialize_request.params.workspaceFolders)
+	) {
+		for (const auto& folder : std::get<std::vector<WorkspaceFolder>>(*initialize_request.params.workspaceFolders)) {
+			root_uris.push_back(folder.uri);
+		}
+	} else if (std::holds_alternative<std::string>(initialize_request.params.rootUri)) {
+		root_uris.push_back(std::get<std::string>(initialize_request.params.rootUri));
+	}
+
+	for (const auto& root_uri : root_uris) {
+		try {
+			std::error_code error;
+			const std::string root = std::filesystem::canonical(validateUri(root_uri), error).string();
+			if (!error) workspace_roots.push_back(root);
+		} catch (const std::exception& e) {
+			log(Logger::Level::Warning, "Ignoring invalid workspace root: ", e.what());
+		}
+	}
+	indexWorkspace();
+
 	response.result = result;
 
 	return response;
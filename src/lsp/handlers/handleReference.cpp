@@ -12,6 +12,8 @@
 
 #include <bpp_include/bpp_entity.h>
 
+#include <algorithm>
+
 GenericResponseMessage bpp::BashppServer::handleReferences(const GenericRequestMessage& request) {
 	ReferencesRequestResponse response;
 	response.id = request.id;
@@ -21,7 +23,7 @@ GenericResponseMessage bpp::BashppServer::handleReferences(const GenericRequestM
 	try {
 		uri = validateUri(reference_request.params.textDocument.uri);
 	} catch (const std::exception& e) {
-		log("Invalid URI in References request: ", e.what());
+		log(Logger::Level::Warning, "Invalid URI in References request: ", e.what());
 		response.error = ResponseError{
 			static_cast<int>(ErrorCodes::InvalidParams),
 			"Invalid URI: " + reference_request.params.textDocument.uri, nullptr};
@@ -42,35 +44,38 @@ GenericResponseMessage bpp::BashppServer::handleReferences(const GenericRequestM
 		return response;
 	}
 
-	std::vector<Location> locations;
+	// The same reference may be found more than once
+	// (e.g., in the event that multiple programs include this source file),
+	// So we sort the references and drop the duplicates before building any locations
+	std::vector<bpp::ReferencePosition> references;
 	for (const auto& entity : entities) {
-		for (const auto& pos : entity->get_references()) {
-			log("Found reference in file: ", pos.file, " at line: ", pos.line, " character: ", pos.column);
-			std::string file_uri = "file://" + pos.file;
-			Location loc;
-			loc.uri = file_uri;
-			loc.range.start.line = pos.line;
-			loc.range.start.character = pos.column;
-			loc.range.end.line = pos.line;
-			loc.range.end.character = pos.column + entity->get_name().length();
-
-			// Make sure we don't add duplicate locations
-			// (e.g., in the event that multiple programs
-			// include this source file, we may find the
-			// same reference multiple times)
-			bool already_added = std::ranges::any_of(locations, [&](const Location& existing_loc) {
-				return existing_loc.uri == loc.uri
-					&& existing_loc.range.start.line == loc.range.start.line
-					&& existing_loc.range.start.character == loc.range.start.character
-					&& existing_loc.range.end.line == loc.range.end.line
-					&& existing_loc.range.end.character == loc.range.end.character;
-			});
+		const auto& entity_references = entity->get_references();
+		references.insert(references.end(), entity_references.begin(), entity_references.end());
+	}
+	std::sort(references.begin(), references.end());
+	references.erase(std::unique(references.begin(), references.end()), references.end());
 
-			if (!already_added) {
-				locations.push_back(loc);
-			}
+	const auto name_length = static_cast<uint32_t>(entities.front()->get_name().length());
+	std::vector<Location> locations;
+	locations.reserve(references.size());
+	std::string file_uri;
+	bpp::FileId current_file = 0;
+	for (const auto& pos : references) {
+		// References are sorted by file, so we only build each file's URI once
+		if (file_uri.empty() || pos.file != current_file) {
+			file_uri = "file://" + pos.get_file();
+			current_file = pos.file;
 		}
+
+		Location loc;
+		loc.uri = file_uri;
+		loc.range.start.line = pos.line;
+		loc.range.start.character = pos.column;
+		loc.range.end.line = pos.line;
+		loc.range.end.character = pos.column + name_length;
+		locations.push_back(std::move(loc));
 	}
+	log(Logger::Level::Debug, "Found ", locations.size(), " references");
 
 	response.result = locations;
 	return response;
@@ -16,6 +16,8 @@
 #include <bpp_include/bpp_class.h>
 #include <bpp_include/bpp_method.h>
 
+#include <algorithm>
+
 GenericResponseMessage bpp::BashppServer::handleRename(const GenericRequestMessage& request) {
 	RenameRequestResponse response;
 	response.id = request.id;
@@ -25,7 +27,7 @@ GenericResponseMessage bpp::BashppServer::handleRename(const GenericRequestMessa
 	try {
 		uri = validateUri(rename_request.params.textDocument.uri);
 	} catch (const std::exception& e) {
-		log("Invalid URI in Rename request: ", e.what());
+		log(Logger::Level::Warning, "Invalid URI in Rename request: ", e.what());
 		response.error = ResponseError{
 			static_cast<int>(ErrorCodes::InvalidParams),
 			"Invalid URI: " + rename_request.params.textDocument.uri, nullptr};
@@ -35,7 +37,7 @@ GenericResponseMessage bpp::BashppServer::handleRename(const GenericRequestMessa
 	std::string new_name = rename_request.params.newName;
 	// Basic validation: Does the name satisfy Bash++ naming rules?
 	if (!bpp::is_valid_identifier(new_name)) {
-		log("Invalid new name for entity: ", new_name);
+		log(Logger::Level::Warning, "Invalid new name for entity: ", new_name);
 		response.error = ResponseError{
 			static_cast<int>(ErrorCodes::InvalidParams),
 			"Invalid new name: " + new_name, nullptr};
@@ -92,31 +94,35 @@ GenericResponseMessage bpp::BashppServer::handleRename(const GenericRequestMessa
 	WorkspaceEdit edit;
 	std::unordered_map<std::string, std::vector<TextEdit>> changes;
 
+	// Gather everywhere the entities are referenced
+	// The same reference may be found more than once
+	// (e.g., in the event that multiple programs include this source file),
+	// So we sort the references and drop the duplicates before building any edits
+	std::vector<bpp::ReferencePosition> references;
 	for (const auto& entity : entities) {
-		// Get a list of everywhere the entity is referenced
-		std::list<bpp::SymbolPosition> references = entity->get_references();
-
-		for (const auto& ref : references) {
-			TextEdit single_rename;
-			single_rename.range.start.line = ref.line;
-			single_rename.range.start.character = ref.column;
-			single_rename.range.end.line = ref.line;
-			single_rename.range.end.character = ref.column + static_cast<uint32_t>(entity->get_name().size());
-			single_rename.newText = new_name;
-
-			// Make sure we don't add duplicate edits for the same file
-			// (e.g., in the event that multiple programs include this source file, we may find the same reference multiple times)
-			bool already_added = std::ranges::any_of(changes["file://" + ref.file], [&](const TextEdit& edit) {
-				return edit.range.start.line == single_rename.range.start.line
-					&& edit.range.start.character == single_rename.range.start.character
-					&& edit.range.end.line == single_rename.range.end.line
-					&& edit.range.end.character == single_rename.range.end.character;
-			});
-
-			if (!already_added) {
-				changes["file://" + ref.file].push_back(single_rename);
-			}
+		const auto& entity_references = entity->get_references();
+		references.insert(references.end(), entity_references.begin(), entity_references.end());
+	}
+	std::sort(references.begin(), references.end());
+	references.erase(std::unique(references.begin(), references.end()), references.end());
+
+	const auto name_length = static_cast<uint32_t>(old_name.size());
+	std::vector<TextEdit>* file_edits = nullptr;
+	bpp::FileId current_file = 0;
+	for (const auto& ref : references) {
+		// References are sorted by file, so we only look up each file's edit list once
+		if (file_edits == nullptr || ref.file != current_file) {
+			file_edits = &changes["file://" + ref.get_file()];
+			current_file = ref.file;
 		}
+
+		TextEdit single_rename;
+		single_rename.range.start.line = ref.line;
+		single_rename.range.start.character = ref.column;
+		single_rename.range.end.line = ref.line;
+		single_rename.range.end.character = ref.column + name_length;
+		single_rename.newText = new_name;
+		file_edits->push_back(std::move(single_rename));
 	}
 
 	if (changes.empty()) {
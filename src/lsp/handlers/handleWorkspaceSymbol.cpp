@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2025 Andrew S. Rightenburg
+ * Bash++: Bash with classes
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <lsp/BashppServer.h>
+#include <lsp/generated/WorkspaceSymbolRequest.h>
+
+GenericResponseMessage bpp::BashppServer::handleWorkspaceSymbol(const GenericRequestMessage& request) {
+	WorkspaceSymbolRequestResponse response;
+	response.id = request.id;
+	WorkspaceSymbolRequest workspace_symbol_request = request.toSpecific<WorkspaceSymbolParams>();
+
+	// Answered from the workspace index, which may still be being built in the background
+	// In that case, we return whatever has been indexed so far
+	std::vector<WorkspaceIndex::Match> matches = workspace_index.query(workspace_symbol_request.params.query, workspace_symbol_limit);
+
+	std::vector<SymbolInformation> result;
+	result.reserve(matches.size());
+	for (const auto& match : matches) {
+		SymbolInformation symbol;
+		symbol.name = match.symbol.name;
+		switch (match.symbol.kind) {
+			case WorkspaceIndex::SymbolKind::Class:
+				symbol.kind = SymbolKind::Class;
+				break;
+			case WorkspaceIndex::SymbolKind::Method:
+				symbol.kind = SymbolKind::Method;
+				break;
+			case WorkspaceIndex::SymbolKind::Datamember:
+				symbol.kind = SymbolKind::Property;
+				break;
+		}
+		if (!match.symbol.container_name.empty()) symbol.containerName = match.symbol.container_name;
+
+		symbol.location.uri = "file://" + match.file;
+		symbol.location.range.start.line = match.symbol.line;
+		symbol.location.range.start.character = match.symbol.column;
+		symbol.location.range.end.line = match.symbol.line;
+		symbol.location.range.end.character = match.symbol.column + static_cast<uint32_t>(match.symbol.name.size());
+		result.push_back(std::move(symbol));
+	}
+
+	log("Found ", result.size(), " workspace symbols matching: ", workspace_symbol_request.params.query);
+	response.result = std::move(result);
+	return response;
+}
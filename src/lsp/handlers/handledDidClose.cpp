@@ -17,11 +17,14 @@ void bpp::BashppServer::handleDidClose(const GenericNotificationMessage& request
 	try {
 		uri = validateUri(did_close_notification.params.textDocument.uri);
 	} catch (const std::exception& e) {
-		log("Invalid URI in DidClose notification: ", e.what());
+		log(Logger::Level::Warning, "Invalid URI in DidClose notification: ", e.what());
 		return;
 	}
 
 	// If we've stored unsaved changes for this URI, we can remove them
 	program_pool.remove_unsaved_file_contents(uri);
 	program_pool.close_file(uri); // Mark the file as closed
+	debounce_scheduler.forget(uri); // Drop any pending reparse for the closed file
+	document_versions.forget(uri); // Release any requests waiting on the closed file
+	diagnostics_tracker.forget(uri); // Send the file's diagnostics in full if it's reopened
 }
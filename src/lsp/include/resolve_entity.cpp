@@ -16,34 +16,6 @@
 #include <bpp_include/bpp_method.h>
 #include <bpp_include/bpp_datamember.h>
 
-std::shared_ptr<AST::ASTNode> find_node_at_position(std::shared_ptr<AST::ASTNode> node, uint32_t line, uint32_t column) {
-	if (node == nullptr) return nullptr;
-
-	uint32_t start_line = node->getLine();
-	uint32_t start_column = node->getCharPositionInLine();
-	uint32_t stop_line = node->getEndPosition().line;
-	uint32_t stop_column = node->getEndPosition().column;
-
-	// Combine line and column into a single 64-bit value for easier comparison
-	// The upper 32 bits are the line, the lower 32 bits are the column
-	uint64_t start_pos = (static_cast<uint64_t>(start_line) << 32) | start_column;
-	uint64_t stop_pos = (static_cast<uint64_t>(stop_line) << 32) | stop_column;
-
-	uint64_t target_pos = (static_cast<uint64_t>(line) << 32) | column;
-
-	if (target_pos < start_pos || target_pos > stop_pos) {
-		return nullptr; // Position is outside the range of this node
-	}
-
-	for (const auto& child : node->getChildren()) {
-		if (child) {
-			std::shared_ptr<AST::ASTNode> result = find_node_at_position(child, line, column);
-			if (result) return result; // Found a child node that matches the column
-		}
-	}
-	return node;
-}
-
 std::shared_ptr<bpp::bpp_entity> resolve_entity_at(
 	const std::string& file,
 	uint32_t line,
@@ -58,10 +30,7 @@ std::shared_ptr<bpp::bpp_entity> resolve_entity_at(
 		context = program;
 	}
 
-	auto astRoot = program->get_source_file_ast(file);
-	if (!astRoot) return nullptr;
-
-	auto node = find_node_at_position(astRoot, line, column);
+	auto node = program->find_node_at(file, line, column);
 	if (!node) return nullptr;
 
 	if (node->getType() == AST::NodeType::ValueAssignment) {
@@ -69,7 +38,7 @@ std::shared_ptr<bpp::bpp_entity> resolve_entity_at(
 		// Try to back up one character and try again
 		// TODO(@rail5): Hacky fix, improve later
 		if (column > 0) {
-			node = find_node_at_position(astRoot, line, column - 1);
+			node = program->find_node_at(file, line, column - 1);
 			if (!node) return nullptr;
 		}
 	}
@@ -390,7 +359,11 @@ std::vector<std::shared_ptr<bpp::bpp_entity>> find_all_entities_for(
 	return entities;
 }
 
-std::string find_comments_for_entity(std::shared_ptr<bpp::bpp_entity> entity, ProgramPool* program_pool) {
+std::string find_comments_for_entity(
+	std::shared_ptr<bpp::bpp_entity> entity,
+	std::shared_ptr<bpp::bpp_program> program,
+	ProgramPool* program_pool
+) {
 	if (entity == nullptr) {
 		return "";
 	}
@@ -402,33 +375,13 @@ std::string find_comments_for_entity(std::shared_ptr<bpp::bpp_entity> entity, Pr
 		return ""; // No known source file, no alternative contents provided
 	}
 
-	std::istringstream source_file_contents(program_pool->get_file_contents(definition_position.file));
-
-	std::string comments;
-	std::string line;
-	uint32_t current_line = 0;
-	while (std::getline(source_file_contents, line)) {
-		if (current_line >= definition_position.line) {
-			break; // Stop reading after reaching the definition line
-		}
-		current_line++;
-
-		size_t comment_start = line.find('#');
-		if (comment_start != std::string::npos) {
-			// Extract the comment part
-			std::string comment = line.substr(comment_start);
-			// Trim leading whitespace from the comment
-			comment.erase(0, comment.find_first_not_of(" \t"));
-
-			if (!comments.empty()) {
-				comments += "\n"; // Separate comments with a newline
-			}
-			comments += comment; // Append this comment to the comment block
-		} else {
-			comments.clear(); // A comment block ended, and we still haven't hit the definition line
-				// In other words: the previous comment block is not associated with the entity
-				// Therefore, clear it
-		}
+	// The comments were indexed when the file was parsed
+	std::shared_ptr<AST::Program> ast = program == nullptr ? nullptr : program->get_source_file_ast(definition_position.file);
+	std::shared_ptr<const AST::CommentIndex> comment_index = ast == nullptr ? nullptr : ast->get_comment_index();
+	if (comment_index != nullptr) {
+		return comment_index->comments_before(definition_position.line);
 	}
-	return comments;
+
+	// Failsafe: the file wasn't parsed from contents we had in memory, so we have to read it
+	return AST::CommentIndex(program_pool->get_file_contents(definition_position.file)).comments_before(definition_position.line);
 }
@@ -13,8 +13,6 @@
 #include <AST/ASTNode.h>
 #include <bpp_include/bpp_codegen.h>
 
-std::shared_ptr<AST::ASTNode> find_node_at_position(std::shared_ptr<AST::ASTNode> node, uint32_t line, uint32_t column);
-
 /**
  * @brief Resolves the entity referenced at the given line and column in the specified file.
  * 
@@ -62,9 +60,17 @@ std::vector<std::shared_ptr<bpp::bpp_entity>> find_all_entities_for(
  * 
  * This function searches for contiguous comment blocks that are located immediately before the entity's definition position.
  * It returns a string containing the comments, or an empty string if no comments are found.
+ *
+ * The comments are looked up in the comment index built when the source file was parsed,
+ * so the file doesn't have to be read again.
  * 
  * @param entity The entity to find comments for.
- * @param program_pool The program pool to use for accessing source files.
+ * @param program The program in which the entity was resolved.
+ * @param program_pool The program pool to use for accessing source files, if the program has no comment index for the file.
  * @return A string containing the comments associated with the entity, or an empty string if no comments are found.
  */
-std::string find_comments_for_entity(std::shared_ptr<bpp::bpp_entity> entity, ProgramPool* program_pool);
+std::string find_comments_for_entity(
+	std::shared_ptr<bpp::bpp_entity> entity,
+	std::shared_ptr<bpp::bpp_program> program,
+	ProgramPool* program_pool
+);
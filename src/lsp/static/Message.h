@@ -73,10 +73,13 @@ struct NotificationMessage;
 /**
  * @struct GenericRequestMessage
  * @brief A generic type that can be converted to/from any specific RequestMessage type.
+ *
+ * The params are kept as the JSON value they were parsed as,
+ * so that toSpecific() can decode them directly into the specific ParamsType.
  * 
  */
 struct GenericRequestMessage : public RequestMessageBase {
-	LSPAny params;
+	nlohmann::json params;
 
 	GenericRequestMessage() = default;
 
@@ -85,9 +88,7 @@ struct GenericRequestMessage : public RequestMessageBase {
 		jsonrpc = msg.jsonrpc;
 		id = msg.id;
 		method = msg.method;
-		nlohmann::json j;
-		nlohmann::adl_serializer<ParamsType>::to_json(j, msg.params);
-		params = j.get<LSPAny>(); // Store params as LSPAny
+		nlohmann::adl_serializer<ParamsType>::to_json(params, msg.params);
 	}
 
 	friend void to_json(nlohmann::json& j, const GenericRequestMessage& msg) {
@@ -95,7 +96,7 @@ struct GenericRequestMessage : public RequestMessageBase {
 		j["jsonrpc"] = msg.jsonrpc;
 		j["id"] = msg.id;
 		j["method"] = msg.method;
-		j["params"] = msg.params; // Serialize params as LSPAny
+		j["params"] = msg.params;
 	}
 
 	friend void from_json(const nlohmann::json& j, GenericRequestMessage& msg) {
@@ -103,17 +104,32 @@ struct GenericRequestMessage : public RequestMessageBase {
 		j.at("id").get_to(msg.id);
 		j.at("method").get_to(msg.method);
 		if (j.contains("params")) {
-			msg.params = j.at("params").get<LSPAny>();
+			msg.params = j.at("params");
 		} else {
 			msg.params = nullptr; // Default to null if not present
 		}
 	}
 
+	/**
+	 * @brief Build a GenericRequestMessage from a parsed message, taking ownership of its params
+	 *
+	 * Unlike from_json, this moves the params out of the parsed message rather than copying them.
+	 */
+	static GenericRequestMessage fromJson(nlohmann::json&& j) {
+		GenericRequestMessage msg;
+		j.at("jsonrpc").get_to(msg.jsonrpc);
+		j.at("id").get_to(msg.id);
+		j.at("method").get_to(msg.method);
+		if (auto it = j.find("params"); it != j.end()) {
+			msg.params = std::move(*it);
+		}
+		return msg;
+	}
+
 	/**
 	 * @brief Convert this GenericRequestMessage to a specific RequestMessage type.
 	 *
-	 * This method allows converting the generic message to a specific type based on the ParamsType.
-	 * It uses the JSON serialization/deserialization to convert the params field to the specific type.
+	 * The params are decoded straight from the parsed JSON into ParamsType
 	 * 
 	 * @tparam ParamsType The specific parameters type to convert to.
 	 * @return RequestMessage<ParamsType> The specific RequestMessage type with the converted parameters.
@@ -124,11 +140,9 @@ struct GenericRequestMessage : public RequestMessageBase {
 		specific.jsonrpc = jsonrpc;
 		specific.id = id;
 		specific.method = method;
-
-		nlohmann::json j;
-		nlohmann::adl_serializer<LSPAny>::to_json(j, params);
-		specific.params = j.get<ParamsType>(); // Convert JSON to ParamsType
-
+		if (!params.is_null()) {
+			params.get_to(specific.params);
+		}
 		return specific;
 	}
 };
@@ -136,10 +150,13 @@ struct GenericRequestMessage : public RequestMessageBase {
 /**
  * @struct GenericResponseMessage
  * @brief A generic type that can be converted to/from any specific ResponseMessage type.
+ *
+ * The result is serialized once, directly from the specific ResultType,
+ * and kept as JSON until the response is written out.
  * 
  */
 struct GenericResponseMessage : public ResponseMessageBase {
-	LSPAny result;
+	nlohmann::json result;
 
 	GenericResponseMessage() = default;
 
@@ -150,9 +167,7 @@ struct GenericResponseMessage : public ResponseMessageBase {
 		if (msg.error.has_value()) {
 			error = msg.error.value(); // Store error if present
 		} else {
-			nlohmann::json j;
-			nlohmann::adl_serializer<ResultType>::to_json(j, msg.result);
-			result = j.get<LSPAny>(); // Store result as LSPAny
+			nlohmann::adl_serializer<ResultType>::to_json(result, msg.result);
 		}
 	}
 
@@ -163,7 +178,7 @@ struct GenericResponseMessage : public ResponseMessageBase {
 		if (msg.error.has_value()) {
 			j["error"] = msg.error.value(); // Serialize error if present
 		} else {
-			j["result"] = msg.result; // Serialize result as LSPAny
+			j["result"] = msg.result;
 		}
 	}
 
@@ -174,34 +189,49 @@ struct GenericResponseMessage : public ResponseMessageBase {
 			msg.error = j.at("error").get<ResponseError>();
 			msg.result = nullptr; // Default result if error is present
 		} else {
-			msg.result = j.at("result").get<LSPAny>();
+			msg.result = j.at("result");
 			msg.error = {0, "", nullptr}; // Default error if not present
 		}
 	}
 
-	template <typename ResultType>
-	static GenericResponseMessage fromSpecific(const ResponseMessage<ResultType>& specific) {
-		GenericResponseMessage generic;
-		generic.jsonrpc = specific.jsonrpc;
-		generic.id = specific.id;
-
-		if (specific.error.has_value()) {
-			generic.error = specific.error.value(); // Store error if present
-		} else {
-			generic.result = specific.result; // Store result as LSPAny
+	/**
+	 * @brief Serialize this response to a JSON string
+	 *
+	 * The envelope is written around the already-serialized result,
+	 * so the result is never copied into a second JSON object.
+	 */
+	std::string dump() const {
+		nlohmann::json envelope = nlohmann::json::object();
+		envelope["jsonrpc"] = jsonrpc;
+		envelope["id"] = id;
+		if (error.has_value()) {
+			envelope["error"] = error.value();
+			return envelope.dump();
 		}
 
-		return generic;
+		std::string output = envelope.dump();
+		output.pop_back(); // Remove the closing brace
+		output += ",\"result\":";
+		output += result.dump();
+		output += '}';
+		return output;
+	}
+
+	template <typename ResultType>
+	static GenericResponseMessage fromSpecific(const ResponseMessage<ResultType>& specific) {
+		return GenericResponseMessage(specific);
 	}
 };
 
 /**
  * @struct GenericNotificationMessage
  * @brief A generic type that can be converted to/from any specific NotificationMessage type.
+ *
+ * As with GenericRequestMessage, the params are kept as parsed JSON until toSpecific() decodes them.
  * 
  */
 struct GenericNotificationMessage : public NotificationMessageBase {
-	LSPAny params;
+	nlohmann::json params;
 
 	GenericNotificationMessage() = default;
 
@@ -209,48 +239,69 @@ struct GenericNotificationMessage : public NotificationMessageBase {
 	GenericNotificationMessage(const NotificationMessage<ParamsType>& msg) {
 		jsonrpc = msg.jsonrpc;
 		method = msg.method;
-		nlohmann::json j;
-		nlohmann::adl_serializer<ParamsType>::to_json(j, msg.params);
-		params = j.get<LSPAny>(); // Store params as LSPAny
+		nlohmann::adl_serializer<ParamsType>::to_json(params, msg.params);
 	}
 
 	friend void to_json(nlohmann::json& j, const GenericNotificationMessage& msg) {
 		j = nlohmann::json::object();
 		j["jsonrpc"] = msg.jsonrpc;
 		j["method"] = msg.method;
-		j["params"] = msg.params; // Serialize params as LSPAny
+		j["params"] = msg.params;
 	}
 
 	friend void from_json(const nlohmann::json& j, GenericNotificationMessage& msg) {
 		j.at("jsonrpc").get_to(msg.jsonrpc);
 		j.at("method").get_to(msg.method);
 		if (j.contains("params")) {
-			msg.params = j.at("params").get<LSPAny>();
+			msg.params = j.at("params");
 		} else {
 			msg.params = nullptr; // Default to null if not present
 		}
 	}
 
+	/**
+	 * @brief Build a GenericNotificationMessage from a parsed message, taking ownership of its params
+	 */
+	static GenericNotificationMessage fromJson(nlohmann::json&& j) {
+		GenericNotificationMessage msg;
+		j.at("jsonrpc").get_to(msg.jsonrpc);
+		j.at("method").get_to(msg.method);
+		if (auto it = j.find("params"); it != j.end()) {
+			msg.params = std::move(*it);
+		}
+		return msg;
+	}
+
 	template <typename ParamsType>
 	NotificationMessage<ParamsType> toSpecific() const {
 		NotificationMessage<ParamsType> specific;
 		specific.jsonrpc = jsonrpc;
 		specific.method = method;
-		nlohmann::json j;
-		nlohmann::adl_serializer<LSPAny>::to_json(j, params);
-		specific.params = j.get<ParamsType>(); // Convert JSON to ParamsType
+		if (!params.is_null()) {
+			params.get_to(specific.params);
+		}
 		return specific;
 	}
 
+	/**
+	 * @brief Serialize this notification to a JSON string, without copying the params
+	 */
+	std::string dump() const {
+		nlohmann::json envelope = nlohmann::json::object();
+		envelope["jsonrpc"] = jsonrpc;
+		envelope["method"] = method;
+
+		std::string output = envelope.dump();
+		output.pop_back(); // Remove the closing brace
+		output += ",\"params\":";
+		output += params.dump();
+		output += '}';
+		return output;
+	}
+
 	template <typename ParamsType>
 	static GenericNotificationMessage fromSpecific(const NotificationMessage<ParamsType>& specific) {
-		GenericNotificationMessage generic;
-		generic.jsonrpc = specific.jsonrpc;
-		generic.method = specific.method;
-		nlohmann::json j;
-		nlohmann::adl_serializer<ParamsType>::to_json(j, specific.params);
-		generic.params = j.get<LSPAny>(); // Store params as LSPAny
-		return generic;
+		return GenericNotificationMessage(specific);
 	}
 };
 
@@ -348,9 +399,7 @@ struct ResponseMessage : public ResponseMessageBase {
 		if (error.has_value()) {
 			generic.error = error.value(); // Store error if present
 		} else {
-			nlohmann::json j;
-			nlohmann::adl_serializer<ResultType>::to_json(j, result);
-			generic.result = j.get<LSPAny>(); // Store result as LSPAny
+			nlohmann::adl_serializer<ResultType>::to_json(generic.result, result);
 		}
 
 		return generic;
@@ -410,9 +459,7 @@ struct NotificationMessage : public NotificationMessageBase {
 		GenericNotificationMessage generic;
 		generic.jsonrpc = jsonrpc;
 		generic.method = method;
-		nlohmann::json j;
-		nlohmann::adl_serializer<ParamsType>::to_json(j, params);
-		generic.params = j.get<LSPAny>(); // Store params as LSPAny
+		nlohmann::adl_serializer<ParamsType>::to_json(generic.params, params);
 		return generic;
 	}
 };
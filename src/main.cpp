@@ -139,6 +139,13 @@ int main(int argc, char* argv[]) {
 	listener->set_output_file(args.output_file().value_or(""));
 	listener->set_run_on_exit(args.run_on_exit());
 	listener->set_suppress_warnings(args.suppress_warnings());
+	listener->set_verbose(args.verbose());
+	listener->set_release_mode(args.release_mode());
+	listener->set_optimization_level(args.optimization_level());
+	listener->set_lazy_class_loading(args.lazy_class_loading());
+	listener->set_remove_unused_code(args.remove_unused_code());
+	listener->set_associative_objects(args.associative_objects());
+	listener->set_inline_threshold(args.inline_threshold());
 	listener->set_target_bash_version(args.target_bash_version());
 	listener->set_arguments(args.program_arguments());
 	listener->set_parser_errors(parser_errors);